@@ -20,182 +20,7 @@
 #include "config.h"
 
 #include "account.h"
-#include "portal-private.h"
-
-typedef struct {
-  XdpPortal *portal;
-  XdpParent *parent;
-  char *parent_handle;
-  char *reason;
-  GTask *task;
-  guint signal_id;
-  char *request_path;
-  guint cancelled_id;
-} AccountCall;
-
-static void
-account_call_free (AccountCall *call)
-{
-  g_debug ("freeing AccountCall");
-  if (call->parent)
-    {
-      call->parent->parent_unexport (call->parent);
-      xdp_parent_free (call->parent);
-    }
-  g_free (call->parent_handle);
-
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-
-  if (call->cancelled_id)
-    g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-
-  g_free (call->request_path);
-
-  g_object_unref (call->portal);
-  g_object_unref (call->task);
-
-  g_free (call->reason);
-
-  g_free (call);
-}
-
-static void
-response_received (GDBusConnection *bus,
-                   const char *sender_name,
-                   const char *object_path,
-                   const char *interface_name,
-                   const char *signal_name,
-                   GVariant *parameters,
-                   gpointer data)
-{
-  AccountCall *call = data;
-  guint32 response;
-  g_autoptr(GVariant) ret = NULL;
-
-  if (call->cancelled_id)
-    {
-      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-      call->cancelled_id = 0;
-    }
-
-  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
-
-  if (response == 0)
-    g_task_return_pointer (call->task, g_variant_ref (ret), (GDestroyNotify)g_variant_unref);
-  else if (response == 1)
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Account call canceled user");
-  else
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Account call failed");
-
-  account_call_free (call);
-}
-
-static void get_user_information (AccountCall *call);
-
-static void
-parent_exported (XdpParent *parent,
-                 const char *handle,
-                 gpointer data)
-{
-  AccountCall *call = data;
-  call->parent_handle = g_strdup (handle);
-  get_user_information (call);
-}
-
-static void
-cancelled_cb (GCancellable *cancellable,
-              gpointer data)
-{
-  AccountCall *call = data;
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          call->request_path,
-                          REQUEST_INTERFACE,
-                          "Close",
-                          NULL,
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL, NULL, NULL);
-
-  g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Account call canceled by caller");
-
-  account_call_free (call);
-}
-
-static void
-call_returned (GObject *object,
-               GAsyncResult *result,
-               gpointer data)
-{
-  GDBusConnection *bus = G_DBUS_CONNECTION (object);
-  AccountCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-
-  ret = g_dbus_connection_call_finish (bus, result, &error);
-  if (error)
-    {
-      if (call->cancelled_id)
-        {
-          g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-          call->cancelled_id = 0;
-        }
-
-      g_task_return_error (call->task, error);
-      account_call_free (call);
-    }
-}
-
-static void
-get_user_information (AccountCall *call)
-{
-  GVariantBuilder options;
-  g_autofree char *token = NULL;
-  GCancellable *cancellable;
-
-  if (call->parent_handle == NULL)
-    {
-      call->parent->parent_export (call->parent, parent_exported, call);
-      return;
-    }
-
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
-
-  cancellable = g_task_get_cancellable (call->task);
-  if (cancellable)
-    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (cancelled_cb), call);
-
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  g_variant_builder_add (&options, "{sv}", "reason", g_variant_new_string (call->reason));
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.Account",
-                          "GetUserInformation",
-                          g_variant_new ("(sa{sv})", call->parent_handle, &options),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL,
-                          call_returned,
-                          call);
-}
+#include "request-private.h"
 
 /**
  * xdp_portal_get_user_information:
@@ -222,22 +47,20 @@ xdp_portal_get_user_information (XdpPortal *portal,
                                  GAsyncReadyCallback  callback,
                                  gpointer data)
 {
-  AccountCall *call = NULL;
+  XdpRequest *request;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail (flags == XDP_USER_INFORMATION_FLAG_NONE);
 
-  call = g_new0 (AccountCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-  call->reason = g_strdup (reason);
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_get_user_information);
+  request = _xdp_request_new (portal, parent,
+                              "org.freedesktop.portal.Account",
+                              "GetUserInformation",
+                              cancellable, callback, data,
+                              xdp_portal_get_user_information);
+  if (reason)
+    g_variant_builder_add (&request->options, "{sv}", "reason", g_variant_new_string (reason));
 
-  get_user_information (call);
+  _xdp_request_send (request);
 }
 
 /**
@@ -22,7 +22,7 @@
 
 #include "session-private.h"
 #include "background.h"
-#include "portal-private.h"
+#include "request-private.h"
 
 typedef struct {
   XdpPortal *portal;
@@ -67,7 +67,7 @@ set_status (SetStatusCall *call)
   if (call->status_message)
     g_variant_builder_add (&options, "{sv}", "message", g_variant_new_string (call->status_message));
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Background",
@@ -82,27 +82,21 @@ set_status (SetStatusCall *call)
 }
 
 static void
-get_background_version_returned (GObject      *object,
-                                 GAsyncResult *result,
-                                 gpointer      data)
+background_properties_loaded (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      data)
 {
-  g_autoptr(GVariant) version_variant = NULL;
-  g_autoptr(GVariant) ret = NULL;
   SetStatusCall *call = data;
   GError *error = NULL;
 
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
+  if (!_xdp_portal_load_properties_finish (call->portal, result, &error))
     {
       g_task_return_error (call->task, error);
       set_status_call_free (call);
       return;
     }
 
-  g_variant_get_child (ret, 0, "v", &version_variant);
-  call->portal->background_interface_version = g_variant_get_uint32 (version_variant);
-
-  if (call->portal->background_interface_version < 2)
+  if (_xdp_portal_get_interface_version (call->portal, "org.freedesktop.portal.Background") < 2)
     {
       g_task_return_new_error (call->task, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
                                "Background portal does not implement version 2 of the interface");
@@ -114,207 +108,14 @@ get_background_version_returned (GObject      *object,
 }
 
 static void
-get_background_interface_version (SetStatusCall *call)
-{
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.DBus.Properties",
-                          "Get",
-                          g_variant_new ("(ss)", "org.freedesktop.portal.Background", "version"),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          g_task_get_cancellable (call->task),
-                          get_background_version_returned,
-                          call);
-}
-
-typedef struct {
-  XdpPortal *portal;
-  XdpParent *parent;
-  char *parent_handle;
-  guint signal_id;
-  GTask *task;
-  char *request_path;
-  guint cancelled_id;
-
-  gboolean autostart;
-  gboolean dbus_activatable;
-  GPtrArray *commandline;
-  char *reason;
-} BackgroundCall;
-
-static void
-background_call_free (BackgroundCall *call)
-{
-  if (call->parent)
-    {
-      call->parent->parent_unexport (call->parent);
-      xdp_parent_free (call->parent);
-    }
-  g_free (call->parent_handle);
-
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-
-  if (call->cancelled_id)
-    g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-
-  g_free (call->request_path);
-
-  g_object_unref (call->portal);
-  g_object_unref (call->task);
-
-  g_clear_pointer (&call->commandline, g_ptr_array_unref);
-  g_free (call->reason);
-
-  g_free (call);
-}
-
-static void
-response_received (GDBusConnection *bus,
-                   const char *sender_name,
-                   const char *object_path,
-                   const char *interface_name,
-                   const char *signal_name,
-                   GVariant *parameters,
-                   gpointer data)
-{
-  BackgroundCall *call = data;
-  guint32 response;
-  g_autoptr(GVariant) ret = NULL;
-
-  if (call->cancelled_id)
-    {
-      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-      call->cancelled_id = 0;
-    }
-
-  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
-
-  if (response == 0)
-    {
-      gboolean permission_granted = FALSE;
-      g_variant_lookup (ret, call->autostart ? "autostart" : "background", "b", &permission_granted);
-      g_task_return_boolean (call->task, permission_granted);
-    }
-  else if (response == 1)
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Background request canceled");
-  else
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Background request failed");
-
-  background_call_free (call);
-}
-
-static void request_background (BackgroundCall *call);
-
-static void
-parent_exported (XdpParent *parent,
-                 const char *handle,
-                 gpointer data)
-{
-  BackgroundCall *call = data;
-  call->parent_handle = g_strdup (handle);
-  request_background (call);
-}
-
-static void
-cancelled_cb (GCancellable *cancellable,
-              gpointer data)
-{
-  BackgroundCall *call = data;
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          call->request_path,
-                          REQUEST_INTERFACE,
-                          "Close",
-                          NULL,
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL, NULL, NULL);
-
-  background_call_free (call);
-}
-
-static void
-call_returned (GObject *object,
-               GAsyncResult *result,
-               gpointer data)
-{
-  BackgroundCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
-    {
-      if (call->cancelled_id)
-        {
-          g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-          call->cancelled_id = 0;
-        }
-
-      g_task_return_error (call->task, error);
-      background_call_free (call);
-    }
-}
-
-static void
-request_background (BackgroundCall *call)
+request_background_response (GTask    *task,
+                              GVariant *results)
 {
-  GVariantBuilder options;
-  g_autofree char *token = NULL;
-  GCancellable *cancellable;
-
-  if (call->parent_handle == NULL)
-    {
-      call->parent->parent_export (call->parent, parent_exported, call);
-      return;
-    }
+  gboolean autostart = GPOINTER_TO_INT (g_task_get_task_data (task));
+  gboolean permission_granted = FALSE;
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
-
-  cancellable = g_task_get_cancellable (call->task);
-  if (cancellable)
-    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (cancelled_cb), call);
-
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-
-  g_variant_builder_add (&options, "{sv}", "autostart", g_variant_new_boolean (call->autostart));
-  g_variant_builder_add (&options, "{sv}", "dbus-activatable", g_variant_new_boolean (call->dbus_activatable));
-  if (call->reason)
-    g_variant_builder_add (&options, "{sv}", "reason", g_variant_new_string (call->reason));
-  if (call->commandline)
-    g_variant_builder_add (&options, "{sv}", "commandline", g_variant_new_strv ((const char* const*)call->commandline->pdata, call->commandline->len));
-
-  g_debug ("calling background");
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.Background",
-                          "RequestBackground",
-                          g_variant_new ("(sa{sv})", call->parent_handle, &options),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          cancellable,
-                          call_returned,
-                          call);
+  g_variant_lookup (results, autostart ? "autostart" : "background", "b", &permission_granted);
+  g_task_return_boolean (task, permission_granted);
 }
 
 /**
@@ -343,28 +144,33 @@ xdp_portal_request_background (XdpPortal *portal,
                                GAsyncReadyCallback callback,
                                gpointer user_data)
 {
-  BackgroundCall *call;
+  XdpRequest *request;
+  gboolean autostart;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail ((flags & ~(XDP_BACKGROUND_FLAG_AUTOSTART |
                                XDP_BACKGROUND_FLAG_ACTIVATABLE)) == 0);
 
-  call = g_new0 (BackgroundCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-
-  call->autostart = (flags & XDP_BACKGROUND_FLAG_AUTOSTART) != 0;
-  call->dbus_activatable = (flags & XDP_BACKGROUND_FLAG_ACTIVATABLE) != 0;
-  call->reason = g_strdup (reason);
+  autostart = (flags & XDP_BACKGROUND_FLAG_AUTOSTART) != 0;
+
+  request = _xdp_request_new (portal, parent,
+                              "org.freedesktop.portal.Background",
+                              "RequestBackground",
+                              cancellable, callback, user_data,
+                              xdp_portal_request_background);
+  g_task_set_task_data (request->task, GINT_TO_POINTER (autostart), NULL);
+  request->response_func = request_background_response;
+
+  g_variant_builder_add (&request->options, "{sv}", "autostart", g_variant_new_boolean (autostart));
+  g_variant_builder_add (&request->options, "{sv}", "dbus-activatable",
+                         g_variant_new_boolean ((flags & XDP_BACKGROUND_FLAG_ACTIVATABLE) != 0));
+  if (reason)
+    g_variant_builder_add (&request->options, "{sv}", "reason", g_variant_new_string (reason));
   if (commandline)
-    call->commandline = g_ptr_array_ref (commandline);
-
-  call->task = g_task_new (portal, cancellable, callback, user_data);
+    g_variant_builder_add (&request->options, "{sv}", "commandline",
+                           g_variant_new_strv ((const char* const*)commandline->pdata, commandline->len));
 
-  request_background (call);
+  _xdp_request_send (request);
 }
 
 /**
@@ -418,10 +224,8 @@ xdp_portal_set_background_status (XdpPortal           *portal,
   call->task = g_task_new (portal, cancellable, callback, data);
   g_task_set_source_tag (call->task, xdp_portal_set_background_status);
 
-  if (portal->background_interface_version == 0)
-    get_background_interface_version (call);
-  else
-    set_status (call);
+  _xdp_portal_load_properties (portal, NULL, cancellable,
+                               background_properties_loaded, call);
 }
 
 /**
@@ -46,4 +46,15 @@ gboolean xdp_portal_access_camera_finish (XdpPortal           *portal,
 XDP_PUBLIC
 int      xdp_portal_open_pipewire_remote_for_camera (XdpPortal *portal);
 
+XDP_PUBLIC
+void     xdp_portal_open_pipewire_remote_for_camera_async  (XdpPortal            *portal,
+                                                            GCancellable         *cancellable,
+                                                            GAsyncReadyCallback   callback,
+                                                            gpointer              data);
+
+XDP_PUBLIC
+int      xdp_portal_open_pipewire_remote_for_camera_finish (XdpPortal            *portal,
+                                                            GAsyncResult         *result,
+                                                            GError              **error);
+
 G_END_DECLS
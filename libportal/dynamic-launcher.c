@@ -20,7 +20,7 @@
 #include "config.h"
 
 #include "dynamic-launcher.h"
-#include "portal-private.h"
+#include "request-private.h"
 
 #define GNU_SOURCE 1
 
@@ -31,196 +31,6 @@
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
 
-
-typedef struct {
-  XdpPortal *portal;
-  XdpParent *parent;
-  char *parent_handle;
-  char *name;
-  char *url;
-  char *token;
-  GVariant *icon_v;
-  XdpLauncherType launcher_type;
-  gboolean editable_name;
-  gboolean editable_icon;
-  guint signal_id;
-  GTask *task;
-  char *request_path;
-  guint cancelled_id;
-} PrepareInstallLauncherCall;
-
-static void
-prepare_install_launcher_call_free (PrepareInstallLauncherCall *call)
-{
-  if (call->parent)
-    {
-      call->parent->parent_unexport (call->parent);
-      xdp_parent_free (call->parent);
-    }
-  g_free (call->parent_handle);
-
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-
-  if (call->cancelled_id)
-    g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-
-  g_free (call->request_path);
-
-  g_object_unref (call->portal);
-  g_object_unref (call->task);
-
-  g_variant_unref (call->icon_v);
-  g_free (call->name);
-  g_free (call->url);
-
-  g_free (call);
-}
-
-static void
-response_received (GDBusConnection *bus,
-                   const char *sender_name,
-                   const char *object_path,
-                   const char *interface_name,
-                   const char *signal_name,
-                   GVariant *parameters,
-                   gpointer data)
-{
-  PrepareInstallLauncherCall *call = data;
-  guint32 response;
-  g_autoptr(GVariant) ret = NULL;
-
-  if (call->cancelled_id)
-    {
-      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-      call->cancelled_id = 0;
-    }
-
-  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
-
-  if (response == 0)
-    g_task_return_pointer (call->task, g_variant_ref (ret), (GDestroyNotify)g_variant_unref);
-  else if (response == 1)
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Launcher install canceled");
-  else
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Launcher install failed");
-
-  prepare_install_launcher_call_free (call);
-}
-
-static void do_prepare_install (PrepareInstallLauncherCall *call);
-
-static void
-parent_exported (XdpParent *parent,
-                 const char *handle,
-                 gpointer data)
-{
-  PrepareInstallLauncherCall *call = data;
-  call->parent_handle = g_strdup (handle);
-  do_prepare_install (call);
-}
-
-static void
-cancelled_cb (GCancellable *cancellable,
-              gpointer data)
-{
-  PrepareInstallLauncherCall *call = data;
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          call->request_path,
-                          REQUEST_INTERFACE,
-                          "Close",
-                          NULL,
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL, NULL, NULL);
-
-  g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
-                           "PrepareInstall call canceled by caller");
-
-  prepare_install_launcher_call_free (call);
-}
-
-static void
-prepare_install_returned (GObject      *object,
-                          GAsyncResult *result,
-                          gpointer      data)
-{
-  PrepareInstallLauncherCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
-    {
-      if (call->cancelled_id)
-        {
-          g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-          call->cancelled_id = 0;
-        }
-      g_task_return_error (call->task, error);
-      prepare_install_launcher_call_free (call);
-    }
-}
-
-static void
-do_prepare_install (PrepareInstallLauncherCall *call)
-{
-  GVariantBuilder opt_builder;
-  g_autofree char *handle_token = NULL;
-  GCancellable *cancellable;
-
-  if (call->parent_handle == NULL)
-    {
-      call->parent->parent_export (call->parent, parent_exported, call);
-      return;
-    }
-
-  handle_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", handle_token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
-
-  cancellable = g_task_get_cancellable (call->task);
-  if (cancellable)
-    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (cancelled_cb), call);
-
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&opt_builder, "{sv}", "handle_token", g_variant_new_string (handle_token));
-  g_variant_builder_add (&opt_builder, "{sv}", "launcher_type", g_variant_new_uint32 (call->launcher_type));
-  if (call->url)
-    g_variant_builder_add (&opt_builder, "{sv}", "target", g_variant_new_string (call->url));
-  g_variant_builder_add (&opt_builder, "{sv}", "editable_name", g_variant_new_boolean (call->editable_name));
-  g_variant_builder_add (&opt_builder, "{sv}", "editable_icon", g_variant_new_boolean (call->editable_icon));
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.DynamicLauncher",
-                          "PrepareInstall",
-                          g_variant_new ("(ssva{sv})",
-                                         call->parent_handle,
-                                         call->name,
-                                         call->icon_v,
-                                         &opt_builder),
-                          G_VARIANT_TYPE ("(o)"),
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          cancellable,
-                          prepare_install_returned,
-                          call);
-}
-
 /**
  * xdp_portal_dynamic_launcher_prepare_install:
  * @portal: a [class@Portal]
@@ -254,29 +64,26 @@ xdp_portal_dynamic_launcher_prepare_install (XdpPortal           *portal,
                                              GAsyncReadyCallback  callback,
                                              gpointer             data)
 {
-  PrepareInstallLauncherCall *call;
+  XdpRequest *request;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail (name != NULL && *name != '\0');
   g_return_if_fail (g_variant_is_of_type (icon_v, G_VARIANT_TYPE ("(sv)")));
 
-  call = g_new0 (PrepareInstallLauncherCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-  call->name = g_strdup (name);
-  call->icon_v = g_variant_ref (icon_v);
-  call->launcher_type = launcher_type;
-  if (call->launcher_type == XDP_LAUNCHER_WEBAPP)
-    call->url = g_strdup (target);
-  call->editable_name = editable_name;
-  call->editable_icon = editable_icon;
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_dynamic_launcher_prepare_install);
+  request = _xdp_request_new (portal, parent,
+                              "org.freedesktop.portal.DynamicLauncher",
+                              "PrepareInstall",
+                              cancellable, callback, data,
+                              xdp_portal_dynamic_launcher_prepare_install);
+  _xdp_request_set_args (request, g_variant_new ("(sv)", name, icon_v), NULL);
 
-  do_prepare_install (call);
+  g_variant_builder_add (&request->options, "{sv}", "launcher_type", g_variant_new_uint32 (launcher_type));
+  if (launcher_type == XDP_LAUNCHER_WEBAPP && target)
+    g_variant_builder_add (&request->options, "{sv}", "target", g_variant_new_string (target));
+  g_variant_builder_add (&request->options, "{sv}", "editable_name", g_variant_new_boolean (editable_name));
+  g_variant_builder_add (&request->options, "{sv}", "editable_icon", g_variant_new_boolean (editable_icon));
+
+  _xdp_request_send (request);
 }
 
 /**
@@ -308,6 +115,117 @@ xdp_portal_dynamic_launcher_prepare_install_finish (XdpPortal     *portal,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+#define DYNAMIC_LAUNCHER_INTERFACE "org.freedesktop.portal.DynamicLauncher"
+
+static GVariant *
+request_install_token_parameters (const char *name,
+                                  GVariant   *icon_v)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_new ("(sva{sv})", name, icon_v, &opt_builder);
+}
+
+static GVariant *
+install_parameters (const char *token,
+                    const char *desktop_file_id,
+                    const char *desktop_entry)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_new ("(sssa{sv})", token, desktop_file_id, desktop_entry, &opt_builder);
+}
+
+static GVariant *
+uninstall_parameters (const char *desktop_file_id)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  return g_variant_new ("(sa{sv})", desktop_file_id, &opt_builder);
+}
+
+static GVariant *
+launch_parameters (const char *desktop_file_id,
+                   const char *activation_token)
+{
+  GVariantBuilder opt_builder;
+
+  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
+  if (activation_token != NULL && *activation_token != '\0')
+    g_variant_builder_add (&opt_builder, "{sv}", "activation_token", g_variant_new_string (activation_token));
+
+  return g_variant_new ("(sa{sv})", desktop_file_id, &opt_builder);
+}
+
+static void
+launcher_call_done (GObject      *object,
+                    GAsyncResult *result,
+                    gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  GVariant *ret;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret == NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, ret, (GDestroyNotify) g_variant_unref);
+}
+
+/* Calls @method without blocking; @task returns the reply */
+static void
+launcher_call (XdpPortal          *portal,
+               const char         *method,
+               GVariant           *parameters,
+               const GVariantType *reply_type,
+               GTask              *task)
+{
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          DYNAMIC_LAUNCHER_INTERFACE,
+                          method,
+                          parameters,
+                          reply_type,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (task),
+                          launcher_call_done,
+                          g_object_ref (task));
+}
+
+static GVariant *
+launcher_call_finish (XdpPortal     *portal,
+                      GAsyncResult  *result,
+                      gpointer       source_tag,
+                      GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, portal), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == source_tag, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GTask *
+launcher_task_new (XdpPortal           *portal,
+                   GCancellable        *cancellable,
+                   GAsyncReadyCallback  callback,
+                   gpointer             data,
+                   gpointer             source_tag)
+{
+  GTask *task;
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, source_tag);
+
+  return task;
+}
+
 /**
  * xdp_portal_dynamic_launcher_request_install_token:
  * @portal: a [class@Portal]
@@ -331,7 +249,6 @@ xdp_portal_dynamic_launcher_request_install_token (XdpPortal   *portal,
                                                    GVariant    *icon_v,
                                                    GError     **error)
 {
-  GVariantBuilder opt_builder;
   g_autoptr(GVariant) ret = NULL;
   g_autofree char *token = NULL;
 
@@ -339,16 +256,12 @@ xdp_portal_dynamic_launcher_request_install_token (XdpPortal   *portal,
   g_return_val_if_fail (name != NULL && *name != '\0', NULL);
   g_return_val_if_fail (g_variant_is_of_type (icon_v, G_VARIANT_TYPE ("(sv)")), NULL);
 
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "RequestInstallToken",
-                                     g_variant_new ("(sva{sv})",
-                                                    name,
-                                                    icon_v,
-                                                    &opt_builder),
+                                     request_install_token_parameters (name, icon_v),
                                      G_VARIANT_TYPE ("(s)"),
                                      G_DBUS_CALL_FLAGS_NONE,
                                      -1,
@@ -389,7 +302,6 @@ xdp_portal_dynamic_launcher_install (XdpPortal   *portal,
                                      const char  *desktop_entry,
                                      GError     **error)
 {
-  GVariantBuilder opt_builder;
   g_autoptr(GVariant) ret = NULL;
 
   g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
@@ -397,17 +309,12 @@ xdp_portal_dynamic_launcher_install (XdpPortal   *portal,
   g_return_val_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0', FALSE);
   g_return_val_if_fail (desktop_entry != NULL && *desktop_entry != '\0', FALSE);
 
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "Install",
-                                     g_variant_new ("(sssa{sv})",
-                                                    token,
-                                                    desktop_file_id,
-                                                    desktop_entry,
-                                                    &opt_builder),
+                                     install_parameters (token, desktop_file_id, desktop_entry),
                                      NULL,
                                      G_DBUS_CALL_FLAGS_NONE,
                                      -1,
@@ -435,21 +342,17 @@ xdp_portal_dynamic_launcher_uninstall (XdpPortal   *portal,
                                        const char  *desktop_file_id,
                                        GError     **error)
 {
-  GVariantBuilder opt_builder;
   g_autoptr(GVariant) ret = NULL;
 
   g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
   g_return_val_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0', FALSE);
 
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "Uninstall",
-                                     g_variant_new ("(sa{sv})",
-                                                    desktop_file_id,
-                                                    &opt_builder),
+                                     uninstall_parameters (desktop_file_id),
                                      NULL,
                                      G_DBUS_CALL_FLAGS_NONE,
                                      -1,
@@ -483,10 +386,10 @@ xdp_portal_dynamic_launcher_get_desktop_entry (XdpPortal   *portal,
   g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
   g_return_val_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0', NULL);
 
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "GetDesktopEntry",
                                      g_variant_new ("(s)", desktop_file_id),
                                      G_VARIANT_TYPE ("(s)"),
@@ -532,10 +435,10 @@ xdp_portal_dynamic_launcher_get_icon (XdpPortal   *portal,
   g_return_val_if_fail (XDP_IS_PORTAL (portal), NULL);
   g_return_val_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0', NULL);
 
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "GetIcon",
                                      g_variant_new ("(s)", desktop_file_id),
                                      G_VARIANT_TYPE ("(vsu)"),
@@ -577,26 +480,681 @@ xdp_portal_dynamic_launcher_launch (XdpPortal   *portal,
                                     GError     **error)
 {
   g_autoptr(GVariant) ret = NULL;
-  GVariantBuilder opt_builder;
 
   g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
   g_return_val_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0', FALSE);
 
-  g_variant_builder_init (&opt_builder, G_VARIANT_TYPE_VARDICT);
-  if (activation_token != NULL && *activation_token != '\0')
-    g_variant_builder_add (&opt_builder, "{sv}", "activation_token", g_variant_new_string (activation_token));
-
-  ret = g_dbus_connection_call_sync (portal->bus,
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
                                      PORTAL_BUS_NAME,
                                      PORTAL_OBJECT_PATH,
-                                     "org.freedesktop.portal.DynamicLauncher",
+                                     DYNAMIC_LAUNCHER_INTERFACE,
                                      "Launch",
-                                     g_variant_new ("(sa{sv})",
-                                                    desktop_file_id,
-                                                    &opt_builder),
+                                     launch_parameters (desktop_file_id, activation_token),
                                      NULL,
                                      G_DBUS_CALL_FLAGS_NONE,
                                      -1,
                                      NULL, error);
   return (ret != NULL);
 }
+
+/**
+ * xdp_portal_dynamic_launcher_request_install_token_async:
+ * @portal: a [class@Portal]
+ * @name: the name for the launcher
+ * @icon_v: a #GBytesIcon as returned by g_icon_serialize(). Must be a png or jpeg no larger than 512x512, or an svg
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Requests an install token like
+ * [method@Portal.dynamic_launcher_request_install_token], without
+ * blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_request_install_token_async (XdpPortal           *portal,
+                                                         const char          *name,
+                                                         GVariant            *icon_v,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (name != NULL && *name != '\0');
+  g_return_if_fail (g_variant_is_of_type (icon_v, G_VARIANT_TYPE ("(sv)")));
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_request_install_token_async);
+  launcher_call (portal, "RequestInstallToken",
+                 request_install_token_parameters (name, icon_v),
+                 G_VARIANT_TYPE ("(s)"), task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_request_install_token_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes requesting an install token.
+ *
+ * Returns: (transfer full): a token that can be passed to
+ *   [method@Portal.dynamic_launcher_install], or %NULL with @error set
+ *
+ * Since: 0.9
+ */
+char *
+xdp_portal_dynamic_launcher_request_install_token_finish (XdpPortal     *portal,
+                                                          GAsyncResult  *result,
+                                                          GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  char *token = NULL;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_request_install_token_async, error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(s)", &token);
+  return token;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_async:
+ * @portal: a [class@Portal]
+ * @token: a token acquired via a [method@Portal.dynamic_launcher_request_install_token] or [method@Portal.dynamic_launcher_prepare_install] call
+ * @desktop_file_id: the .desktop file name to be used
+ * @desktop_entry: the key-file to be used for the contents of the .desktop file
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Installs a launcher like [method@Portal.dynamic_launcher_install],
+ * without blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_install_async (XdpPortal           *portal,
+                                           const char          *token,
+                                           const char          *desktop_file_id,
+                                           const char          *desktop_entry,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (token != NULL && *token != '\0');
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+  g_return_if_fail (desktop_entry != NULL && *desktop_entry != '\0');
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_install_async);
+  launcher_call (portal, "Install",
+                 install_parameters (token, desktop_file_id, desktop_entry),
+                 NULL, task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes installing a launcher.
+ *
+ * Returns: %TRUE if the installation was successful, %FALSE with @error set
+ *   otherwise
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_portal_dynamic_launcher_install_finish (XdpPortal     *portal,
+                                            GAsyncResult  *result,
+                                            GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_install_async, error);
+  return (ret != NULL);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Uninstalls a launcher like [method@Portal.dynamic_launcher_uninstall],
+ * without blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_uninstall_async (XdpPortal           *portal,
+                                             const char          *desktop_file_id,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_uninstall_async);
+  launcher_call (portal, "Uninstall",
+                 uninstall_parameters (desktop_file_id),
+                 NULL, task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes uninstalling a launcher.
+ *
+ * Returns: %TRUE if the uninstallation was successful, %FALSE with @error set
+ *   otherwise
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_portal_dynamic_launcher_uninstall_finish (XdpPortal     *portal,
+                                              GAsyncResult  *result,
+                                              GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_uninstall_async, error);
+  return (ret != NULL);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_desktop_entry_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Gets the contents of a .desktop file like
+ * [method@Portal.dynamic_launcher_get_desktop_entry], without blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_get_desktop_entry_async (XdpPortal           *portal,
+                                                     const char          *desktop_file_id,
+                                                     GCancellable        *cancellable,
+                                                     GAsyncReadyCallback  callback,
+                                                     gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_get_desktop_entry_async);
+  launcher_call (portal, "GetDesktopEntry",
+                 g_variant_new ("(s)", desktop_file_id),
+                 G_VARIANT_TYPE ("(s)"), task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_desktop_entry_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes getting the contents of a .desktop file.
+ *
+ * Returns: (transfer full): the contents of the desktop file, or %NULL with
+ *   @error set
+ *
+ * Since: 0.9
+ */
+char *
+xdp_portal_dynamic_launcher_get_desktop_entry_finish (XdpPortal     *portal,
+                                                      GAsyncResult  *result,
+                                                      GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  char *contents = NULL;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_get_desktop_entry_async, error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(s)", &contents);
+  return contents;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_icon_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Gets the icon of a launcher like
+ * [method@Portal.dynamic_launcher_get_icon], without blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_get_icon_async (XdpPortal           *portal,
+                                            const char          *desktop_file_id,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_get_icon_async);
+  launcher_call (portal, "GetIcon",
+                 g_variant_new ("(s)", desktop_file_id),
+                 G_VARIANT_TYPE ("(vsu)"), task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_get_icon_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @out_icon_format: (nullable): return location for icon format string, one of "png", "jpeg", "svg"
+ * @out_icon_size: (nullable): return location for icon size
+ * @error: return location for a #GError
+ *
+ * Finishes getting the icon of a launcher.
+ *
+ * Returns: (transfer full): the icon in a format recognized by g_icon_deserialize(),
+ *   or %NULL with @error set
+ *
+ * Since: 0.9
+ */
+GVariant *
+xdp_portal_dynamic_launcher_get_icon_finish (XdpPortal     *portal,
+                                             GAsyncResult  *result,
+                                             char         **out_icon_format,
+                                             guint         *out_icon_size,
+                                             GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autofree char *icon_format = NULL;
+  GVariant *icon_v = NULL;
+  guint icon_size;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_get_icon_async, error);
+  if (ret == NULL)
+    return NULL;
+
+  g_variant_get (ret, "(vsu)", &icon_v, &icon_format, &icon_size);
+
+  if (out_icon_format)
+    *out_icon_format = g_steal_pointer (&icon_format);
+  if (out_icon_size)
+    *out_icon_size = icon_size;
+
+  return icon_v;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_launch_async:
+ * @portal: a [class@Portal]
+ * @desktop_file_id: the .desktop file name
+ * @activation_token: (nullable): the activation token, see the "XDG activation" section of the wayland-protocols docs
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Launches an app like [method@Portal.dynamic_launcher_launch], without
+ * blocking.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_launch_async (XdpPortal           *portal,
+                                          const char          *desktop_file_id,
+                                          const char          *activation_token,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_id != NULL && *desktop_file_id != '\0');
+
+  task = launcher_task_new (portal, cancellable, callback, data,
+                            xdp_portal_dynamic_launcher_launch_async);
+  launcher_call (portal, "Launch",
+                 launch_parameters (desktop_file_id, activation_token),
+                 NULL, task);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_launch_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for a #GError
+ *
+ * Finishes launching an app.
+ *
+ * Returns: %TRUE if the launch was successful, %FALSE with @error set
+ *   otherwise
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_portal_dynamic_launcher_launch_finish (XdpPortal     *portal,
+                                           GAsyncResult  *result,
+                                           GError       **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+
+  ret = launcher_call_finish (portal, result, xdp_portal_dynamic_launcher_launch_async, error);
+  return (ret != NULL);
+}
+
+typedef struct {
+  guint n_items;
+  guint n_pending;
+  GHashTable *failures; /* desktop file ID → GError */
+} BulkCall;
+
+typedef struct {
+  GTask *task;
+  char *desktop_file_id;
+} BulkItem;
+
+static void
+bulk_call_free (BulkCall *call)
+{
+  g_clear_pointer (&call->failures, g_hash_table_unref);
+  g_free (call);
+}
+
+static void
+bulk_item_done (GObject      *object,
+                GAsyncResult *result,
+                gpointer      data)
+{
+  BulkItem *item = data;
+  g_autoptr(GTask) task = item->task;
+  BulkCall *call = g_task_get_task_data (task);
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret == NULL)
+    g_hash_table_replace (call->failures, g_steal_pointer (&item->desktop_file_id), error);
+
+  g_free (item->desktop_file_id);
+  g_free (item);
+
+  if (--call->n_pending > 0)
+    return;
+
+  /* Failures of single launchers are reported by the finish function;
+   * the call as a whole only fails if it was cancelled */
+  if (!g_task_return_error_if_cancelled (task))
+    g_task_return_boolean (task, TRUE);
+}
+
+/* All calls are made at once; the portal handles them in order */
+static void
+bulk_call (XdpPortal           *portal,
+           const char          *method,
+           GVariant           **parameters,
+           const char * const  *desktop_file_ids,
+           guint                n_items,
+           GCancellable        *cancellable,
+           GAsyncReadyCallback  callback,
+           gpointer             data,
+           gpointer             source_tag)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(GHashTable) seen = NULL;
+  BulkCall *call;
+  guint i;
+
+  task = launcher_task_new (portal, cancellable, callback, data, source_tag);
+
+  /* Each launcher has one entry in the failures, and the portal calls
+   * for the same file would race, so don't allow the same one twice */
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  for (i = 0; i < n_items; i++)
+    {
+      if (!g_hash_table_add (seen, (gpointer) desktop_file_ids[i]))
+        {
+          guint j;
+
+          g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                   "Launcher %s is listed more than once", desktop_file_ids[i]);
+
+          for (j = 0; j < n_items; j++)
+            g_variant_unref (g_variant_ref_sink (parameters[j]));
+          return;
+        }
+    }
+
+  call = g_new0 (BulkCall, 1);
+  call->n_items = n_items;
+  call->n_pending = n_items;
+  call->failures = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_error_free);
+  g_task_set_task_data (task, call, (GDestroyNotify) bulk_call_free);
+
+  if (n_items == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  for (i = 0; i < n_items; i++)
+    {
+      BulkItem *item;
+
+      item = g_new0 (BulkItem, 1);
+      item->task = g_object_ref (task);
+      item->desktop_file_id = g_strdup (desktop_file_ids[i]);
+
+      g_dbus_connection_call (_xdp_portal_get_bus (portal),
+                              PORTAL_BUS_NAME,
+                              PORTAL_OBJECT_PATH,
+                              DYNAMIC_LAUNCHER_INTERFACE,
+                              method,
+                              parameters[i],
+                              NULL,
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1,
+                              cancellable,
+                              bulk_item_done,
+                              item);
+    }
+}
+
+static gboolean
+bulk_call_finish (XdpPortal     *portal,
+                  GAsyncResult  *result,
+                  gpointer       source_tag,
+                  GHashTable   **out_failures,
+                  GError       **error)
+{
+  BulkCall *call;
+
+  g_return_val_if_fail (XDP_IS_PORTAL (portal), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == source_tag, FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  call = g_task_get_task_data (G_TASK (result));
+  if (out_failures)
+    *out_failures = g_hash_table_ref (call->failures);
+
+  return TRUE;
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_all:
+ * @portal: a [class@Portal]
+ * @tokens: (array zero-terminated=1): a token for each launcher, see
+ *   [method@Portal.dynamic_launcher_install]
+ * @desktop_file_ids: (array zero-terminated=1): the .desktop file name
+ *   of each launcher
+ * @desktop_entries: (array zero-terminated=1): the contents of the
+ *   .desktop file of each launcher
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when all launchers are done
+ * @data: (closure): data to pass to @callback
+ *
+ * Installs many launchers at once. The three arrays must have the same
+ * length; their elements at the same index describe one launcher.
+ *
+ * The portal is asked to install all launchers without waiting for each
+ * other, so installing many costs about one round trip rather than one
+ * per launcher. Launchers that fail to install don't stop the others;
+ * [method@Portal.dynamic_launcher_install_all_finish] reports them.
+ *
+ * Each .desktop file name may only be listed once, otherwise the call
+ * fails with %G_IO_ERROR_INVALID_ARGUMENT without installing anything.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_install_all (XdpPortal           *portal,
+                                         const char * const  *tokens,
+                                         const char * const  *desktop_file_ids,
+                                         const char * const  *desktop_entries,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             data)
+{
+  g_autofree GVariant **parameters = NULL;
+  guint n_items;
+  guint i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (tokens != NULL && desktop_file_ids != NULL && desktop_entries != NULL);
+
+  n_items = g_strv_length ((char **) desktop_file_ids);
+  g_return_if_fail (g_strv_length ((char **) tokens) == n_items);
+  g_return_if_fail (g_strv_length ((char **) desktop_entries) == n_items);
+
+  parameters = g_new (GVariant *, n_items + 1);
+  for (i = 0; i < n_items; i++)
+    parameters[i] = install_parameters (tokens[i], desktop_file_ids[i], desktop_entries[i]);
+
+  bulk_call (portal, "Install", parameters, desktop_file_ids, n_items,
+             cancellable, callback, data,
+             xdp_portal_dynamic_launcher_install_all);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_install_all_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @out_failures: (out) (optional) (transfer full) (element-type utf8 GLib.Error):
+ *   return location for the launchers that failed to install, by .desktop
+ *   file name, with the error of each
+ * @error: return location for a #GError
+ *
+ * Finishes installing many launchers.
+ *
+ * Launchers that failed to install don't make the call fail; they are
+ * listed in @out_failures, which is empty if all were installed.
+ *
+ * Returns: %TRUE if every launcher was handled, %FALSE with @error set
+ *   if the call as a whole failed, for example because it was cancelled
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_portal_dynamic_launcher_install_all_finish (XdpPortal     *portal,
+                                                GAsyncResult  *result,
+                                                GHashTable   **out_failures,
+                                                GError       **error)
+{
+  return bulk_call_finish (portal, result, xdp_portal_dynamic_launcher_install_all, out_failures, error);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_all:
+ * @portal: a [class@Portal]
+ * @desktop_file_ids: (array zero-terminated=1): the .desktop file names
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when all launchers are done
+ * @data: (closure): data to pass to @callback
+ *
+ * Uninstalls many launchers at once, see
+ * [method@Portal.dynamic_launcher_install_all].
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_dynamic_launcher_uninstall_all (XdpPortal           *portal,
+                                           const char * const  *desktop_file_ids,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             data)
+{
+  g_autofree GVariant **parameters = NULL;
+  guint n_items;
+  guint i;
+
+  g_return_if_fail (XDP_IS_PORTAL (portal));
+  g_return_if_fail (desktop_file_ids != NULL);
+
+  n_items = g_strv_length ((char **) desktop_file_ids);
+
+  parameters = g_new (GVariant *, n_items + 1);
+  for (i = 0; i < n_items; i++)
+    parameters[i] = uninstall_parameters (desktop_file_ids[i]);
+
+  bulk_call (portal, "Uninstall", parameters, desktop_file_ids, n_items,
+             cancellable, callback, data,
+             xdp_portal_dynamic_launcher_uninstall_all);
+}
+
+/**
+ * xdp_portal_dynamic_launcher_uninstall_all_finish:
+ * @portal: a [class@Portal]
+ * @result: a [iface@Gio.AsyncResult]
+ * @out_failures: (out) (optional) (transfer full) (element-type utf8 GLib.Error):
+ *   return location for the launchers that failed to uninstall, by
+ *   .desktop file name, with the error of each
+ * @error: return location for a #GError
+ *
+ * Finishes uninstalling many launchers, see
+ * [method@Portal.dynamic_launcher_install_all_finish].
+ *
+ * Returns: %TRUE if every launcher was handled, %FALSE with @error set
+ *   if the call as a whole failed
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_portal_dynamic_launcher_uninstall_all_finish (XdpPortal     *portal,
+                                                  GAsyncResult  *result,
+                                                  GHashTable   **out_failures,
+                                                  GError       **error)
+{
+  return bulk_call_finish (portal, result, xdp_portal_dynamic_launcher_uninstall_all, out_failures, error);
+}
@@ -89,4 +89,110 @@ gboolean  xdp_portal_dynamic_launcher_launch                 (XdpPortal   *porta
                                                               const char  *activation_token,
                                                               GError     **error);
 
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_request_install_token_async  (XdpPortal           *portal,
+                                                                    const char          *name,
+                                                                    GVariant            *icon_v,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+char     *xdp_portal_dynamic_launcher_request_install_token_finish (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_install_async                (XdpPortal           *portal,
+                                                                    const char          *token,
+                                                                    const char          *desktop_file_id,
+                                                                    const char          *desktop_entry,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_dynamic_launcher_install_finish               (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_uninstall_async              (XdpPortal           *portal,
+                                                                    const char          *desktop_file_id,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_dynamic_launcher_uninstall_finish             (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_get_desktop_entry_async      (XdpPortal           *portal,
+                                                                    const char          *desktop_file_id,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+char     *xdp_portal_dynamic_launcher_get_desktop_entry_finish     (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_get_icon_async               (XdpPortal           *portal,
+                                                                    const char          *desktop_file_id,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+GVariant *xdp_portal_dynamic_launcher_get_icon_finish              (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    char               **out_icon_format,
+                                                                    guint               *out_icon_size,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_launch_async                 (XdpPortal           *portal,
+                                                                    const char          *desktop_file_id,
+                                                                    const char          *activation_token,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_dynamic_launcher_launch_finish                (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_install_all                  (XdpPortal           *portal,
+                                                                    const char * const  *tokens,
+                                                                    const char * const  *desktop_file_ids,
+                                                                    const char * const  *desktop_entries,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_dynamic_launcher_install_all_finish           (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GHashTable         **out_failures,
+                                                                    GError             **error);
+
+XDP_PUBLIC
+void      xdp_portal_dynamic_launcher_uninstall_all                (XdpPortal           *portal,
+                                                                    const char * const  *desktop_file_ids,
+                                                                    GCancellable        *cancellable,
+                                                                    GAsyncReadyCallback  callback,
+                                                                    gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_portal_dynamic_launcher_uninstall_all_finish         (XdpPortal           *portal,
+                                                                    GAsyncResult        *result,
+                                                                    GHashTable         **out_failures,
+                                                                    GError             **error);
+
 G_END_DECLS
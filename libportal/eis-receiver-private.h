@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include "inputcapture.h"
+
+G_BEGIN_DECLS
+
+typedef struct _XdpEisReceiver XdpEisReceiver;
+
+typedef void (* XdpEisReceiverFunc) (guint                   activation_id,
+                                     const XdpCapturedEvent *events,
+                                     gsize                   n_events,
+                                     gpointer                data);
+
+XdpEisReceiver * _xdp_eis_receiver_new   (int                  fd,
+                                          GMainContext        *context,
+                                          XdpEisReceiverFunc   func,
+                                          gpointer             data,
+                                          GError             **error);
+
+void             _xdp_eis_receiver_free  (XdpEisReceiver      *receiver);
+
+G_END_DECLS
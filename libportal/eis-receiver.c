@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include "eis-receiver-private.h"
+
+/*
+ * XdpEisReceiver:
+ *
+ * Receives the events of an input capture session over EIS with libei.
+ * The connection is dispatched by a source on a given main context; all
+ * events read in one dispatch are handed over as one batch, split where
+ * the EIS implementation starts or stops emulating, so that every batch
+ * belongs to exactly one activation.
+ */
+
+#ifdef HAVE_LIBEI
+
+#include <glib-unix.h>
+#include <libei.h>
+
+struct _XdpEisReceiver {
+  struct ei *ei;
+  GSource *source;
+  struct ei_seat *seat;
+
+  XdpEisReceiverFunc func;
+  gpointer data;
+
+  GArray *batch; /* XdpCapturedEvent */
+  guint activation_id;
+
+  gboolean dispatching;
+  gboolean destroyed;
+};
+
+static void
+receiver_free (XdpEisReceiver *receiver)
+{
+  g_clear_pointer (&receiver->batch, g_array_unref);
+  g_clear_pointer (&receiver->seat, ei_seat_unref);
+  g_clear_pointer (&receiver->ei, ei_unref);
+
+  g_free (receiver);
+}
+
+static void
+flush_batch (XdpEisReceiver *receiver)
+{
+  if (receiver->batch->len == 0 || receiver->destroyed)
+    return;
+
+  receiver->func (receiver->activation_id,
+                  (const XdpCapturedEvent *) receiver->batch->data,
+                  receiver->batch->len,
+                  receiver->data);
+
+  g_array_set_size (receiver->batch, 0);
+}
+
+static void
+add_event (XdpEisReceiver       *receiver,
+           struct ei_event      *event,
+           XdpCapturedEventType  type,
+           guint32               code,
+           gboolean              pressed,
+           double                x,
+           double                y)
+{
+  XdpCapturedEvent captured;
+
+  captured.type = type;
+  captured.pressed = pressed;
+  captured.code = code;
+  captured.time = ei_event_get_time (event);
+  captured.x = x;
+  captured.y = y;
+
+  g_array_append_val (receiver->batch, captured);
+}
+
+static void
+handle_event (XdpEisReceiver  *receiver,
+              struct ei_event *event)
+{
+  switch (ei_event_get_type (event))
+    {
+    case EI_EVENT_SEAT_ADDED:
+      if (receiver->seat)
+        break;
+      receiver->seat = ei_seat_ref (ei_event_get_seat (event));
+      ei_seat_bind_capabilities (receiver->seat,
+                                 EI_DEVICE_CAP_POINTER,
+                                 EI_DEVICE_CAP_POINTER_ABSOLUTE,
+                                 EI_DEVICE_CAP_BUTTON,
+                                 EI_DEVICE_CAP_SCROLL,
+                                 EI_DEVICE_CAP_KEYBOARD,
+                                 EI_DEVICE_CAP_TOUCH,
+                                 NULL);
+      break;
+
+    case EI_EVENT_SEAT_REMOVED:
+      if (ei_event_get_seat (event) == receiver->seat)
+        g_clear_pointer (&receiver->seat, ei_seat_unref);
+      break;
+
+    /* The sequence of an emulation is the activation_id of the portal */
+    case EI_EVENT_DEVICE_START_EMULATING:
+      flush_batch (receiver);
+      receiver->activation_id = ei_event_emulating_get_sequence (event);
+      break;
+
+    case EI_EVENT_DEVICE_STOP_EMULATING:
+    case EI_EVENT_DISCONNECT:
+      flush_batch (receiver);
+      break;
+
+    case EI_EVENT_FRAME:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_FRAME, 0, FALSE, 0, 0);
+      break;
+
+    case EI_EVENT_POINTER_MOTION:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_POINTER_MOTION, 0, FALSE,
+                 ei_event_pointer_get_dx (event),
+                 ei_event_pointer_get_dy (event));
+      break;
+
+    case EI_EVENT_POINTER_MOTION_ABSOLUTE:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_POINTER_MOTION_ABSOLUTE, 0, FALSE,
+                 ei_event_pointer_get_absolute_x (event),
+                 ei_event_pointer_get_absolute_y (event));
+      break;
+
+    case EI_EVENT_BUTTON_BUTTON:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_BUTTON,
+                 ei_event_button_get_button (event),
+                 ei_event_button_get_is_press (event),
+                 0, 0);
+      break;
+
+    case EI_EVENT_SCROLL_DELTA:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_SCROLL, 0, FALSE,
+                 ei_event_scroll_get_dx (event),
+                 ei_event_scroll_get_dy (event));
+      break;
+
+    case EI_EVENT_SCROLL_DISCRETE:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_SCROLL_DISCRETE, 0, FALSE,
+                 ei_event_scroll_get_discrete_dx (event),
+                 ei_event_scroll_get_discrete_dy (event));
+      break;
+
+    case EI_EVENT_SCROLL_STOP:
+    case EI_EVENT_SCROLL_CANCEL:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_SCROLL_STOP, 0, FALSE,
+                 ei_event_scroll_get_stop_x (event),
+                 ei_event_scroll_get_stop_y (event));
+      break;
+
+    case EI_EVENT_KEYBOARD_KEY:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_KEYBOARD_KEY,
+                 ei_event_keyboard_get_key (event),
+                 ei_event_keyboard_get_key_is_press (event),
+                 0, 0);
+      break;
+
+    case EI_EVENT_TOUCH_DOWN:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_TOUCH_DOWN,
+                 ei_event_touch_get_id (event), FALSE,
+                 ei_event_touch_get_x (event),
+                 ei_event_touch_get_y (event));
+      break;
+
+    case EI_EVENT_TOUCH_MOTION:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_TOUCH_MOTION,
+                 ei_event_touch_get_id (event), FALSE,
+                 ei_event_touch_get_x (event),
+                 ei_event_touch_get_y (event));
+      break;
+
+    case EI_EVENT_TOUCH_UP:
+      add_event (receiver, event, XDP_CAPTURED_EVENT_TOUCH_UP,
+                 ei_event_touch_get_id (event), FALSE, 0, 0);
+      break;
+
+    default:
+      break;
+    }
+}
+
+static gboolean
+ei_dispatch_cb (int          fd,
+                GIOCondition condition,
+                gpointer     data)
+{
+  XdpEisReceiver *receiver = data;
+  struct ei_event *event;
+  gboolean keep_source = TRUE;
+
+  receiver->dispatching = TRUE;
+
+  ei_dispatch (receiver->ei);
+  while (!receiver->destroyed && (event = ei_get_event (receiver->ei)))
+    {
+      if (ei_event_get_type (event) == EI_EVENT_DISCONNECT)
+        keep_source = FALSE;
+
+      handle_event (receiver, event);
+      ei_event_unref (event);
+    }
+
+  /* One call for everything read in this wakeup */
+  flush_batch (receiver);
+
+  receiver->dispatching = FALSE;
+
+  /* The callback stopped receiving */
+  if (receiver->destroyed)
+    {
+      receiver_free (receiver);
+      return G_SOURCE_REMOVE;
+    }
+
+  if (!keep_source || (condition & (G_IO_HUP | G_IO_ERR)))
+    {
+      g_clear_pointer (&receiver->source, g_source_unref);
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+XdpEisReceiver *
+_xdp_eis_receiver_new (int                  fd,
+                       GMainContext        *context,
+                       XdpEisReceiverFunc   func,
+                       gpointer             data,
+                       GError             **error)
+{
+  XdpEisReceiver *receiver;
+  int ret;
+
+  receiver = g_new0 (XdpEisReceiver, 1);
+  receiver->func = func;
+  receiver->data = data;
+  receiver->batch = g_array_sized_new (FALSE, FALSE, sizeof (XdpCapturedEvent), 64);
+
+  receiver->ei = ei_new_receiver (receiver);
+  ei_configure_name (receiver->ei, g_get_prgname () ? g_get_prgname () : "libportal");
+
+  /* libei owns @fd from here on */
+  ret = ei_setup_backend_fd (receiver->ei, fd);
+  if (ret < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "Failed to set up the EIS connection: %s", g_strerror (-ret));
+      receiver_free (receiver);
+      return NULL;
+    }
+
+  receiver->source = g_unix_fd_source_new (ei_get_fd (receiver->ei), G_IO_IN | G_IO_HUP | G_IO_ERR);
+  g_source_set_callback (receiver->source, (GSourceFunc) ei_dispatch_cb, receiver, NULL);
+  g_source_set_name (receiver->source, "[libportal] EIS receiver");
+  g_source_attach (receiver->source, context);
+
+  return receiver;
+}
+
+void
+_xdp_eis_receiver_free (XdpEisReceiver *receiver)
+{
+  if (receiver->source)
+    g_source_destroy (receiver->source);
+  g_clear_pointer (&receiver->source, g_source_unref);
+
+  /* Freed once the dispatch that called us returns */
+  if (receiver->dispatching)
+    {
+      receiver->destroyed = TRUE;
+      return;
+    }
+
+  receiver_free (receiver);
+}
+
+#else /* HAVE_LIBEI */
+
+XdpEisReceiver *
+_xdp_eis_receiver_new (int                  fd,
+                       GMainContext        *context,
+                       XdpEisReceiverFunc   func,
+                       gpointer             data,
+                       GError             **error)
+{
+  close (fd);
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "libportal was built without libei support");
+  return NULL;
+}
+
+void
+_xdp_eis_receiver_free (XdpEisReceiver *receiver)
+{
+}
+
+#endif /* HAVE_LIBEI */
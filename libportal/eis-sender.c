@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <unistd.h>
+
+#include "eis-sender-private.h"
+#include "keymap-private.h"
+
+/*
+ * XdpEisSender:
+ *
+ * Sends the input events of a remote desktop session over an EIS
+ * connection with libei, instead of as portal method calls. The
+ * connection is dispatched by a source on the thread-default main
+ * context of the thread that created the sender, and events must be
+ * sent from that thread.
+ *
+ * Events sent before the EIS implementation resumed any device are kept
+ * until it does; later events that no resumed device can emulate are
+ * dropped, like the portal would.
+ *
+ * EIS has no keysyms; they are typed with the key codes and modifiers
+ * of the keymap of the EIS keyboard, or of the default keymap if it has
+ * none.
+ */
+
+#ifdef HAVE_LIBEI
+
+#include <glib-unix.h>
+#include <libei.h>
+
+/* Enough for a burst of input while the EIS implementation sets up its
+ * devices, without growing without bounds if it never does */
+#define MAX_PENDING_EVENTS 256
+
+struct _XdpEisSender {
+  struct ei *ei;
+  GSource *source;
+
+  struct ei_seat *seat;
+  GPtrArray *devices; /* resumed struct ei_device */
+  GHashTable *touches; /* slot → struct ei_touch */
+  GArray *pending; /* InputEvent */
+  XdpKeymap *keymap;
+
+  guint32 sequence;
+  gboolean disconnected;
+};
+
+static enum ei_device_capability
+event_get_capability (const InputEvent *event)
+{
+  switch (event->type)
+    {
+    case INPUT_EVENT_POINTER_MOTION:
+      return EI_DEVICE_CAP_POINTER;
+
+    case INPUT_EVENT_POINTER_POSITION:
+      return EI_DEVICE_CAP_POINTER_ABSOLUTE;
+
+    case INPUT_EVENT_POINTER_BUTTON:
+      return EI_DEVICE_CAP_BUTTON;
+
+    case INPUT_EVENT_POINTER_AXIS:
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      return EI_DEVICE_CAP_SCROLL;
+
+    case INPUT_EVENT_KEYBOARD_KEY:
+      return EI_DEVICE_CAP_KEYBOARD;
+
+    case INPUT_EVENT_TOUCH_DOWN:
+    case INPUT_EVENT_TOUCH_POSITION:
+    case INPUT_EVENT_TOUCH_UP:
+    default:
+      return EI_DEVICE_CAP_TOUCH;
+    }
+}
+
+static struct ei_device *
+find_device (XdpEisSender              *sender,
+             enum ei_device_capability  capability)
+{
+  guint i;
+
+  for (i = 0; i < sender->devices->len; i++)
+    {
+      struct ei_device *device = g_ptr_array_index (sender->devices, i);
+
+      if (ei_device_has_capability (device, capability))
+        return device;
+    }
+
+  return NULL;
+}
+
+static void
+touch_up (XdpEisSender *sender,
+          guint         slot)
+{
+  struct ei_touch *touch;
+
+  touch = g_hash_table_lookup (sender->touches, GUINT_TO_POINTER (slot));
+  if (touch == NULL)
+    return;
+
+  ei_touch_up (touch);
+  g_hash_table_remove (sender->touches, GUINT_TO_POINTER (slot));
+}
+
+static gboolean
+send_keysym (XdpEisSender     *sender,
+             struct ei_device *device,
+             guint32           keysym,
+             gboolean          pressed)
+{
+  XdpKeymap *keymap = sender->keymap ? sender->keymap : _xdp_keymap_get_default ();
+  XdpKeyCombo combo;
+  guint i;
+
+  if (keymap == NULL || !_xdp_keymap_lookup (keymap, keysym, &combo))
+    {
+      g_debug ("No key in the keymap for keysym 0x%x, dropping key event", keysym);
+      return FALSE;
+    }
+
+  if (pressed)
+    {
+      for (i = 0; i < combo.n_modifiers; i++)
+        ei_device_keyboard_key (device, combo.modifiers[i], true);
+      ei_device_keyboard_key (device, combo.key, true);
+    }
+  else
+    {
+      ei_device_keyboard_key (device, combo.key, false);
+      for (i = combo.n_modifiers; i > 0; i--)
+        ei_device_keyboard_key (device, combo.modifiers[i - 1], false);
+    }
+
+  return TRUE;
+}
+
+static void
+load_keymap (XdpEisSender     *sender,
+             struct ei_device *device)
+{
+  struct ei_keymap *keymap;
+
+  if (sender->keymap || !ei_device_has_capability (device, EI_DEVICE_CAP_KEYBOARD))
+    return;
+
+  keymap = ei_device_keyboard_get_keymap (device);
+  if (keymap == NULL || ei_keymap_get_type (keymap) != EI_KEYMAP_TYPE_XKB)
+    return;
+
+  sender->keymap = _xdp_keymap_new_from_fd (ei_keymap_get_fd (keymap),
+                                            ei_keymap_get_size (keymap));
+}
+
+/* Absolute positions are in the logical space of the EIS device; the
+ * stream of the event is not used */
+static void
+send_to_device (XdpEisSender     *sender,
+                struct ei_device *device,
+                const InputEvent *event)
+{
+  struct ei_touch *touch;
+
+  switch (event->type)
+    {
+    case INPUT_EVENT_POINTER_MOTION:
+      ei_device_pointer_motion (device, event->u.motion.dx, event->u.motion.dy);
+      break;
+
+    case INPUT_EVENT_POINTER_POSITION:
+      ei_device_pointer_motion_absolute (device, event->u.position.x, event->u.position.y);
+      break;
+
+    case INPUT_EVENT_POINTER_BUTTON:
+      ei_device_button_button (device, event->u.button.button,
+                               event->u.button.state == XDP_BUTTON_PRESSED);
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS:
+      if (event->u.axis.dx != 0 || event->u.axis.dy != 0)
+        ei_device_scroll_delta (device, event->u.axis.dx, event->u.axis.dy);
+      if (event->u.axis.finish)
+        ei_device_scroll_stop (device, true, true);
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      /* EIS counts discrete scrolling in fractions of 120 per step */
+      if (event->u.axis_discrete.axis == XDP_AXIS_HORIZONTAL_SCROLL)
+        ei_device_scroll_discrete (device, event->u.axis_discrete.steps * 120, 0);
+      else
+        ei_device_scroll_discrete (device, 0, event->u.axis_discrete.steps * 120);
+      break;
+
+    case INPUT_EVENT_KEYBOARD_KEY:
+      if (event->u.key.keysym)
+        {
+          if (!send_keysym (sender, device, event->u.key.key,
+                            event->u.key.state == XDP_KEY_PRESSED))
+            return;
+          break;
+        }
+      ei_device_keyboard_key (device, event->u.key.key,
+                              event->u.key.state == XDP_KEY_PRESSED);
+      break;
+
+    case INPUT_EVENT_TOUCH_DOWN:
+      touch_up (sender, event->u.touch.slot);
+      touch = ei_device_touch_new (device);
+      ei_touch_down (touch, event->u.touch.x, event->u.touch.y);
+      g_hash_table_insert (sender->touches, GUINT_TO_POINTER (event->u.touch.slot), touch);
+      break;
+
+    case INPUT_EVENT_TOUCH_POSITION:
+      touch = g_hash_table_lookup (sender->touches, GUINT_TO_POINTER (event->u.touch.slot));
+      if (touch == NULL)
+        return;
+      ei_touch_motion (touch, event->u.touch.x, event->u.touch.y);
+      break;
+
+    case INPUT_EVENT_TOUCH_UP:
+      touch_up (sender, event->u.touch.slot);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  ei_device_frame (device, ei_now (sender->ei));
+}
+
+static void
+send_pending (XdpEisSender *sender)
+{
+  g_autoptr(GArray) pending = NULL;
+  guint i;
+
+  pending = g_steal_pointer (&sender->pending);
+  if (pending == NULL)
+    return;
+
+  for (i = 0; i < pending->len; i++)
+    _xdp_eis_sender_send (sender, &g_array_index (pending, InputEvent, i));
+}
+
+static void
+remove_device (XdpEisSender     *sender,
+               struct ei_device *device)
+{
+  if (g_ptr_array_remove (sender->devices, device))
+    {
+      /* Touches of the device end with it */
+      GHashTableIter iter;
+      struct ei_touch *touch;
+
+      g_hash_table_iter_init (&iter, sender->touches);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &touch))
+        {
+          if (ei_touch_get_device (touch) == device)
+            g_hash_table_iter_remove (&iter);
+        }
+    }
+}
+
+static void
+handle_event (XdpEisSender    *sender,
+              struct ei_event *event)
+{
+  struct ei_device *device;
+
+  switch (ei_event_get_type (event))
+    {
+    case EI_EVENT_SEAT_ADDED:
+      if (sender->seat)
+        break;
+      sender->seat = ei_seat_ref (ei_event_get_seat (event));
+      ei_seat_bind_capabilities (sender->seat,
+                                 EI_DEVICE_CAP_POINTER,
+                                 EI_DEVICE_CAP_POINTER_ABSOLUTE,
+                                 EI_DEVICE_CAP_BUTTON,
+                                 EI_DEVICE_CAP_SCROLL,
+                                 EI_DEVICE_CAP_KEYBOARD,
+                                 EI_DEVICE_CAP_TOUCH,
+                                 NULL);
+      break;
+
+    case EI_EVENT_SEAT_REMOVED:
+      if (ei_event_get_seat (event) == sender->seat)
+        g_clear_pointer (&sender->seat, ei_seat_unref);
+      break;
+
+    case EI_EVENT_DEVICE_RESUMED:
+      device = ei_event_get_device (event);
+      load_keymap (sender, device);
+      ei_device_start_emulating (device, ++sender->sequence);
+      g_ptr_array_add (sender->devices, ei_device_ref (device));
+      send_pending (sender);
+      break;
+
+    case EI_EVENT_DEVICE_PAUSED:
+    case EI_EVENT_DEVICE_REMOVED:
+      remove_device (sender, ei_event_get_device (event));
+      break;
+
+    case EI_EVENT_DISCONNECT:
+      sender->disconnected = TRUE;
+      g_hash_table_remove_all (sender->touches);
+      g_ptr_array_set_size (sender->devices, 0);
+      g_clear_pointer (&sender->pending, g_array_unref);
+      break;
+
+    default:
+      break;
+    }
+}
+
+static gboolean
+ei_dispatch_cb (int          fd,
+                GIOCondition condition,
+                gpointer     data)
+{
+  XdpEisSender *sender = data;
+  struct ei_event *event;
+
+  ei_dispatch (sender->ei);
+  while ((event = ei_get_event (sender->ei)))
+    {
+      handle_event (sender, event);
+      ei_event_unref (event);
+    }
+
+  if (sender->disconnected || (condition & (G_IO_HUP | G_IO_ERR)))
+    {
+      sender->disconnected = TRUE;
+      g_clear_pointer (&sender->source, g_source_unref);
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+XdpEisSender *
+_xdp_eis_sender_new (int      fd,
+                     GError **error)
+{
+  XdpEisSender *sender;
+  int ret;
+
+  sender = g_new0 (XdpEisSender, 1);
+  sender->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) ei_device_unref);
+  sender->touches = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) ei_touch_unref);
+
+  sender->ei = ei_new_sender (sender);
+  ei_configure_name (sender->ei, g_get_prgname () ? g_get_prgname () : "libportal");
+
+  /* libei owns @fd from here on */
+  ret = ei_setup_backend_fd (sender->ei, fd);
+  if (ret < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "Failed to set up the EIS connection: %s", g_strerror (-ret));
+      _xdp_eis_sender_free (sender);
+      return NULL;
+    }
+
+  sender->source = g_unix_fd_source_new (ei_get_fd (sender->ei), G_IO_IN | G_IO_HUP | G_IO_ERR);
+  g_source_set_callback (sender->source, (GSourceFunc) ei_dispatch_cb, sender, NULL);
+  g_source_set_name (sender->source, "[libportal] EIS sender");
+  g_source_attach (sender->source, g_main_context_get_thread_default ());
+
+  return sender;
+}
+
+void
+_xdp_eis_sender_send (XdpEisSender     *sender,
+                      const InputEvent *event)
+{
+  struct ei_device *device;
+
+  if (sender->disconnected)
+    return;
+
+  if (sender->devices->len == 0)
+    {
+      if (sender->pending == NULL)
+        sender->pending = g_array_new (FALSE, FALSE, sizeof (InputEvent));
+      if (sender->pending->len < MAX_PENDING_EVENTS)
+        g_array_append_val (sender->pending, *event);
+      return;
+    }
+
+  device = find_device (sender, event_get_capability (event));
+  if (device == NULL)
+    return;
+
+  send_to_device (sender, device, event);
+}
+
+void
+_xdp_eis_sender_free (XdpEisSender *sender)
+{
+  if (sender->source)
+    g_source_destroy (sender->source);
+  g_clear_pointer (&sender->source, g_source_unref);
+
+  g_clear_pointer (&sender->touches, g_hash_table_unref);
+  g_clear_pointer (&sender->devices, g_ptr_array_unref);
+  g_clear_pointer (&sender->pending, g_array_unref);
+  g_clear_pointer (&sender->keymap, _xdp_keymap_free);
+  g_clear_pointer (&sender->seat, ei_seat_unref);
+  g_clear_pointer (&sender->ei, ei_unref);
+
+  g_free (sender);
+}
+
+#else /* HAVE_LIBEI */
+
+XdpEisSender *
+_xdp_eis_sender_new (int      fd,
+                     GError **error)
+{
+  close (fd);
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "libportal was built without libei support");
+  return NULL;
+}
+
+void
+_xdp_eis_sender_send (XdpEisSender     *sender,
+                      const InputEvent *event)
+{
+}
+
+void
+_xdp_eis_sender_free (XdpEisSender *sender)
+{
+}
+
+#endif /* HAVE_LIBEI */
@@ -20,215 +20,28 @@
 #include "config.h"
 
 #include "filechooser.h"
-#include "portal-private.h"
-
-typedef struct {
-  XdpPortal *portal;
-  XdpParent *parent;
-  char *parent_handle;
-  char *method;
-  char *title;
-  gboolean multiple;
-  char *current_name;
-  char *current_folder;
-  char *current_file;
-  GVariant *files;
-  GVariant *filters;
-  GVariant *current_filter;
-  GVariant *choices;
-  guint signal_id;
-  GTask *task;
-  char *request_path;
-  guint cancelled_id;
-} FileCall;
-
-static void
-file_call_free (FileCall *call)
-{
-  if (call->parent)
-    {
-      call->parent->parent_unexport (call->parent);
-      xdp_parent_free (call->parent);
-    }
-  g_free (call->parent_handle);
-
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-
-  if (call->cancelled_id)
-    g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-
-  g_free (call->request_path);
-
-  g_object_unref (call->portal);
-  g_object_unref (call->task);
-
-  // call->method not free'ed as it is assigned from static strings
-  g_free (call->title);
-  g_free (call->current_name);
-  g_free (call->current_folder);
-  g_free (call->current_file);
-  if (call->files)
-    g_variant_unref (call->files);
-  if (call->filters)
-    g_variant_unref (call->filters);
-  if (call->current_filter)
-    g_variant_unref (call->current_filter);
-  if (call->choices)
-    g_variant_unref (call->choices);
-
-  g_free (call);
-}
-
-static void
-response_received (GDBusConnection *bus,
-                   const char *sender_name,
-                   const char *object_path,
-                   const char *interface_name,
-                   const char *signal_name,
-                   GVariant *parameters,
-                   gpointer data)
+#include "request-private.h"
+
+static XdpRequest *
+file_request_new (XdpPortal           *portal,
+                  XdpParent           *parent,
+                  const char          *method,
+                  const char          *title,
+                  GCancellable        *cancellable,
+                  GAsyncReadyCallback  callback,
+                  gpointer             data,
+                  gpointer             source_tag)
 {
-  FileCall *call = data;
-  guint32 response;
-  g_autoptr(GVariant) ret = NULL;
-
-  if (call->cancelled_id)
-    {
-      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-      call->cancelled_id = 0;
-    }
-
-  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
-
-  if (response == 0)
-    g_task_return_pointer (call->task, g_variant_ref (ret), (GDestroyNotify)g_variant_unref);
-  else if (response == 1)
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Filechooser canceled");
-  else
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Filechooser failed");
-
-  file_call_free (call);
-}
+  XdpRequest *request;
 
-static void open_file (FileCall *call);
+  request = _xdp_request_new (portal, parent,
+                              "org.freedesktop.portal.FileChooser",
+                              method,
+                              cancellable, callback, data,
+                              source_tag);
+  _xdp_request_set_args (request, g_variant_new ("(s)", title), NULL);
 
-static void
-parent_exported (XdpParent *parent,
-                 const char *handle,
-                 gpointer data)
-{
-  FileCall *call = data;
-  call->parent_handle = g_strdup (handle);
-  open_file (call);
-}
-
-static void
-cancelled_cb (GCancellable *cancellable,
-              gpointer data)
-{
-  FileCall *call = data;
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          call->request_path,
-                          REQUEST_INTERFACE,
-                          "Close",
-                          NULL,
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL, NULL, NULL);
-
-  g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "OpenFile call canceled by caller");
-
-  file_call_free (call);
-}
-
-static void
-call_returned (GObject *object,
-               GAsyncResult *result,
-               gpointer data)
-{
-  FileCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
-    {
-      if (call->cancelled_id)
-        {
-          g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-          call->cancelled_id = 0;
-        }
-
-      g_task_return_error (call->task, error);
-      file_call_free (call);
-    }
-}
-
-static void
-open_file (FileCall *call)
-{
-  GVariantBuilder options;
-  g_autofree char *token = NULL;
-  GCancellable *cancellable;
-
-  if (call->parent_handle == NULL)
-    {
-      call->parent->parent_export (call->parent, parent_exported, call);
-      return;
-    }
-
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
-
-  cancellable = g_task_get_cancellable (call->task);
-  if (cancellable)
-    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (cancelled_cb), call);
-
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  if (call->multiple)
-    g_variant_builder_add (&options, "{sv}", "multiple", g_variant_new_boolean (call->multiple));
-  if (call->files)
-    g_variant_builder_add (&options, "{sv}", "files", call->files);
-  if (call->filters)
-    g_variant_builder_add (&options, "{sv}", "filters", call->filters);
-  if (call->current_filter)
-    g_variant_builder_add (&options, "{sv}", "current_filter", call->current_filter);
-  if (call->choices)
-    g_variant_builder_add (&options, "{sv}", "choices", call->choices);
-  if (call->current_name)
-    g_variant_builder_add (&options, "{sv}", "current_name", g_variant_new_string (call->current_name));
-  if (call->current_folder)
-    g_variant_builder_add (&options, "{sv}", "current_folder", g_variant_new_bytestring (call->current_folder));
-  if (call->current_file)
-    g_variant_builder_add (&options, "{sv}", "current_file", g_variant_new_bytestring (call->current_file));
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.FileChooser",
-                          call->method,
-                          g_variant_new ("(ssa{sv})", call->parent_handle, call->title, &options),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL,
-                          call_returned,
-                          call);
+  return request;
 }
 
 /**
@@ -283,27 +96,24 @@ xdp_portal_open_file (XdpPortal *portal,
                       GAsyncReadyCallback  callback,
                       gpointer data)
 {
-  FileCall *call;
+  XdpRequest *request;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail ((flags & ~(XDP_OPEN_FILE_FLAG_MULTIPLE)) == 0);
 
-  call = g_new0 (FileCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-  call->method = "OpenFile";
-  call->title = g_strdup (title);
-  call->multiple = (flags & XDP_OPEN_FILE_FLAG_MULTIPLE) != 0;
-  call->filters = filters ? g_variant_ref (filters) : NULL;
-  call->current_filter = current_filter ? g_variant_ref (current_filter) : NULL;
-  call->choices = choices ? g_variant_ref (choices) : NULL;
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_open_file);
-
-  open_file (call);
+  request = file_request_new (portal, parent, "OpenFile", title,
+                              cancellable, callback, data,
+                              xdp_portal_open_file);
+  if (flags & XDP_OPEN_FILE_FLAG_MULTIPLE)
+    g_variant_builder_add (&request->options, "{sv}", "multiple", g_variant_new_boolean (TRUE));
+  if (filters)
+    g_variant_builder_add (&request->options, "{sv}", "filters", filters);
+  if (current_filter)
+    g_variant_builder_add (&request->options, "{sv}", "current_filter", current_filter);
+  if (choices)
+    g_variant_builder_add (&request->options, "{sv}", "choices", choices);
+
+  _xdp_request_send (request);
 }
 
 /**
@@ -379,29 +189,28 @@ xdp_portal_save_file (XdpPortal *portal,
                       GAsyncReadyCallback  callback,
                       gpointer data)
 {
-  FileCall *call;
+  XdpRequest *request;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail (flags == XDP_SAVE_FILE_FLAG_NONE);
 
-  call = g_new0 (FileCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-  call->method = "SaveFile";
-  call->title = g_strdup (title);
-  call->current_name = g_strdup (current_name);
-  call->current_folder = g_strdup (current_folder);
-  call->current_file = g_strdup (current_file);
-  call->filters = filters ? g_variant_ref (filters) : NULL;
-  call->current_filter = current_filter ? g_variant_ref (current_filter) : NULL;
-  call->choices = choices ? g_variant_ref (choices) : NULL;
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_save_file);
-
-  open_file (call);
+  request = file_request_new (portal, parent, "SaveFile", title,
+                              cancellable, callback, data,
+                              xdp_portal_save_file);
+  if (filters)
+    g_variant_builder_add (&request->options, "{sv}", "filters", filters);
+  if (current_filter)
+    g_variant_builder_add (&request->options, "{sv}", "current_filter", current_filter);
+  if (choices)
+    g_variant_builder_add (&request->options, "{sv}", "choices", choices);
+  if (current_name)
+    g_variant_builder_add (&request->options, "{sv}", "current_name", g_variant_new_string (current_name));
+  if (current_folder)
+    g_variant_builder_add (&request->options, "{sv}", "current_folder", g_variant_new_bytestring (current_folder));
+  if (current_file)
+    g_variant_builder_add (&request->options, "{sv}", "current_file", g_variant_new_bytestring (current_file));
+
+  _xdp_request_send (request);
 }
 
 /**
@@ -476,28 +285,24 @@ xdp_portal_save_files (XdpPortal *portal,
                        GAsyncReadyCallback  callback,
                        gpointer data)
 {
-  FileCall *call;
+  XdpRequest *request;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail (files != NULL);
   g_return_if_fail (flags == XDP_SAVE_FILE_FLAG_NONE);
 
-  call = g_new0 (FileCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
-  else
-    call->parent_handle = g_strdup ("");
-  call->method = "SaveFiles";
-  call->title = g_strdup (title);
-  call->current_name = g_strdup (current_name);
-  call->current_folder = g_strdup (current_folder);
-  call->files = g_variant_ref (files);
-  call->choices = choices ? g_variant_ref (choices) : NULL;
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_save_files);
-
-  open_file (call);
+  request = file_request_new (portal, parent, "SaveFiles", title,
+                              cancellable, callback, data,
+                              xdp_portal_save_files);
+  g_variant_builder_add (&request->options, "{sv}", "files", files);
+  if (choices)
+    g_variant_builder_add (&request->options, "{sv}", "choices", choices);
+  if (current_name)
+    g_variant_builder_add (&request->options, "{sv}", "current_name", g_variant_new_string (current_name));
+  if (current_folder)
+    g_variant_builder_add (&request->options, "{sv}", "current_folder", g_variant_new_bytestring (current_folder));
+
+  _xdp_request_send (request);
 }
 
 /**
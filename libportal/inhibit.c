@@ -27,7 +27,6 @@ typedef struct {
   XdpParent *parent;
   char *parent_handle;
   XdpInhibitFlags inhibit;
-  guint signal_id;
   guint cancelled_id;
   char *request_path;
   char *reason;
@@ -45,8 +44,7 @@ inhibit_call_free (InhibitCall *call)
     }
   g_free (call->parent_handle);
 
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -140,7 +138,7 @@ inhibit_cancelled_cb (GCancellable *cancellable,
   InhibitCall *call = data;
 
   g_debug ("inhibit cancelled, calling Close");
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -170,18 +168,9 @@ do_inhibit (InhibitCall *call)
       return;
     }
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, response_received, call);
 
   g_hash_table_insert (call->portal->inhibit_handles, GINT_TO_POINTER (call->id), g_strdup (call->request_path));
 
@@ -193,7 +182,7 @@ do_inhibit (InhibitCall *call)
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
   g_variant_builder_add (&options, "{sv}", "reason", g_variant_new_string (call->reason));
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Inhibit",
@@ -317,7 +306,7 @@ xdp_portal_session_uninhibit (XdpPortal *portal,
       return;
     }
 
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           PORTAL_BUS_NAME,
                           value,
                           REQUEST_INTERFACE,
@@ -335,7 +324,6 @@ typedef struct {
   char *parent_handle;
   GTask *task;
   char *request_path;
-  guint signal_id;
   guint cancelled_id;
   char *id;
 } CreateMonitorCall;
@@ -350,8 +338,7 @@ create_monitor_call_free (CreateMonitorCall *call)
     }
   g_free (call->parent_handle);
 
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -400,7 +387,7 @@ ensure_session_monitor_connection (XdpPortal *portal)
 {
   if (portal->state_changed_signal == 0)
     portal->state_changed_signal =
-       g_dbus_connection_signal_subscribe (portal->bus,
+       g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                            PORTAL_BUS_NAME,
                                            "org.freedesktop.portal.Inhibit",
                                            "StateChanged",
@@ -465,7 +452,7 @@ create_cancelled_cb (GCancellable *cancellable,
 {
   CreateMonitorCall *call = data;
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -521,30 +508,21 @@ create_monitor (CreateMonitorCall *call)
       return;
     }
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        create_response_received,
-                                                        call,
-                                                        NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, create_response_received, call);
 
   cancellable = g_task_get_cancellable (call->task);
   if (cancellable)
     call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (create_cancelled_cb), call);
 
-  session_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->id = g_strconcat (SESSION_PATH_PREFIX, call->portal->sender, "/", session_token, NULL);
+  session_token = _xdp_portal_new_token (call->portal);
+  call->id = g_strconcat (SESSION_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", session_token, NULL);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
   g_variant_builder_add (&options, "{sv}", "session_handle_token", g_variant_new_string (session_token));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Inhibit",
@@ -639,13 +617,13 @@ xdp_portal_session_monitor_stop (XdpPortal *portal)
 
   if (portal->state_changed_signal)
     {
-      g_dbus_connection_signal_unsubscribe (portal->bus, portal->state_changed_signal);
+      g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (portal), portal->state_changed_signal);
       portal->state_changed_signal = 0;
     }
 
   if (portal->session_monitor_handle)
     {
-      g_dbus_connection_call (portal->bus,
+      g_dbus_connection_call (_xdp_portal_get_bus (portal),
                               PORTAL_BUS_NAME,
                               portal->session_monitor_handle,
                               SESSION_INTERFACE,
@@ -676,7 +654,7 @@ xdp_portal_session_monitor_query_end_response (XdpPortal *portal)
   g_return_if_fail (XDP_IS_PORTAL (portal));
 
   if (portal->session_monitor_handle != NULL)
-    g_dbus_connection_call (portal->bus,
+    g_dbus_connection_call (_xdp_portal_get_bus (portal),
                             PORTAL_BUS_NAME,
                             PORTAL_OBJECT_PATH,
                             "org.freedesktop.portal.Inhibit",
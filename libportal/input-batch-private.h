@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include "input-batch.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  INPUT_EVENT_POINTER_MOTION,
+  INPUT_EVENT_POINTER_POSITION,
+  INPUT_EVENT_POINTER_BUTTON,
+  INPUT_EVENT_POINTER_AXIS,
+  INPUT_EVENT_POINTER_AXIS_DISCRETE,
+  INPUT_EVENT_KEYBOARD_KEY,
+  INPUT_EVENT_TOUCH_DOWN,
+  INPUT_EVENT_TOUCH_POSITION,
+  INPUT_EVENT_TOUCH_UP,
+} InputEventType;
+
+typedef struct {
+  InputEventType type;
+  union {
+    struct { double dx, dy; } motion;
+    struct { guint stream; double x, y; } position;
+    struct { int button; XdpButtonState state; } button;
+    struct { gboolean finish; double dx, dy; } axis;
+    struct { XdpDiscreteAxis axis; int steps; } axis_discrete;
+    struct { gboolean keysym; int key; XdpKeyState state; } key;
+    struct { guint stream; guint slot; double x, y; } touch;
+  } u;
+} InputEvent;
+
+const InputEvent * _xdp_input_batch_get_events  (XdpInputBatch *batch,
+                                                 guint         *n_events);
+
+XdpDeviceType      _xdp_input_event_get_device  (const InputEvent *event);
+
+G_END_DECLS
@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "input-batch-private.h"
+
+/**
+ * XdpInputBatch:
+ *
+ * A sequence of remote desktop input events.
+ *
+ * Each of the input functions of a remote desktop [class@Session], such
+ * as [method@Session.pointer_motion], sends a D-Bus message of its own.
+ * An `XdpInputBatch` collects events instead, so that
+ * [method@Session.send_events] can send them back to back, in the order
+ * they were added, and report how many of them the portal accepted.
+ *
+ * A batch can be sent more than once, and reused after
+ * [method@InputBatch.clear].
+ *
+ * Since: 0.9
+ */
+struct _XdpInputBatch {
+  GObject parent_instance;
+
+  GArray *events;
+};
+
+G_DEFINE_TYPE (XdpInputBatch, xdp_input_batch, G_TYPE_OBJECT)
+
+static void
+xdp_input_batch_finalize (GObject *object)
+{
+  XdpInputBatch *batch = XDP_INPUT_BATCH (object);
+
+  g_array_unref (batch->events);
+
+  G_OBJECT_CLASS (xdp_input_batch_parent_class)->finalize (object);
+}
+
+static void
+xdp_input_batch_class_init (XdpInputBatchClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xdp_input_batch_finalize;
+}
+
+static void
+xdp_input_batch_init (XdpInputBatch *batch)
+{
+  batch->events = g_array_new (FALSE, FALSE, sizeof (InputEvent));
+}
+
+static InputEvent *
+add_event (XdpInputBatch  *batch,
+           InputEventType  type)
+{
+  InputEvent *event;
+
+  g_array_set_size (batch->events, batch->events->len + 1);
+  event = &g_array_index (batch->events, InputEvent, batch->events->len - 1);
+  event->type = type;
+
+  return event;
+}
+
+/**
+ * xdp_input_batch_new:
+ *
+ * Creates a new, empty [class@InputBatch].
+ *
+ * Returns: (transfer full): a new [class@InputBatch]
+ *
+ * Since: 0.9
+ */
+XdpInputBatch *
+xdp_input_batch_new (void)
+{
+  return g_object_new (XDP_TYPE_INPUT_BATCH, NULL);
+}
+
+/**
+ * xdp_input_batch_get_n_events:
+ * @batch: a [class@InputBatch]
+ *
+ * Gets the number of events in @batch.
+ *
+ * Returns: the number of events
+ *
+ * Since: 0.9
+ */
+guint
+xdp_input_batch_get_n_events (XdpInputBatch *batch)
+{
+  g_return_val_if_fail (XDP_IS_INPUT_BATCH (batch), 0);
+
+  return batch->events->len;
+}
+
+/**
+ * xdp_input_batch_clear:
+ * @batch: a [class@InputBatch]
+ *
+ * Removes all events from @batch.
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_clear (XdpInputBatch *batch)
+{
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  g_array_set_size (batch->events, 0);
+}
+
+/**
+ * xdp_input_batch_pointer_motion:
+ * @batch: a [class@InputBatch]
+ * @dx: relative horizontal movement
+ * @dy: relative vertical movement
+ *
+ * Adds a relative pointer motion to @batch.
+ * See [method@Session.pointer_motion].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_pointer_motion (XdpInputBatch *batch,
+                                double         dx,
+                                double         dy)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_POINTER_MOTION);
+  event->u.motion.dx = dx;
+  event->u.motion.dy = dy;
+}
+
+/**
+ * xdp_input_batch_pointer_position:
+ * @batch: a [class@InputBatch]
+ * @stream: the node ID of the pipewire stream the position is relative to
+ * @x: new X position
+ * @y: new Y position
+ *
+ * Adds an absolute pointer motion to @batch.
+ * See [method@Session.pointer_position].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_pointer_position (XdpInputBatch *batch,
+                                  guint          stream,
+                                  double         x,
+                                  double         y)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_POINTER_POSITION);
+  event->u.position.stream = stream;
+  event->u.position.x = x;
+  event->u.position.y = y;
+}
+
+/**
+ * xdp_input_batch_pointer_button:
+ * @batch: a [class@InputBatch]
+ * @button: the button
+ * @state: the new state
+ *
+ * Adds a button state change to @batch.
+ * See [method@Session.pointer_button].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_pointer_button (XdpInputBatch  *batch,
+                                int             button,
+                                XdpButtonState  state)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_POINTER_BUTTON);
+  event->u.button.button = button;
+  event->u.button.state = state;
+}
+
+/**
+ * xdp_input_batch_pointer_axis:
+ * @batch: a [class@InputBatch]
+ * @finish: whether this is the last in a series of related events
+ * @dx: relative axis movement on the X axis
+ * @dy: relative axis movement on the Y axis
+ *
+ * Adds a smooth scroll event to @batch.
+ * See [method@Session.pointer_axis].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_pointer_axis (XdpInputBatch *batch,
+                              gboolean       finish,
+                              double         dx,
+                              double         dy)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_POINTER_AXIS);
+  event->u.axis.finish = !!finish;
+  event->u.axis.dx = dx;
+  event->u.axis.dy = dy;
+}
+
+/**
+ * xdp_input_batch_pointer_axis_discrete:
+ * @batch: a [class@InputBatch]
+ * @axis: the axis to change
+ * @steps: number of steps scrolled
+ *
+ * Adds a discrete scroll event to @batch.
+ * See [method@Session.pointer_axis_discrete].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_pointer_axis_discrete (XdpInputBatch   *batch,
+                                       XdpDiscreteAxis  axis,
+                                       int              steps)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_POINTER_AXIS_DISCRETE);
+  event->u.axis_discrete.axis = axis;
+  event->u.axis_discrete.steps = steps;
+}
+
+/**
+ * xdp_input_batch_keyboard_key:
+ * @batch: a [class@InputBatch]
+ * @keysym: whether to interpret @key as a keysym instead of a keycode
+ * @key: the keysym or keycode to change
+ * @state: the new state
+ *
+ * Adds a key state change to @batch.
+ * See [method@Session.keyboard_key].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_keyboard_key (XdpInputBatch *batch,
+                              gboolean       keysym,
+                              int            key,
+                              XdpKeyState    state)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_KEYBOARD_KEY);
+  event->u.key.keysym = !!keysym;
+  event->u.key.key = key;
+  event->u.key.state = state;
+}
+
+/**
+ * xdp_input_batch_touch_down:
+ * @batch: a [class@InputBatch]
+ * @stream: the node ID of the pipewire stream the position is relative to
+ * @slot: touch slot where the touch point appeared
+ * @x: new X position
+ * @y: new Y position
+ *
+ * Adds a touch down event to @batch.
+ * See [method@Session.touch_down].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_touch_down (XdpInputBatch *batch,
+                            guint          stream,
+                            guint          slot,
+                            double         x,
+                            double         y)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_TOUCH_DOWN);
+  event->u.touch.stream = stream;
+  event->u.touch.slot = slot;
+  event->u.touch.x = x;
+  event->u.touch.y = y;
+}
+
+/**
+ * xdp_input_batch_touch_position:
+ * @batch: a [class@InputBatch]
+ * @stream: the node ID of the pipewire stream the position is relative to
+ * @slot: touch slot that is changing position
+ * @x: new X position
+ * @y: new Y position
+ *
+ * Adds a touch motion event to @batch.
+ * See [method@Session.touch_position].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_touch_position (XdpInputBatch *batch,
+                                guint          stream,
+                                guint          slot,
+                                double         x,
+                                double         y)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_TOUCH_POSITION);
+  event->u.touch.stream = stream;
+  event->u.touch.slot = slot;
+  event->u.touch.x = x;
+  event->u.touch.y = y;
+}
+
+/**
+ * xdp_input_batch_touch_up:
+ * @batch: a [class@InputBatch]
+ * @slot: touch slot that changed
+ *
+ * Adds a touch up event to @batch.
+ * See [method@Session.touch_up].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_batch_touch_up (XdpInputBatch *batch,
+                          guint          slot)
+{
+  InputEvent *event;
+
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  event = add_event (batch, INPUT_EVENT_TOUCH_UP);
+  event->u.touch.slot = slot;
+}
+
+const InputEvent *
+_xdp_input_batch_get_events (XdpInputBatch *batch,
+                             guint         *n_events)
+{
+  *n_events = batch->events->len;
+  return (const InputEvent *) batch->events->data;
+}
+
+XdpDeviceType
+_xdp_input_event_get_device (const InputEvent *event)
+{
+  switch (event->type)
+    {
+    case INPUT_EVENT_KEYBOARD_KEY:
+      return XDP_DEVICE_KEYBOARD;
+
+    case INPUT_EVENT_TOUCH_DOWN:
+    case INPUT_EVENT_TOUCH_POSITION:
+    case INPUT_EVENT_TOUCH_UP:
+      return XDP_DEVICE_TOUCHSCREEN;
+
+    case INPUT_EVENT_POINTER_MOTION:
+    case INPUT_EVENT_POINTER_POSITION:
+    case INPUT_EVENT_POINTER_BUTTON:
+    case INPUT_EVENT_POINTER_AXIS:
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+    default:
+      return XDP_DEVICE_POINTER;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <libportal/remote.h>
+
+G_BEGIN_DECLS
+
+#define XDP_TYPE_INPUT_BATCH (xdp_input_batch_get_type ())
+
+XDP_PUBLIC
+G_DECLARE_FINAL_TYPE (XdpInputBatch, xdp_input_batch, XDP, INPUT_BATCH, GObject)
+
+XDP_PUBLIC
+XdpInputBatch *xdp_input_batch_new                   (void);
+
+XDP_PUBLIC
+guint          xdp_input_batch_get_n_events          (XdpInputBatch   *batch);
+
+XDP_PUBLIC
+void           xdp_input_batch_clear                 (XdpInputBatch   *batch);
+
+XDP_PUBLIC
+void           xdp_input_batch_pointer_motion        (XdpInputBatch   *batch,
+                                                      double           dx,
+                                                      double           dy);
+
+XDP_PUBLIC
+void           xdp_input_batch_pointer_position      (XdpInputBatch   *batch,
+                                                      guint            stream,
+                                                      double           x,
+                                                      double           y);
+
+XDP_PUBLIC
+void           xdp_input_batch_pointer_button        (XdpInputBatch   *batch,
+                                                      int              button,
+                                                      XdpButtonState   state);
+
+XDP_PUBLIC
+void           xdp_input_batch_pointer_axis          (XdpInputBatch   *batch,
+                                                      gboolean         finish,
+                                                      double           dx,
+                                                      double           dy);
+
+XDP_PUBLIC
+void           xdp_input_batch_pointer_axis_discrete (XdpInputBatch   *batch,
+                                                      XdpDiscreteAxis  axis,
+                                                      int              steps);
+
+XDP_PUBLIC
+void           xdp_input_batch_keyboard_key          (XdpInputBatch   *batch,
+                                                      gboolean         keysym,
+                                                      int              key,
+                                                      XdpKeyState      state);
+
+XDP_PUBLIC
+void           xdp_input_batch_touch_down            (XdpInputBatch   *batch,
+                                                      guint            stream,
+                                                      guint            slot,
+                                                      double           x,
+                                                      double           y);
+
+XDP_PUBLIC
+void           xdp_input_batch_touch_position        (XdpInputBatch   *batch,
+                                                      guint            stream,
+                                                      guint            slot,
+                                                      double           x,
+                                                      double           y);
+
+XDP_PUBLIC
+void           xdp_input_batch_touch_up              (XdpInputBatch   *batch,
+                                                      guint            slot);
+
+XDP_PUBLIC
+void           xdp_session_send_events              (XdpSession          *session,
+                                                      XdpInputBatch       *batch,
+                                                      GCancellable        *cancellable,
+                                                      GAsyncReadyCallback  callback,
+                                                      gpointer             data);
+
+XDP_PUBLIC
+gboolean       xdp_session_send_events_finish        (XdpSession          *session,
+                                                      GAsyncResult        *result,
+                                                      guint               *n_delivered,
+                                                      GError             **error);
+
+G_END_DECLS
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include "input-batch-private.h"
+
+G_BEGIN_DECLS
+
+typedef struct _XdpInputRecorder XdpInputRecorder;
+
+XdpInputRecorder * _xdp_input_recorder_new        (void);
+
+void               _xdp_input_recorder_add        (XdpInputRecorder  *recorder,
+                                                   const InputEvent  *event);
+
+GBytes *           _xdp_input_recorder_finish     (XdpInputRecorder  *recorder);
+
+void               _xdp_input_recorder_free       (XdpInputRecorder  *recorder);
+
+GVariant *         _xdp_input_recording_load      (GBytes            *bytes,
+                                                   XdpDeviceType     *devices,
+                                                   GError           **error);
+
+void               _xdp_input_recording_get_event (GVariant          *events,
+                                                   gsize              index,
+                                                   gint64            *time,
+                                                   InputEvent        *event);
+
+G_END_DECLS
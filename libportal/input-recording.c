@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "input-recording-private.h"
+
+/*
+ * XdpInputRecorder:
+ *
+ * Records the input events of a session with the time they were made,
+ * in microseconds since the first one.
+ *
+ * A recording is a serialized GVariant of type `(sqa(tyuuudd))`: a
+ * magic string, the format version and the events, in little endian.
+ * Every event is a fixed-size record, so a recording can be replayed
+ * straight from a mapped file, see g_mapped_file_get_bytes(). The
+ * members of a record are, in order, the time, the #InputEventType and
+ * then, depending on the type:
+ *
+ * - pointer motion: 0, 0, 0, dx, dy
+ * - pointer position: stream, 0, 0, x, y
+ * - pointer button: button, state, 0, 0, 0
+ * - pointer axis: finish, 0, 0, dx, dy
+ * - discrete pointer axis: axis, steps, 0, 0, 0
+ * - keyboard key: keysym, key, state, 0, 0
+ * - touch: stream, slot, 0, x, y
+ */
+
+#define RECORDING_MAGIC "libportal-input-recording"
+#define RECORDING_VERSION 1
+#define RECORDING_TYPE "(sqa(tyuuudd))"
+
+typedef struct {
+  gint64 time;
+  InputEvent event;
+} RecordedEvent;
+
+struct _XdpInputRecorder {
+  GMutex lock;
+  gint64 start;
+  GArray *events; /* RecordedEvent */
+};
+
+XdpInputRecorder *
+_xdp_input_recorder_new (void)
+{
+  XdpInputRecorder *recorder;
+
+  recorder = g_new0 (XdpInputRecorder, 1);
+  g_mutex_init (&recorder->lock);
+  recorder->events = g_array_new (FALSE, FALSE, sizeof (RecordedEvent));
+
+  return recorder;
+}
+
+/* Events may come from any thread once the input thread is enabled */
+void
+_xdp_input_recorder_add (XdpInputRecorder *recorder,
+                         const InputEvent *event)
+{
+  RecordedEvent recorded;
+  gint64 now = g_get_monotonic_time ();
+
+  g_mutex_lock (&recorder->lock);
+
+  if (recorder->events->len == 0)
+    recorder->start = now;
+
+  recorded.time = now - recorder->start;
+  recorded.event = *event;
+  g_array_append_val (recorder->events, recorded);
+
+  g_mutex_unlock (&recorder->lock);
+}
+
+static GVariant *
+serialize_event (const RecordedEvent *recorded)
+{
+  const InputEvent *event = &recorded->event;
+  guint32 a = 0, b = 0, c = 0;
+  double x = 0, y = 0;
+
+  switch (event->type)
+    {
+    case INPUT_EVENT_POINTER_MOTION:
+      x = event->u.motion.dx;
+      y = event->u.motion.dy;
+      break;
+
+    case INPUT_EVENT_POINTER_POSITION:
+      a = event->u.position.stream;
+      x = event->u.position.x;
+      y = event->u.position.y;
+      break;
+
+    case INPUT_EVENT_POINTER_BUTTON:
+      a = event->u.button.button;
+      b = event->u.button.state;
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS:
+      a = event->u.axis.finish;
+      x = event->u.axis.dx;
+      y = event->u.axis.dy;
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      a = event->u.axis_discrete.axis;
+      b = event->u.axis_discrete.steps;
+      break;
+
+    case INPUT_EVENT_KEYBOARD_KEY:
+      a = event->u.key.keysym;
+      b = event->u.key.key;
+      c = event->u.key.state;
+      break;
+
+    case INPUT_EVENT_TOUCH_DOWN:
+    case INPUT_EVENT_TOUCH_POSITION:
+    case INPUT_EVENT_TOUCH_UP:
+      a = event->u.touch.stream;
+      b = event->u.touch.slot;
+      x = event->u.touch.x;
+      y = event->u.touch.y;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return g_variant_new ("(tyuuudd)", (guint64) recorded->time, (guchar) event->type, a, b, c, x, y);
+}
+
+/* Frees @recorder */
+GBytes *
+_xdp_input_recorder_finish (XdpInputRecorder *recorder)
+{
+  g_autoptr(GVariant) recording = NULL;
+  GVariantBuilder builder;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(tyuuudd)"));
+  for (i = 0; i < recorder->events->len; i++)
+    g_variant_builder_add_value (&builder, serialize_event (&g_array_index (recorder->events, RecordedEvent, i)));
+
+  _xdp_input_recorder_free (recorder);
+
+  recording = g_variant_ref_sink (g_variant_new ("(sq@a(tyuuudd))",
+                                                 RECORDING_MAGIC,
+                                                 RECORDING_VERSION,
+                                                 g_variant_builder_end (&builder)));
+  if (G_BYTE_ORDER == G_BIG_ENDIAN)
+    {
+      GVariant *swapped = g_variant_byteswap (recording);
+
+      g_variant_unref (recording);
+      recording = swapped;
+    }
+
+  return g_variant_get_data_as_bytes (recording);
+}
+
+void
+_xdp_input_recorder_free (XdpInputRecorder *recorder)
+{
+  g_clear_pointer (&recorder->events, g_array_unref);
+  g_mutex_clear (&recorder->lock);
+  g_free (recorder);
+}
+
+/* Returns the array of events of a recording and the devices they need,
+ * after checking that every event can be replayed */
+GVariant *
+_xdp_input_recording_load (GBytes         *bytes,
+                           XdpDeviceType  *devices,
+                           GError        **error)
+{
+  g_autoptr(GVariant) recording = NULL;
+  g_autoptr(GVariant) events = NULL;
+  const char *magic;
+  guint16 version;
+  guint64 last_time = 0;
+  gsize n_events;
+  gsize i;
+
+  recording = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (RECORDING_TYPE), bytes, FALSE));
+  if (G_BYTE_ORDER == G_BIG_ENDIAN)
+    {
+      GVariant *swapped = g_variant_byteswap (recording);
+
+      g_variant_unref (recording);
+      recording = swapped;
+    }
+
+  g_variant_get (recording, "(&sq@a(tyuuudd))", &magic, &version, &events);
+  if (g_strcmp0 (magic, RECORDING_MAGIC) != 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Not an input recording");
+      return NULL;
+    }
+  if (version != RECORDING_VERSION)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Unsupported input recording version %u", version);
+      return NULL;
+    }
+
+  *devices = XDP_DEVICE_NONE;
+  n_events = g_variant_n_children (events);
+  for (i = 0; i < n_events; i++)
+    {
+      InputEvent event;
+      guint64 time;
+      guchar type;
+
+      g_variant_get_child (events, i, "(tyuuudd)", &time, &type, NULL, NULL, NULL, NULL, NULL);
+      if (type > INPUT_EVENT_TOUCH_UP || time < last_time)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "Invalid event %" G_GSIZE_FORMAT " in input recording", i);
+          return NULL;
+        }
+      last_time = time;
+
+      event.type = type;
+      *devices |= _xdp_input_event_get_device (&event);
+    }
+
+  return g_steal_pointer (&events);
+}
+
+void
+_xdp_input_recording_get_event (GVariant   *events,
+                                gsize       index,
+                                gint64     *time,
+                                InputEvent *event)
+{
+  guint64 t;
+  guchar type;
+  guint32 a, b, c;
+  double x, y;
+
+  g_variant_get_child (events, index, "(tyuuudd)", &t, &type, &a, &b, &c, &x, &y);
+
+  *time = t;
+  event->type = type;
+
+  switch (event->type)
+    {
+    case INPUT_EVENT_POINTER_MOTION:
+      event->u.motion.dx = x;
+      event->u.motion.dy = y;
+      break;
+
+    case INPUT_EVENT_POINTER_POSITION:
+      event->u.position.stream = a;
+      event->u.position.x = x;
+      event->u.position.y = y;
+      break;
+
+    case INPUT_EVENT_POINTER_BUTTON:
+      event->u.button.button = a;
+      event->u.button.state = b;
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS:
+      event->u.axis.finish = !!a;
+      event->u.axis.dx = x;
+      event->u.axis.dy = y;
+      break;
+
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      event->u.axis_discrete.axis = a;
+      event->u.axis_discrete.steps = (gint32) b;
+      break;
+
+    case INPUT_EVENT_KEYBOARD_KEY:
+      event->u.key.keysym = !!a;
+      event->u.key.key = (gint32) b;
+      event->u.key.state = c;
+      break;
+
+    case INPUT_EVENT_TOUCH_DOWN:
+    case INPUT_EVENT_TOUCH_POSITION:
+    case INPUT_EVENT_TOUCH_UP:
+      event->u.touch.stream = a;
+      event->u.touch.slot = b;
+      event->u.touch.x = x;
+      event->u.touch.y = y;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "input-thread-private.h"
+#include "session-private.h"
+
+/*
+ * XdpInputThread:
+ *
+ * A thread that sends the input events of a remote desktop session, with
+ * a main context of its own. Events are pushed from any thread and sent
+ * in the order they were pushed; pending pointer motion is collected
+ * and flushed on this thread, so a busy application main loop does not
+ * hold it back.
+ */
+
+struct _XdpInputThread {
+  XdpSession *session; /* unowned */
+
+  GThread *thread;
+  GMainContext *context;
+  GMainLoop *loop;
+
+  GMutex lock;
+  GCond cond;
+  GArray *queue; /* InputEvent */
+  GSource *dispatch_source;
+  guint64 n_pushed;
+  guint64 n_handled;
+};
+
+/* Runs on the input thread */
+static void
+drain_queue (XdpInputThread *thread)
+{
+  g_autoptr(GArray) queue = NULL;
+  guint i;
+
+  g_mutex_lock (&thread->lock);
+  if (thread->dispatch_source)
+    g_source_destroy (thread->dispatch_source);
+  g_clear_pointer (&thread->dispatch_source, g_source_unref);
+  queue = thread->queue;
+  thread->queue = g_array_new (FALSE, FALSE, sizeof (InputEvent));
+  g_mutex_unlock (&thread->lock);
+
+  for (i = 0; i < queue->len; i++)
+    _xdp_session_handle_event (thread->session, &g_array_index (queue, InputEvent, i));
+
+  g_mutex_lock (&thread->lock);
+  thread->n_handled += queue->len;
+  g_cond_broadcast (&thread->cond);
+  g_mutex_unlock (&thread->lock);
+}
+
+static gboolean
+dispatch_events (gpointer data)
+{
+  drain_queue (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+sync_events (gpointer data)
+{
+  XdpInputThread *thread = data;
+
+  drain_queue (thread);
+  _xdp_session_flush_motion (thread->session);
+
+  g_mutex_lock (&thread->lock);
+  thread->n_handled++;
+  g_cond_broadcast (&thread->cond);
+  g_mutex_unlock (&thread->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+stop_thread (gpointer data)
+{
+  XdpInputThread *thread = data;
+
+  g_main_loop_quit (thread->loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Unlike g_main_context_invoke(), never runs @func on the calling thread */
+static void
+invoke_on_thread (XdpInputThread *thread,
+                  GSourceFunc     func)
+{
+  g_autoptr(GSource) source = NULL;
+
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_HIGH);
+  g_source_set_callback (source, func, thread, NULL);
+  g_source_attach (source, thread->context);
+}
+
+static gpointer
+input_thread_func (gpointer data)
+{
+  XdpInputThread *thread = data;
+
+  g_main_context_push_thread_default (thread->context);
+
+  g_main_loop_run (thread->loop);
+
+  /* Send what was pushed before the thread was asked to stop */
+  drain_queue (thread);
+  _xdp_session_flush_motion (thread->session);
+
+  g_main_context_pop_thread_default (thread->context);
+
+  return NULL;
+}
+
+XdpInputThread *
+_xdp_input_thread_new (XdpSession *session)
+{
+  XdpInputThread *thread;
+
+  thread = g_new0 (XdpInputThread, 1);
+  thread->session = session;
+  thread->context = g_main_context_new ();
+  thread->loop = g_main_loop_new (thread->context, FALSE);
+  thread->queue = g_array_new (FALSE, FALSE, sizeof (InputEvent));
+  g_mutex_init (&thread->lock);
+  g_cond_init (&thread->cond);
+
+  thread->thread = g_thread_new ("libportal-input", input_thread_func, thread);
+
+  return thread;
+}
+
+void
+_xdp_input_thread_push (XdpInputThread   *thread,
+                        const InputEvent *event)
+{
+  g_mutex_lock (&thread->lock);
+
+  g_array_append_val (thread->queue, *event);
+  thread->n_pushed++;
+
+  if (thread->dispatch_source == NULL)
+    {
+      thread->dispatch_source = g_idle_source_new ();
+      g_source_set_priority (thread->dispatch_source, G_PRIORITY_HIGH);
+      g_source_set_callback (thread->dispatch_source, dispatch_events, thread, NULL);
+      g_source_set_name (thread->dispatch_source, "[libportal] input events");
+      g_source_attach (thread->dispatch_source, thread->context);
+    }
+
+  g_mutex_unlock (&thread->lock);
+}
+
+/* Waits until everything pushed so far, including pending motion, was
+ * handed to the connection */
+void
+_xdp_input_thread_sync (XdpInputThread *thread)
+{
+  guint64 target;
+
+  g_mutex_lock (&thread->lock);
+  /* The sync counts as one more handled item */
+  target = ++thread->n_pushed;
+  g_mutex_unlock (&thread->lock);
+
+  invoke_on_thread (thread, sync_events);
+
+  g_mutex_lock (&thread->lock);
+  while (thread->n_handled < target)
+    g_cond_wait (&thread->cond, &thread->lock);
+  g_mutex_unlock (&thread->lock);
+}
+
+void
+_xdp_input_thread_free (XdpInputThread *thread)
+{
+  /* Quitting from within the loop also works if it isn't running yet */
+  invoke_on_thread (thread, stop_thread);
+  g_thread_join (thread->thread);
+
+  g_clear_pointer (&thread->queue, g_array_unref);
+  g_main_loop_unref (thread->loop);
+  g_main_context_unref (thread->context);
+  g_mutex_clear (&thread->lock);
+  g_cond_clear (&thread->cond);
+
+  g_free (thread);
+}
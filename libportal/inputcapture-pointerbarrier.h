@@ -28,4 +28,26 @@ G_BEGIN_DECLS
 XDP_PUBLIC
 G_DECLARE_FINAL_TYPE (XdpInputCapturePointerBarrier, xdp_input_capture_pointer_barrier, XDP, INPUT_CAPTURE_POINTER_BARRIER, GObject)
 
+/**
+ * XdpInputCaptureBarrierSpec:
+ * @id: the barrier id, unique within the session
+ * @x1: the x coordinate of the first point
+ * @y1: the y coordinate of the first point
+ * @x2: the x coordinate of the second point
+ * @y2: the y coordinate of the second point
+ *
+ * A pointer barrier as a plain struct, see
+ * [method@InputCaptureSession.set_barriers]. The barrier is horizontal if
+ * @y1 equals @y2 and vertical if @x1 equals @x2.
+ *
+ * Since: 0.9
+ */
+typedef struct {
+  unsigned int id;
+  int x1;
+  int y1;
+  int x2;
+  int y2;
+} XdpInputCaptureBarrierSpec;
+
 G_END_DECLS
@@ -28,3 +28,17 @@ _xdp_input_capture_pointer_barrier_set_is_active (XdpInputCapturePointerBarrier
 
 void
 _xdp_input_capture_zone_invalidate_and_free  (XdpInputCaptureZone *zone);
+
+typedef struct _XdpZoneIndex XdpZoneIndex;
+
+XdpZoneIndex *
+_xdp_zone_index_new (const XdpInputCaptureZoneRect *rects,
+                     gsize                          n_rects);
+
+int
+_xdp_zone_index_lookup (XdpZoneIndex *index,
+                        double        x,
+                        double        y);
+
+void
+_xdp_zone_index_free (XdpZoneIndex *index);
@@ -19,7 +19,10 @@
 
 #include "config.h"
 
+#include <stdlib.h>
+
 #include "inputcapture-zone.h"
+#include "inputcapture-private.h"
 
 /**
  * XdpInputCaptureZone
@@ -236,3 +239,186 @@ _xdp_input_capture_zone_invalidate_and_free (XdpInputCaptureZone *zone)
   g_object_set (zone, "is-valid", FALSE, NULL);
   g_object_unref (zone);
 }
+
+/*
+ * XdpZoneIndex:
+ *
+ * Finds the zone at a point in O(log n). The x edges of all zones cut
+ * the plane into vertical slabs; each slab lists the zones spanning it,
+ * sorted by y, with the lowest bottom edge seen so far, so a lookup is
+ * a binary search for the slab and one for the zone. Overlapping zones
+ * are allowed, at the cost of walking back over them.
+ */
+struct _XdpZoneIndex {
+  const XdpInputCaptureZoneRect *rects;
+
+  gint64 *edges; /* sorted, distinct */
+  guint n_edges;
+
+  /* The zones of slab i are zones[offsets[i]] to zones[offsets[i + 1] - 1] */
+  guint *offsets;
+  guint *zones;
+  gint64 *max_bottoms; /* of zones[offsets[i]] to zones[j], for each j */
+};
+
+static int
+compare_edges (gconstpointer a,
+               gconstpointer b)
+{
+  gint64 ea = *(const gint64 *) a;
+  gint64 eb = *(const gint64 *) b;
+
+  return (ea > eb) - (ea < eb);
+}
+
+static int
+compare_zones_by_y (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      data)
+{
+  const XdpInputCaptureZoneRect *rects = data;
+  int ya = rects[*(const guint *) a].y;
+  int yb = rects[*(const guint *) b].y;
+
+  return (ya > yb) - (ya < yb);
+}
+
+/* @rects must outlive the index */
+XdpZoneIndex *
+_xdp_zone_index_new (const XdpInputCaptureZoneRect *rects,
+                     gsize                          n_rects)
+{
+  g_autoptr(GArray) zones = NULL;
+  g_autoptr(GArray) max_bottoms = NULL;
+  XdpZoneIndex *index;
+  gsize i;
+  guint n_edges = 0;
+  guint slab;
+
+  index = g_new0 (XdpZoneIndex, 1);
+  index->rects = rects;
+  index->edges = g_new (gint64, 2 * n_rects + 1);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      if (rects[i].width == 0 || rects[i].height == 0)
+        continue;
+
+      index->edges[n_edges++] = rects[i].x;
+      index->edges[n_edges++] = (gint64) rects[i].x + rects[i].width;
+    }
+
+  qsort (index->edges, n_edges, sizeof (gint64), compare_edges);
+  for (i = 0; i < n_edges; i++)
+    {
+      if (index->n_edges == 0 || index->edges[index->n_edges - 1] != index->edges[i])
+        index->edges[index->n_edges++] = index->edges[i];
+    }
+
+  zones = g_array_new (FALSE, FALSE, sizeof (guint));
+  max_bottoms = g_array_new (FALSE, FALSE, sizeof (gint64));
+  index->offsets = g_new0 (guint, index->n_edges + 1);
+
+  for (slab = 0; slab + 1 < index->n_edges; slab++)
+    {
+      gint64 left = index->edges[slab];
+      gint64 right = index->edges[slab + 1];
+      guint start = zones->len;
+      gint64 max_bottom = G_MININT64;
+      guint j;
+
+      index->offsets[slab] = start;
+
+      for (i = 0; i < n_rects; i++)
+        {
+          guint zone = i;
+
+          if (rects[i].width == 0 || rects[i].height == 0)
+            continue;
+
+          if (rects[i].x <= left && (gint64) rects[i].x + rects[i].width >= right)
+            g_array_append_val (zones, zone);
+        }
+
+      g_qsort_with_data (&g_array_index (zones, guint, start),
+                         zones->len - start, sizeof (guint),
+                         compare_zones_by_y, (gpointer) rects);
+
+      for (j = start; j < zones->len; j++)
+        {
+          const XdpInputCaptureZoneRect *rect = &rects[g_array_index (zones, guint, j)];
+
+          max_bottom = MAX (max_bottom, (gint64) rect->y + rect->height);
+          g_array_append_val (max_bottoms, max_bottom);
+        }
+    }
+  index->offsets[MAX (index->n_edges, 1) - 1] = zones->len;
+
+  index->zones = (guint *) g_array_free (g_steal_pointer (&zones), FALSE);
+  index->max_bottoms = (gint64 *) g_array_free (g_steal_pointer (&max_bottoms), FALSE);
+
+  return index;
+}
+
+/* Returns: the index of the zone containing (@x, @y), or -1 */
+int
+_xdp_zone_index_lookup (XdpZoneIndex *index,
+                        double        x,
+                        double        y)
+{
+  guint lo, hi;
+  guint slab;
+
+  if (index->n_edges < 2 || x < index->edges[0] || x >= index->edges[index->n_edges - 1])
+    return -1;
+
+  /* The last edge at or left of x starts the slab */
+  lo = 0;
+  hi = index->n_edges - 1;
+  while (hi - lo > 1)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (index->edges[mid] <= x)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  slab = lo;
+
+  /* The last zone in the slab starting at or above y */
+  lo = index->offsets[slab];
+  hi = index->offsets[slab + 1];
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (index->rects[index->zones[mid]].y <= y)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  /* Walk back while an earlier zone may still reach down to y */
+  while (lo > index->offsets[slab] && index->max_bottoms[lo - 1] > y)
+    {
+      const XdpInputCaptureZoneRect *rect;
+
+      lo--;
+      rect = &index->rects[index->zones[lo]];
+      if (y < (gint64) rect->y + rect->height)
+        return index->zones[lo];
+    }
+
+  return -1;
+}
+
+void
+_xdp_zone_index_free (XdpZoneIndex *index)
+{
+  g_free (index->edges);
+  g_free (index->offsets);
+  g_free (index->zones);
+  g_free (index->max_bottoms);
+  g_free (index);
+}
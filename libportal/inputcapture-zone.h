@@ -28,4 +28,23 @@ G_BEGIN_DECLS
 XDP_PUBLIC
 G_DECLARE_FINAL_TYPE (XdpInputCaptureZone, xdp_input_capture_zone, XDP, INPUT_CAPTURE_ZONE, GObject)
 
+/**
+ * XdpInputCaptureZoneRect:
+ * @x: the x offset of the zone in logical pixels
+ * @y: the y offset of the zone in logical pixels
+ * @width: the width of the zone in logical pixels
+ * @height: the height of the zone in logical pixels
+ *
+ * The geometry of a zone, see
+ * [method@InputCaptureSession.get_zone_rects].
+ *
+ * Since: 0.9
+ */
+typedef struct {
+  int x;
+  int y;
+  unsigned int width;
+  unsigned int height;
+} XdpInputCaptureZoneRect;
+
 G_END_DECLS
@@ -22,7 +22,9 @@
 #include <gio/gunixfdlist.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <unistd.h>
 
+#include "eis-receiver-private.h"
 #include "inputcapture.h"
 #include "inputcapture-private.h"
 #include "portal-private.h"
@@ -63,11 +65,25 @@ struct _XdpInputCaptureSession
   GObject parent_instance;
   XdpSession *parent_session; /* strong ref */
 
-  GList *zones;
+  GArray *zone_rects; /* XdpInputCaptureZoneRect */
+  XdpZoneIndex *zone_index; /* built on first use */
+  GList *zones; /* XdpInputCaptureZone, built on first use */
 
   guint signal_ids[SIGNAL_LAST_SIGNAL];
   guint zone_serial;
   guint zone_set;
+  guint zones_invalidated_set; /* reported by the next zones-changed */
+  gboolean zones_fetching; /* a GetZones for ZonesChanged is in flight */
+  gboolean zones_dirty; /* ZonesChanged arrived during that GetZones */
+
+  GArray *barriers; /* XdpInputCaptureBarrierSpec, last accepted set */
+  GArray *pending_barriers; /* XdpInputCaptureBarrierSpec, last set sent */
+  guint barrier_serial;
+
+  XdpEisReceiver *eis_receiver;
+  XdpCapturedEventsFunc captured_func;
+  gpointer captured_data;
+  GDestroyNotify captured_destroy;
 };
 
 G_DEFINE_TYPE (XdpInputCaptureSession, xdp_input_capture_session, G_TYPE_OBJECT)
@@ -94,6 +110,8 @@ xdp_input_capture_session_finalize (GObject *object)
   XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (object);
   XdpSession *parent_session = session->parent_session;
 
+  xdp_input_capture_session_stop_receiving (session);
+
   if (parent_session == NULL)
     {
       g_critical ("XdpSession destroyed before XdpInputCaptureSesssion, you lost count of your session refs");
@@ -104,7 +122,7 @@ xdp_input_capture_session_finalize (GObject *object)
         {
           guint signal_id = session->signal_ids[i];
           if (signal_id > 0)
-            g_dbus_connection_signal_unsubscribe (parent_session->portal->bus, signal_id);
+            _xdp_portal_unsubscribe_session_signal (parent_session->portal, signal_id);
         }
 
       g_object_weak_unref (G_OBJECT (parent_session), parent_session_destroy, session);
@@ -113,6 +131,10 @@ xdp_input_capture_session_finalize (GObject *object)
     }
 
   g_list_free_full (g_steal_pointer (&session->zones), g_object_unref);
+  g_clear_pointer (&session->zone_index, _xdp_zone_index_free);
+  g_clear_pointer (&session->zone_rects, g_array_unref);
+  g_clear_pointer (&session->barriers, g_array_unref);
+  g_clear_pointer (&session->pending_barriers, g_array_unref);
 
   G_OBJECT_CLASS (xdp_input_capture_session_parent_class)->finalize (object);
 }
@@ -208,6 +230,8 @@ xdp_input_capture_session_init (XdpInputCaptureSession *session)
 {
   session->parent_session = NULL;
   session->zones = NULL;
+  session->zone_rects = NULL;
+  session->zone_index = NULL;
   session->zone_set = 0;
   for (guint i = 0; i < SIGNAL_LAST_SIGNAL; i++)
     session->signal_ids[i] = 0;
@@ -218,7 +242,6 @@ typedef struct {
   XdpPortal *portal;
   char *session_path; /* object path for session */
   GTask *task;
-  guint signal_id; /* Request::Response signal */
   char *request_path; /* object path for request */
   guint cancelled_id; /* signal id for cancelled gobject signal */
 
@@ -233,6 +256,11 @@ typedef struct {
   /* SetPointerBarrier only */
   GList *barriers;
 
+  /* Barrier struct array calls only */
+  GArray *barrier_specs; /* XdpInputCaptureBarrierSpec */
+  GArray *failed_ids; /* guint */
+  guint barrier_serial;
+
 } Call;
 
 static void create_session (Call *call);
@@ -249,9 +277,14 @@ call_free (Call *call)
     }
   g_free (call->parent_handle);
 
+  /* Barrier struct arrays */
+  if (call->barrier_specs && call->barrier_serial == call->session->barrier_serial)
+    g_clear_pointer (&call->session->pending_barriers, g_array_unref);
+  g_clear_pointer (&call->barrier_specs, g_array_unref);
+  g_clear_pointer (&call->failed_ids, g_array_unref);
+
   /* Generic */
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -289,81 +322,100 @@ call_returned (GObject *object,
     }
 }
 
-static gboolean
-handle_matches_session (XdpInputCaptureSession *session, const char *id)
-{
-  const char *sid = session->parent_session->id;
-
-  return g_str_equal (sid, id);
-}
-
 static void
 set_zones (XdpInputCaptureSession *session, GVariant *zones, guint zone_set)
 {
-  GList *list = NULL;
   gsize nzones = g_variant_n_children (zones);
+  GArray *rects;
 
+  rects = g_array_sized_new (FALSE, FALSE, sizeof (XdpInputCaptureZoneRect), nzones);
   for (gsize i = 0; i < nzones; i++)
     {
-        guint width, height;
-        gint x, y;
-        XdpInputCaptureZone *z;
-
-        g_variant_get_child (zones, i, "(uuii)", &width, &height, &x, &y);
-
-        z = g_object_new (XDP_TYPE_INPUT_CAPTURE_ZONE,
-                          "width", width,
-                          "height", height,
-                          "x", x,
-                          "y", y,
-                          "zone-set", zone_set,
-                          "is-valid", TRUE,
-                          NULL);
-        list = g_list_append (list, z);
+      XdpInputCaptureZoneRect rect;
+
+      g_variant_get_child (zones, i, "(uuii)", &rect.width, &rect.height, &rect.x, &rect.y);
+      g_array_append_val (rects, rect);
     }
 
   g_list_free_full (g_steal_pointer (&session->zones), (GDestroyNotify)_xdp_input_capture_zone_invalidate_and_free);
-  session->zones = list;
+  g_clear_pointer (&session->zone_index, _xdp_zone_index_free);
+  g_clear_pointer (&session->zone_rects, g_array_unref);
+  session->zone_rects = rects;
   session->zone_set = zone_set;
+
+  /* The portal drops all barriers when the zones change */
+  g_clear_pointer (&session->barriers, g_array_unref);
+  g_clear_pointer (&session->pending_barriers, g_array_unref);
+  session->barrier_serial++;
 }
 
 
 static void
-prep_call (Call *call, GDBusSignalCallback callback, GVariantBuilder *options, void *userdata)
+prep_call (Call *call, GDBusSignalCallback callback, GVariantBuilder *options)
 {
   g_autofree char *token = NULL;
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        callback,
-                                                        call,
-                                                        userdata);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, callback, call);
 
   g_variant_builder_init (options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (options, "{sv}", "handle_token", g_variant_new_string (token));
 }
 
+static void refetch_zones (XdpInputCaptureSession *session);
+
 static void
-zones_changed_emit_signal (GObject *source_object,
-                           GAsyncResult *res,
-                           gpointer data)
+zones_refetched (GObject *source_object,
+                 GAsyncResult *res,
+                 gpointer data)
 {
-  XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (data);
+  XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (source_object);
+  g_autoptr(XdpInputCaptureSession) result = NULL;
+  g_autoptr(GError) error = NULL;
   GVariantBuilder options;
 
+  result = g_task_propagate_pointer (G_TASK (res), &error);
+
+  session->zones_fetching = FALSE;
+
+  /* More ZonesChanged arrived while we were fetching, what we got is
+   * already stale. Only notify once we have the newest zone set. */
+  if (session->zones_dirty)
+    {
+      refetch_zones (session);
+      return;
+    }
+
+  /* The zones we have are still the old ones, don't claim otherwise */
+  if (result == NULL)
+    {
+      g_warning ("Failed to fetch the changed zones: %s", error->message);
+      return;
+    }
+
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "zone_set", g_variant_new_uint32 (session->zone_set - 1));
+  g_variant_builder_add (&options, "{sv}", "zone_set", g_variant_new_uint32 (session->zones_invalidated_set));
 
   g_signal_emit (session, signals[SIGNAL_ZONES_CHANGED], 0, g_variant_new ("a{sv}", &options));
 }
 
+static void
+refetch_zones (XdpInputCaptureSession *session)
+{
+  Call *call;
+
+  session->zones_dirty = FALSE;
+  session->zones_fetching = TRUE;
+
+  call = g_new0 (Call, 1);
+  call->portal = g_object_ref (session->parent_session->portal);
+  call->task = g_task_new (session, NULL, zones_refetched, NULL);
+  call->session = g_object_ref (session);
+
+  get_zones (call);
+}
+
 static void
 zones_changed (GDBusConnection *bus,
                const char      *sender_name,
@@ -374,24 +426,21 @@ zones_changed (GDBusConnection *bus,
                gpointer         data)
 {
   XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (data);
-  XdpPortal *portal = session->parent_session->portal;
   g_autoptr(GVariant) options = NULL;
-  const char *handle = NULL;
-  Call *call;
-
-  g_variant_get(parameters, "(o@a{sv})", &handle, &options);
 
-  if (!handle_matches_session (session, handle))
-    return;
+  g_variant_get_child (parameters, 1, "@a{sv}", &options);
 
   /* Zones have changed, but let's fetch the new zones before we notify the
-   * caller so they're already available by the time they get notified */
-  call = g_new0 (Call, 1);
-  call->portal = g_object_ref (portal);
-  call->task = g_task_new (portal, NULL, zones_changed_emit_signal, session);
-  call->session = g_object_ref (session);
+   * caller so they're already available by the time they get notified.
+   * Bursts of signals share a single GetZones in flight. */
+  if (session->zones_fetching)
+    {
+      session->zones_dirty = TRUE;
+      return;
+    }
 
-  get_zones (call);
+  session->zones_invalidated_set = session->zone_set;
+  refetch_zones (session);
 }
 
 static void
@@ -406,17 +455,13 @@ activated (GDBusConnection *bus,
   XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (data);
   g_autoptr(GVariant) options = NULL;
   guint32 activation_id = 0;
-  const char *handle = NULL;
 
-  g_variant_get (parameters, "(o@a{sv})", &handle, &options);
+  g_variant_get_child (parameters, 1, "@a{sv}", &options);
 
   /* FIXME: we should remove the activation_id from options, but ... meh? */
   if (!g_variant_lookup (options, "activation_id", "u", &activation_id))
     g_warning ("Portal bug: activation_id missing from Activated signal");
 
-  if (!handle_matches_session (session, handle))
-    return;
-
   g_signal_emit (session, signals[SIGNAL_ACTIVATED], 0, activation_id, options);
 }
 
@@ -432,17 +477,13 @@ deactivated (GDBusConnection *bus,
   XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (data);
   g_autoptr(GVariant) options = NULL;
   guint32 activation_id = 0;
-  const char *handle = NULL;
 
-  g_variant_get(parameters, "(o@a{sv})", &handle, &options);
+  g_variant_get_child (parameters, 1, "@a{sv}", &options);
 
   /* FIXME: we should remove the activation_id from options, but ... meh? */
   if (!g_variant_lookup (options, "activation_id", "u", &activation_id))
     g_warning ("Portal bug: activation_id missing from Deactivated signal");
 
-  if (!handle_matches_session (session, handle))
-    return;
-
   g_signal_emit (session, signals[SIGNAL_DEACTIVATED], 0, activation_id, options);
 }
 
@@ -457,12 +498,8 @@ disabled (GDBusConnection *bus,
 {
   XdpInputCaptureSession *session = XDP_INPUT_CAPTURE_SESSION (data);
   g_autoptr(GVariant) options = NULL;
-  const char *handle = NULL;
-
-  g_variant_get(parameters, "(o@a{sv})", &handle, &options);
 
-  if (!handle_matches_session (session, handle))
-      return;
+  g_variant_get_child (parameters, 1, "@a{sv}", &options);
 
   g_signal_emit (session, signals[SIGNAL_DISABLED], 0, options);
 }
@@ -507,65 +544,52 @@ get_zones_done (GDBusConnection *bus,
       guint32 zone_set;
       XdpInputCaptureSession *session = call->session;
 
-      g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-      call->signal_id = 0;
+      _xdp_portal_unregister_request (call->portal, call->request_path);
+      g_clear_pointer (&call->request_path, g_free);
 
       if (session == NULL)
         {
           session = _xdp_input_capture_session_new (call->portal, call->session_path);
           session->signal_ids[SIGNAL_ZONES_CHANGED] =
-            g_dbus_connection_signal_subscribe (bus,
-                                                PORTAL_BUS_NAME,
-                                                "org.freedesktop.portal.InputCapture",
-                                                "ZonesChanged",
-                                                PORTAL_OBJECT_PATH,
-                                                NULL,
-                                                G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                zones_changed,
-                                                session,
-                                                NULL);
+            _xdp_portal_subscribe_session_signal (call->portal,
+                                                  "org.freedesktop.portal.InputCapture",
+                                                  "ZonesChanged",
+                                                  call->session_path,
+                                                  zones_changed,
+                                                  session);
 
           session->signal_ids[SIGNAL_ACTIVATED] =
-            g_dbus_connection_signal_subscribe (bus,
-                                                PORTAL_BUS_NAME,
-                                                "org.freedesktop.portal.InputCapture",
-                                                "Activated",
-                                                PORTAL_OBJECT_PATH,
-                                                NULL,
-                                                G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                activated,
-                                                session,
-                                                NULL);
+            _xdp_portal_subscribe_session_signal (call->portal,
+                                                  "org.freedesktop.portal.InputCapture",
+                                                  "Activated",
+                                                  call->session_path,
+                                                  activated,
+                                                  session);
 
           session->signal_ids[SIGNAL_DEACTIVATED] =
-            g_dbus_connection_signal_subscribe (bus,
-                                                PORTAL_BUS_NAME,
-                                                "org.freedesktop.portal.InputCapture",
-                                                "Deactivated",
-                                                PORTAL_OBJECT_PATH,
-                                                NULL,
-                                                G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                deactivated,
-                                                session,
-                                                NULL);
+            _xdp_portal_subscribe_session_signal (call->portal,
+                                                  "org.freedesktop.portal.InputCapture",
+                                                  "Deactivated",
+                                                  call->session_path,
+                                                  deactivated,
+                                                  session);
 
           session->signal_ids[SIGNAL_DISABLED] =
-            g_dbus_connection_signal_subscribe (bus,
-                                                PORTAL_BUS_NAME,
-                                                "org.freedesktop.portal.InputCapture",
-                                                "Disabled",
-                                                PORTAL_OBJECT_PATH,
-                                                NULL,
-                                                G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                disabled,
-                                                session,
-                                                NULL);
+            _xdp_portal_subscribe_session_signal (call->portal,
+                                                  "org.freedesktop.portal.InputCapture",
+                                                  "Disabled",
+                                                  call->session_path,
+                                                  disabled,
+                                                  session);
         }
 
       if (g_variant_lookup (ret, "zone_set", "u", &zone_set) &&
           g_variant_lookup (ret, "zones", "@a(uuii)", &zones))
         {
           set_zones (session, zones, zone_set);
+          /* A new session is handed over, a refetched one stays ours too */
+          if (call->session)
+            g_object_ref (session);
           g_task_return_pointer (call->task, session, g_object_unref);
         }
       else
@@ -580,8 +604,7 @@ get_zones_done (GDBusConnection *bus,
   else if (response == 2)
     g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "InputCapture GetZones() failed");
 
-  if (response != 0)
-    call_free (call);
+  call_free (call);
 }
 
 static void
@@ -594,8 +617,8 @@ get_zones (Call *call)
    * ZoneChanged signal when we do have a session */
   session_id = call->session ? call->session->parent_session->id : call->session_path;
 
-  prep_call (call, get_zones_done, &options, NULL);
-  g_dbus_connection_call (call->portal->bus,
+  prep_call (call, get_zones_done, &options);
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.InputCapture",
@@ -632,8 +655,8 @@ session_created (GDBusConnection *bus,
 
   if (response == 0)
     {
-      g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-      call->signal_id = 0;
+      _xdp_portal_unregister_request (call->portal, call->request_path);
+      g_clear_pointer (&call->request_path, g_free);
 
       if (!g_variant_lookup (ret, "session_handle", "o", &call->session_path))
         {
@@ -658,7 +681,7 @@ call_cancelled_cb (GCancellable *cancellable,
 {
   Call *call = data;
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -697,13 +720,13 @@ create_session (Call *call)
   if (cancellable)
     call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (call_cancelled_cb), call);
 
-  session_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
+  session_token = _xdp_portal_new_token (call->portal);
 
-  prep_call (call, session_created, &options, NULL);
+  prep_call (call, session_created, &options);
   g_variant_builder_add (&options, "{sv}", "session_handle_token", g_variant_new_string (session_token));
   g_variant_builder_add (&options, "{sv}", "capabilities", g_variant_new_uint32 (call->capabilities));
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.InputCapture",
@@ -821,9 +844,101 @@ xdp_input_capture_session_get_zones (XdpInputCaptureSession *session)
 {
   g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), NULL);
 
+  /* Zone objects are only made for callers that want them */
+  if (session->zones == NULL && session->zone_rects != NULL)
+    {
+      guint i;
+
+      for (i = session->zone_rects->len; i > 0; i--)
+        {
+          const XdpInputCaptureZoneRect *rect = &g_array_index (session->zone_rects, XdpInputCaptureZoneRect, i - 1);
+          XdpInputCaptureZone *z;
+
+          z = g_object_new (XDP_TYPE_INPUT_CAPTURE_ZONE,
+                            "width", rect->width,
+                            "height", rect->height,
+                            "x", rect->x,
+                            "y", rect->y,
+                            "zone-set", session->zone_set,
+                            "is-valid", TRUE,
+                            NULL);
+          session->zones = g_list_prepend (session->zones, z);
+        }
+    }
+
   return session->zones;
 }
 
+/**
+ * xdp_input_capture_session_get_zone_rects:
+ * @session: a [class@InputCaptureSession]
+ * @n_zones: (out): return location for the number of zones
+ *
+ * Obtains the geometry of the current zones, in the same order as
+ * [method@InputCaptureSession.get_zones], without making an object for
+ * each of them.
+ *
+ * The returned array is valid until the zones are invalidated by the
+ * [signal@InputCaptureSession::zones-changed] signal.
+ *
+ * Returns: (array length=n_zones) (transfer none) (nullable): the zones,
+ *   or `NULL` if there are none
+ *
+ * Since: 0.9
+ */
+const XdpInputCaptureZoneRect *
+xdp_input_capture_session_get_zone_rects (XdpInputCaptureSession *session,
+                                          gsize                  *n_zones)
+{
+  g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), NULL);
+  g_return_val_if_fail (n_zones != NULL, NULL);
+
+  if (session->zone_rects == NULL || session->zone_rects->len == 0)
+    {
+      *n_zones = 0;
+      return NULL;
+    }
+
+  *n_zones = session->zone_rects->len;
+  return (const XdpInputCaptureZoneRect *) session->zone_rects->data;
+}
+
+/**
+ * xdp_input_capture_session_find_zone:
+ * @session: a [class@InputCaptureSession]
+ * @x: the x coordinate in logical pixels
+ * @y: the y coordinate in logical pixels
+ *
+ * Finds the zone that contains the point (@x, @y), such as the monitor
+ * a pointer position is on. A zone contains its top and left edges, but
+ * not its bottom and right ones. If zones overlap, any of those that
+ * contain the point may be returned.
+ *
+ * The lookup takes logarithmic time in the number of zones.
+ *
+ * Returns: the index of the zone in
+ *   [method@InputCaptureSession.get_zone_rects], or -1 if no zone
+ *   contains the point
+ *
+ * Since: 0.9
+ */
+int
+xdp_input_capture_session_find_zone (XdpInputCaptureSession *session,
+                                     double                  x,
+                                     double                  y)
+{
+  g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), -1);
+
+  if (session->zone_rects == NULL)
+    return -1;
+
+  if (session->zone_index == NULL)
+    session->zone_index = _xdp_zone_index_new ((const XdpInputCaptureZoneRect *) session->zone_rects->data,
+                                               session->zone_rects->len);
+
+  return _xdp_zone_index_lookup (session->zone_index, x, y);
+}
+
 /**
  * xdp_input_capture_session_connect_to_eis:
  * @session: a [class@InputCaptureSession]
@@ -858,7 +973,7 @@ xdp_input_capture_session_connect_to_eis (XdpInputCaptureSession  *session,
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
 
   portal = parent_session->portal;
-  ret = g_dbus_connection_call_with_unix_fd_list_sync (portal->bus,
+  ret = g_dbus_connection_call_with_unix_fd_list_sync (_xdp_portal_get_bus (portal),
                                                        PORTAL_BUS_NAME,
                                                        PORTAL_OBJECT_PATH,
                                                        "org.freedesktop.portal.InputCapture",
@@ -882,6 +997,195 @@ xdp_input_capture_session_connect_to_eis (XdpInputCaptureSession  *session,
   return g_unix_fd_list_get (fd_list, fd_out, NULL);
 }
 
+/**
+ * xdp_input_capture_session_connect_to_eis_async:
+ * @session: a [class@InputCaptureSession]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Connects this session to an EIS implementation, like
+ * [method@InputCaptureSession.connect_to_eis], but without blocking on
+ * the portal.
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_capture_session_connect_to_eis_async (XdpInputCaptureSession *session,
+                                                GCancellable           *cancellable,
+                                                GAsyncReadyCallback     callback,
+                                                gpointer                data)
+{
+  g_autoptr(GTask) task = NULL;
+  GVariantBuilder options;
+
+  g_return_if_fail (XDP_IS_INPUT_CAPTURE_SESSION (session));
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_input_capture_session_connect_to_eis_async);
+
+  if (!_xdp_input_capture_session_is_valid (session))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not an InputCapture session");
+      return;
+    }
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  _xdp_portal_call_fd (session->parent_session->portal,
+                       PORTAL_OBJECT_PATH,
+                       "org.freedesktop.portal.InputCapture",
+                       "ConnectToEIS",
+                       g_variant_new ("(oa{sv})", session->parent_session->id, &options),
+                       task);
+}
+
+/**
+ * xdp_input_capture_session_connect_to_eis_finish:
+ * @session: a [class@InputCaptureSession]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes connecting to EIS.
+ *
+ * Returns: a socket to the EIS implementation for this input capture
+ *   session, or -1 on error
+ *
+ * Since: 0.9
+ */
+int
+xdp_input_capture_session_connect_to_eis_finish (XdpInputCaptureSession  *session,
+                                                 GAsyncResult            *result,
+                                                 GError                 **error)
+{
+  g_return_val_if_fail (XDP_IS_INPUT_CAPTURE_SESSION (session), -1);
+  g_return_val_if_fail (g_task_is_valid (result, session), -1);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_input_capture_session_connect_to_eis_async, -1);
+
+  return _xdp_portal_call_fd_finish (result, error);
+}
+
+static void
+captured_events_received (guint                   activation_id,
+                          const XdpCapturedEvent *events,
+                          gsize                   n_events,
+                          gpointer                data)
+{
+  XdpInputCaptureSession *session = data;
+
+  session->captured_func (session, activation_id, events, n_events, session->captured_data);
+}
+
+/**
+ * xdp_input_capture_session_start_receiving:
+ * @session: a [class@InputCaptureSession]
+ * @fd: a socket to the EIS implementation, or -1
+ * @context: (nullable): the #GMainContext to receive events on, or `NULL`
+ *   for the thread-default main context
+ * @func: (scope notified) (closure data): the function to call with
+ *   captured events
+ * @data: data to pass to @func
+ * @destroy: (destroy data): function to free @data
+ * @error: return location for a #GError pointer
+ *
+ * Receives the input captured by @session over EIS with libei, without
+ * the caller having to drive libei itself.
+ *
+ * Events are read when the EIS socket becomes readable in @context, and
+ * all events read at once are passed to @func in a single call. A call
+ * never mixes events from different activations; @activation_id matches
+ * the one of the [signal@InputCaptureSession::activated] signal.
+ *
+ * If @fd is -1, [method@InputCaptureSession.connect_to_eis] is called to
+ * get one. Otherwise the session takes ownership of @fd.
+ *
+ * Returns: `TRUE` if the session is now receiving events. Fails with
+ *   %G_IO_ERROR_NOT_SUPPORTED if libportal was built without libei.
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_input_capture_session_start_receiving (XdpInputCaptureSession  *session,
+                                           int                      fd,
+                                           GMainContext            *context,
+                                           XdpCapturedEventsFunc    func,
+                                           gpointer                 data,
+                                           GDestroyNotify           destroy,
+                                           GError                 **error)
+{
+  g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  if (session->eis_receiver)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+                   "The session is already receiving events");
+      if (fd >= 0)
+        close (fd);
+      return FALSE;
+    }
+
+#ifndef HAVE_LIBEI
+  /* Don't ask the portal for a connection we can't use */
+  if (fd < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "libportal was built without libei support");
+      return FALSE;
+    }
+#endif
+
+  if (fd < 0)
+    {
+      fd = xdp_input_capture_session_connect_to_eis (session, error);
+      if (fd < 0)
+        return FALSE;
+    }
+
+  if (context == NULL)
+    context = g_main_context_get_thread_default ();
+
+  session->eis_receiver = _xdp_eis_receiver_new (fd, context,
+                                                 captured_events_received,
+                                                 session, error);
+  if (!session->eis_receiver)
+    return FALSE;
+
+  session->captured_func = func;
+  session->captured_data = data;
+  session->captured_destroy = destroy;
+
+  return TRUE;
+}
+
+/**
+ * xdp_input_capture_session_stop_receiving:
+ * @session: a [class@InputCaptureSession]
+ *
+ * Stops receiving events, started with
+ * [method@InputCaptureSession.start_receiving], and closes the EIS
+ * connection. This may be called from the events function.
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_capture_session_stop_receiving (XdpInputCaptureSession *session)
+{
+  GDestroyNotify destroy;
+
+  g_return_if_fail (XDP_IS_INPUT_CAPTURE_SESSION (session));
+
+  if (!session->eis_receiver)
+    return;
+
+  g_clear_pointer (&session->eis_receiver, _xdp_eis_receiver_free);
+
+  destroy = g_steal_pointer (&session->captured_destroy);
+  session->captured_func = NULL;
+  if (destroy)
+    destroy (g_steal_pointer (&session->captured_data));
+  session->captured_data = NULL;
+}
+
 static void
 free_barrier_list (GList *list)
 {
@@ -935,6 +1239,7 @@ set_pointer_barriers_done (GDBusConnection *bus,
   free_barrier_list (call->barriers);
   call->barriers = NULL;
   g_task_return_pointer (call->task, failed_list,  (GDestroyNotify)free_barrier_list);
+  call_free (call);
 }
 
 static void
@@ -961,14 +1266,14 @@ set_pointer_barriers (Call *call)
   GVariantBuilder barriers;
   g_autoptr(GVariantType) vtype;
 
-  prep_call (call, set_pointer_barriers_done, &options, NULL);
+  prep_call (call, set_pointer_barriers_done, &options);
 
   vtype = g_variant_type_new ("aa{sv}");
 
   g_variant_builder_init (&barriers, vtype);
   g_list_foreach (call->barriers, convert_barrier, &barriers);
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.InputCapture",
@@ -1027,6 +1332,11 @@ xdp_input_capture_session_set_pointer_barriers (XdpInputCaptureSession         *
    * returned barriers during _finish*/
   g_list_foreach (barriers, gobject_ref_wrapper, NULL);
 
+  /* These barriers replace any set from a struct array */
+  g_clear_pointer (&session->barriers, g_array_unref);
+  g_clear_pointer (&session->pending_barriers, g_array_unref);
+  session->barrier_serial++;
+
   call = g_new0 (Call, 1);
   call->portal = g_object_ref (portal);
   call->session = g_object_ref (session);
@@ -1059,6 +1369,446 @@ xdp_input_capture_session_set_pointer_barriers_finish (XdpInputCaptureSession *s
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+static gboolean
+barrier_fits_zones (XdpInputCaptureSession            *session,
+                    const XdpInputCaptureBarrierSpec  *barrier)
+{
+  gboolean horizontal = barrier->y1 == barrier->y2;
+  gboolean vertical = barrier->x1 == barrier->x2;
+  gint64 lo, hi;
+
+  if (session->zone_rects == NULL || horizontal == vertical)
+    return FALSE;
+
+  lo = horizontal ? MIN (barrier->x1, barrier->x2) : MIN (barrier->y1, barrier->y2);
+  hi = horizontal ? MAX (barrier->x1, barrier->x2) : MAX (barrier->y1, barrier->y2);
+
+  for (guint i = 0; i < session->zone_rects->len; i++)
+    {
+      const XdpInputCaptureZoneRect *rect = &g_array_index (session->zone_rects, XdpInputCaptureZoneRect, i);
+      gint64 left = rect->x;
+      gint64 right = (gint64) rect->x + rect->width;
+      gint64 top = rect->y;
+      gint64 bottom = (gint64) rect->y + rect->height;
+
+      if (horizontal &&
+          (barrier->y1 == top || barrier->y1 == bottom) &&
+          lo >= left && hi <= right)
+        return TRUE;
+
+      if (vertical &&
+          (barrier->x1 == left || barrier->x1 == right) &&
+          lo >= top && hi <= bottom)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+set_barriers_done (GDBusConnection *bus,
+                   const char *sender_name,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *signal_name,
+                   GVariant *parameters,
+                   gpointer data)
+{
+  Call *call = data;
+  XdpInputCaptureSession *session = call->session;
+  gboolean latest = call->barrier_serial == session->barrier_serial;
+  guint32 response;
+  g_autoptr(GVariant) ret = NULL;
+
+  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
+
+  if (response != 0 && call->cancelled_id)
+    {
+      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
+      call->cancelled_id = 0;
+    }
+
+  if (response == 0)
+    {
+      g_autoptr(GHashTable) rejected = g_hash_table_new (NULL, NULL);
+      g_autoptr(GVariant) failed = NULL;
+      GArray *accepted = NULL;
+
+      if (g_variant_lookup (ret, "failed_barriers", "@au", &failed))
+        {
+          const guint32 *failed_barriers;
+          gsize n_elements;
+
+          failed_barriers = g_variant_get_fixed_array (failed, &n_elements, sizeof (guint32));
+          for (gsize i = 0; i < n_elements; i++)
+            g_hash_table_add (rejected, GUINT_TO_POINTER (failed_barriers[i]));
+        }
+
+      /* Replies to superseded calls don't touch the accepted set */
+      if (latest)
+        accepted = g_array_sized_new (FALSE, FALSE, sizeof (XdpInputCaptureBarrierSpec),
+                                      call->barrier_specs->len);
+
+      for (guint i = 0; i < call->barrier_specs->len; i++)
+        {
+          const XdpInputCaptureBarrierSpec *b = &g_array_index (call->barrier_specs, XdpInputCaptureBarrierSpec, i);
+
+          if (g_hash_table_contains (rejected, GUINT_TO_POINTER (b->id)))
+            g_array_append_val (call->failed_ids, b->id);
+          else if (accepted)
+            g_array_append_val (accepted, *b);
+        }
+
+      if (accepted)
+        {
+          g_clear_pointer (&session->barriers, g_array_unref);
+          session->barriers = accepted;
+        }
+
+      g_task_return_pointer (call->task, g_steal_pointer (&call->failed_ids), (GDestroyNotify)g_array_unref);
+    }
+  else if (response == 1)
+    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "InputCapture SetPointerBarriers() canceled");
+  else
+    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "InputCapture SetPointerBarriers() failed");
+
+  call_free (call);
+}
+
+static void
+set_barriers (Call *call)
+{
+  GVariantBuilder options;
+  GVariantBuilder barriers;
+
+  prep_call (call, set_barriers_done, &options);
+
+  g_variant_builder_init (&barriers, G_VARIANT_TYPE ("aa{sv}"));
+  for (guint i = 0; i < call->barrier_specs->len; i++)
+    {
+      const XdpInputCaptureBarrierSpec *b = &g_array_index (call->barrier_specs, XdpInputCaptureBarrierSpec, i);
+      GVariantBuilder dict;
+
+      g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+      g_variant_builder_add (&dict, "{sv}", "barrier_id", g_variant_new_uint32 (b->id));
+      g_variant_builder_add (&dict, "{sv}", "position",
+                             g_variant_new ("(iiii)", b->x1, b->y1, b->x2, b->y2));
+      g_variant_builder_add (&barriers, "a{sv}", &dict);
+    }
+
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.InputCapture",
+                          "SetPointerBarriers",
+                          g_variant_new ("(oa{sv}aa{sv}u)",
+                                         call->session->parent_session->id,
+                                         &options,
+                                         &barriers,
+                                         call->session->zone_set),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (call->task),
+                          call_returned,
+                          call);
+}
+
+/* Takes ownership of @barriers and @failed_ids. @barriers becomes the base
+ * for later add/remove calls until the reply arrives.
+ */
+static void
+send_barriers (XdpInputCaptureSession *session,
+               GArray                 *barriers,
+               GArray                 *failed_ids,
+               GCancellable           *cancellable,
+               GAsyncReadyCallback     callback,
+               gpointer                data)
+{
+  Call *call;
+
+  call = g_new0 (Call, 1);
+  call->portal = g_object_ref (session->parent_session->portal);
+  call->session = g_object_ref (session);
+  call->task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (call->task, xdp_input_capture_session_set_barriers);
+  call->barrier_specs = barriers;
+  call->failed_ids = failed_ids;
+  call->barrier_serial = ++session->barrier_serial;
+
+  g_clear_pointer (&session->pending_barriers, g_array_unref);
+  session->pending_barriers = g_array_ref (barriers);
+
+  set_barriers (call);
+}
+
+/* The set that add/remove calls build on: whatever was sent last, or the
+ * accepted set if nothing is in flight. */
+static GArray *
+current_barriers (XdpInputCaptureSession *session)
+{
+  GArray *base = session->pending_barriers ? session->pending_barriers : session->barriers;
+  GArray *copy;
+
+  copy = g_array_sized_new (FALSE, FALSE, sizeof (XdpInputCaptureBarrierSpec), base ? base->len + 1 : 1);
+  if (base)
+    g_array_append_vals (copy, base->data, base->len);
+
+  return copy;
+}
+
+static void
+return_barriers_immediately (XdpInputCaptureSession *session,
+                             GArray                 *failed_ids,
+                             GCancellable           *cancellable,
+                             GAsyncReadyCallback     callback,
+                             gpointer                data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_input_capture_session_set_barriers);
+  g_task_return_pointer (task, failed_ids, (GDestroyNotify)g_array_unref);
+}
+
+/**
+ * xdp_input_capture_session_set_barriers:
+ * @session: a [class@InputCaptureSession]
+ * @barriers: (array length=n_barriers): the pointer barriers to apply
+ * @n_barriers: the number of elements in @barriers
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Replaces the pointer barriers of this session with @barriers, a
+ * lighter-weight alternative to
+ * [method@InputCaptureSession.set_pointer_barriers] for large sets.
+ *
+ * Every barrier is checked against the current zones before the request
+ * is sent: it must be horizontal or vertical and lie on a zone edge.
+ * Barriers that don't are not sent and are reported as failed right away.
+ * The portal may still reject barriers that pass this check.
+ *
+ * When the request is done, @callback will be called. You can then call
+ * [method@InputCaptureSession.set_barriers_finish] to get the ids of the
+ * barriers that failed to apply. The barriers that did apply are
+ * remembered, see [method@InputCaptureSession.get_barriers], and can be
+ * changed one at a time with [method@InputCaptureSession.add_barrier] and
+ * [method@InputCaptureSession.remove_barrier].
+ *
+ * The remembered set is cleared when the zones change, since the portal
+ * drops all barriers at that point.
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_capture_session_set_barriers (XdpInputCaptureSession            *session,
+                                        const XdpInputCaptureBarrierSpec  *barriers,
+                                        gsize                              n_barriers,
+                                        GCancellable                      *cancellable,
+                                        GAsyncReadyCallback                callback,
+                                        gpointer                           data)
+{
+  GArray *valid;
+  GArray *failed_ids;
+
+  g_return_if_fail (_xdp_input_capture_session_is_valid (session));
+  g_return_if_fail (barriers != NULL || n_barriers == 0);
+
+  valid = g_array_sized_new (FALSE, FALSE, sizeof (XdpInputCaptureBarrierSpec), n_barriers);
+  failed_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (gsize i = 0; i < n_barriers; i++)
+    {
+      if (barrier_fits_zones (session, &barriers[i]))
+        g_array_append_val (valid, barriers[i]);
+      else
+        g_array_append_val (failed_ids, barriers[i].id);
+    }
+
+  send_barriers (session, valid, failed_ids, cancellable, callback, data);
+}
+
+/**
+ * xdp_input_capture_session_add_barrier:
+ * @session: a [class@InputCaptureSession]
+ * @barrier: the pointer barrier to add
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Adds @barrier to the barriers remembered from previous calls to
+ * [method@InputCaptureSession.set_barriers], replacing any barrier with
+ * the same id. Only @barrier is checked against the zones; if it does not
+ * fit, no request is sent and its id is reported as failed.
+ *
+ * Finish the request with [method@InputCaptureSession.set_barriers_finish].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_capture_session_add_barrier (XdpInputCaptureSession            *session,
+                                       const XdpInputCaptureBarrierSpec  *barrier,
+                                       GCancellable                      *cancellable,
+                                       GAsyncReadyCallback                callback,
+                                       gpointer                           data)
+{
+  GArray *failed_ids;
+  GArray *barriers;
+  guint i;
+
+  g_return_if_fail (_xdp_input_capture_session_is_valid (session));
+  g_return_if_fail (barrier != NULL);
+
+  failed_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (!barrier_fits_zones (session, barrier))
+    {
+      g_array_append_val (failed_ids, barrier->id);
+      return_barriers_immediately (session, failed_ids, cancellable, callback, data);
+      return;
+    }
+
+  barriers = current_barriers (session);
+  for (i = 0; i < barriers->len; i++)
+    {
+      if (g_array_index (barriers, XdpInputCaptureBarrierSpec, i).id == barrier->id)
+        break;
+    }
+
+  if (i < barriers->len)
+    g_array_index (barriers, XdpInputCaptureBarrierSpec, i) = *barrier;
+  else
+    g_array_append_val (barriers, *barrier);
+
+  send_barriers (session, barriers, failed_ids, cancellable, callback, data);
+}
+
+/**
+ * xdp_input_capture_session_remove_barrier:
+ * @session: a [class@InputCaptureSession]
+ * @id: the id of the pointer barrier to remove
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Removes the barrier with @id from the barriers remembered from previous
+ * calls to [method@InputCaptureSession.set_barriers]. If there is no such
+ * barrier, no request is sent.
+ *
+ * Finish the request with [method@InputCaptureSession.set_barriers_finish].
+ *
+ * Since: 0.9
+ */
+void
+xdp_input_capture_session_remove_barrier (XdpInputCaptureSession *session,
+                                          guint                   id,
+                                          GCancellable           *cancellable,
+                                          GAsyncReadyCallback     callback,
+                                          gpointer                data)
+{
+  GArray *failed_ids;
+  GArray *barriers;
+  guint i;
+
+  g_return_if_fail (_xdp_input_capture_session_is_valid (session));
+
+  failed_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  barriers = current_barriers (session);
+
+  for (i = 0; i < barriers->len; i++)
+    {
+      if (g_array_index (barriers, XdpInputCaptureBarrierSpec, i).id == id)
+        break;
+    }
+
+  if (i == barriers->len)
+    {
+      g_array_unref (barriers);
+      return_barriers_immediately (session, failed_ids, cancellable, callback, data);
+      return;
+    }
+
+  g_array_remove_index (barriers, i);
+  send_barriers (session, barriers, failed_ids, cancellable, callback, data);
+}
+
+/**
+ * xdp_input_capture_session_set_barriers_finish:
+ * @session: a [class@InputCaptureSession]
+ * @result: a [iface@Gio.AsyncResult]
+ * @failed_ids: (out) (optional) (array length=n_failed) (transfer full): return
+ *   location for the ids of the barriers that failed to apply
+ * @n_failed: (out) (optional): return location for the number of failed ids
+ * @error: return location for an error
+ *
+ * Finishes a request started with [method@InputCaptureSession.set_barriers],
+ * [method@InputCaptureSession.add_barrier] or
+ * [method@InputCaptureSession.remove_barrier].
+ *
+ * Returns: %TRUE if the request completed, even if some barriers failed
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_input_capture_session_set_barriers_finish (XdpInputCaptureSession  *session,
+                                               GAsyncResult            *result,
+                                               guint                  **failed_ids,
+                                               gsize                   *n_failed,
+                                               GError                 **error)
+{
+  GArray *failed;
+
+  g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, session), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_input_capture_session_set_barriers, FALSE);
+
+  failed = g_task_propagate_pointer (G_TASK (result), error);
+  if (failed == NULL)
+    return FALSE;
+
+  if (n_failed)
+    *n_failed = failed->len;
+  if (failed_ids)
+    *failed_ids = (guint *) g_array_free (failed, FALSE);
+  else
+    g_array_unref (failed);
+
+  return TRUE;
+}
+
+/**
+ * xdp_input_capture_session_get_barriers:
+ * @session: a [class@InputCaptureSession]
+ * @n_barriers: (out): return location for the number of barriers
+ *
+ * Returns the pointer barriers the portal accepted in the most recent
+ * [method@InputCaptureSession.set_barriers],
+ * [method@InputCaptureSession.add_barrier] or
+ * [method@InputCaptureSession.remove_barrier] request.
+ *
+ * Returns: (array length=n_barriers) (transfer none) (nullable): the
+ *   accepted barriers, owned by @session
+ *
+ * Since: 0.9
+ */
+const XdpInputCaptureBarrierSpec *
+xdp_input_capture_session_get_barriers (XdpInputCaptureSession *session,
+                                        gsize                  *n_barriers)
+{
+  g_return_val_if_fail (_xdp_input_capture_session_is_valid (session), NULL);
+  g_return_val_if_fail (n_barriers != NULL, NULL);
+
+  if (session->barriers == NULL || session->barriers->len == 0)
+    {
+      *n_barriers = 0;
+      return NULL;
+    }
+
+  *n_barriers = session->barriers->len;
+  return (const XdpInputCaptureBarrierSpec *) session->barriers->data;
+}
+
 /**
  * xdp_input_capture_session_enable:
  * @session: a [class@InputCaptureSession]
@@ -1078,7 +1828,7 @@ xdp_input_capture_session_enable (XdpInputCaptureSession *session)
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
 
-  g_dbus_connection_call  (portal->bus,
+  g_dbus_connection_call  (_xdp_portal_get_bus (portal),
                            PORTAL_BUS_NAME,
                            PORTAL_OBJECT_PATH,
                            "org.freedesktop.portal.InputCapture",
@@ -1111,7 +1861,7 @@ xdp_input_capture_session_disable (XdpInputCaptureSession *session)
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
 
   portal = session->parent_session->portal;
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.InputCapture",
@@ -1151,7 +1901,7 @@ release_session (XdpInputCaptureSession   *session,
     }
 
   portal = session->parent_session->portal;
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.InputCapture",
@@ -68,6 +68,16 @@ XdpSession  *xdp_input_capture_session_get_session (XdpInputCaptureSession *sess
 XDP_PUBLIC
 GList *     xdp_input_capture_session_get_zones (XdpInputCaptureSession *session);
 
+XDP_PUBLIC
+const XdpInputCaptureZoneRect *
+            xdp_input_capture_session_get_zone_rects (XdpInputCaptureSession *session,
+                                                      gsize                  *n_zones);
+
+XDP_PUBLIC
+int         xdp_input_capture_session_find_zone (XdpInputCaptureSession *session,
+                                                 double                  x,
+                                                 double                  y);
+
 XDP_PUBLIC
 void        xdp_input_capture_session_set_pointer_barriers (XdpInputCaptureSession         *session,
                                                             GList                          *barriers,
@@ -80,6 +90,40 @@ GList *     xdp_input_capture_session_set_pointer_barriers_finish (XdpInputCaptu
                                                                    GAsyncResult            *result,
                                                                    GError                 **error);
 
+XDP_PUBLIC
+void        xdp_input_capture_session_set_barriers (XdpInputCaptureSession            *session,
+                                                    const XdpInputCaptureBarrierSpec  *barriers,
+                                                    gsize                              n_barriers,
+                                                    GCancellable                      *cancellable,
+                                                    GAsyncReadyCallback                callback,
+                                                    gpointer                           data);
+
+XDP_PUBLIC
+void        xdp_input_capture_session_add_barrier (XdpInputCaptureSession            *session,
+                                                   const XdpInputCaptureBarrierSpec  *barrier,
+                                                   GCancellable                      *cancellable,
+                                                   GAsyncReadyCallback                callback,
+                                                   gpointer                           data);
+
+XDP_PUBLIC
+void        xdp_input_capture_session_remove_barrier (XdpInputCaptureSession *session,
+                                                      guint                   id,
+                                                      GCancellable           *cancellable,
+                                                      GAsyncReadyCallback     callback,
+                                                      gpointer                data);
+
+XDP_PUBLIC
+gboolean    xdp_input_capture_session_set_barriers_finish (XdpInputCaptureSession  *session,
+                                                           GAsyncResult            *result,
+                                                           guint                  **failed_ids,
+                                                           gsize                   *n_failed,
+                                                           GError                 **error);
+
+XDP_PUBLIC
+const XdpInputCaptureBarrierSpec *
+            xdp_input_capture_session_get_barriers (XdpInputCaptureSession *session,
+                                                    gsize                  *n_barriers);
+
 XDP_PUBLIC
 void        xdp_input_capture_session_enable (XdpInputCaptureSession *session);
 
@@ -100,4 +144,104 @@ XDP_PUBLIC
 int        xdp_input_capture_session_connect_to_eis (XdpInputCaptureSession  *session,
                                                      GError                 **error);
 
+XDP_PUBLIC
+void       xdp_input_capture_session_connect_to_eis_async  (XdpInputCaptureSession  *session,
+                                                            GCancellable            *cancellable,
+                                                            GAsyncReadyCallback      callback,
+                                                            gpointer                 data);
+
+XDP_PUBLIC
+int        xdp_input_capture_session_connect_to_eis_finish (XdpInputCaptureSession  *session,
+                                                            GAsyncResult            *result,
+                                                            GError                 **error);
+
+/**
+ * XdpCapturedEventType:
+ * @XDP_CAPTURED_EVENT_FRAME: the end of a group of events that happened
+ *   at the same time
+ * @XDP_CAPTURED_EVENT_POINTER_MOTION: relative pointer motion by `x`, `y`
+ * @XDP_CAPTURED_EVENT_POINTER_MOTION_ABSOLUTE: the pointer moved to `x`, `y`
+ * @XDP_CAPTURED_EVENT_BUTTON: button `code` was pressed or released
+ * @XDP_CAPTURED_EVENT_SCROLL: smooth scrolling by `x`, `y`
+ * @XDP_CAPTURED_EVENT_SCROLL_DISCRETE: discrete scrolling by `x`, `y`, in
+ *   fractions of 120 per wheel step
+ * @XDP_CAPTURED_EVENT_SCROLL_STOP: scrolling on the axes where `x` or `y`
+ *   is not 0 stopped
+ * @XDP_CAPTURED_EVENT_KEYBOARD_KEY: key `code` was pressed or released
+ * @XDP_CAPTURED_EVENT_TOUCH_DOWN: touch point `code` appeared at `x`, `y`
+ * @XDP_CAPTURED_EVENT_TOUCH_MOTION: touch point `code` moved to `x`, `y`
+ * @XDP_CAPTURED_EVENT_TOUCH_UP: touch point `code` went away
+ *
+ * The type of a [struct@CapturedEvent].
+ *
+ * Since: 0.9
+ */
+typedef enum {
+  XDP_CAPTURED_EVENT_FRAME,
+  XDP_CAPTURED_EVENT_POINTER_MOTION,
+  XDP_CAPTURED_EVENT_POINTER_MOTION_ABSOLUTE,
+  XDP_CAPTURED_EVENT_BUTTON,
+  XDP_CAPTURED_EVENT_SCROLL,
+  XDP_CAPTURED_EVENT_SCROLL_DISCRETE,
+  XDP_CAPTURED_EVENT_SCROLL_STOP,
+  XDP_CAPTURED_EVENT_KEYBOARD_KEY,
+  XDP_CAPTURED_EVENT_TOUCH_DOWN,
+  XDP_CAPTURED_EVENT_TOUCH_MOTION,
+  XDP_CAPTURED_EVENT_TOUCH_UP,
+} XdpCapturedEventType;
+
+/**
+ * XdpCapturedEvent:
+ * @type: the type of event
+ * @pressed: whether the button or key was pressed
+ * @code: the evdev button or key code, or the touch point
+ * @time: the time of the event, in microseconds of `CLOCK_MONOTONIC`
+ * @x: the horizontal component, see [enum@CapturedEventType]
+ * @y: the vertical component, see [enum@CapturedEventType]
+ *
+ * An input event captured through EIS.
+ *
+ * Since: 0.9
+ */
+typedef struct {
+  XdpCapturedEventType type;
+  gboolean pressed;
+  guint32 code;
+  guint64 time;
+  double x;
+  double y;
+} XdpCapturedEvent;
+
+/**
+ * XdpCapturedEventsFunc:
+ * @session: the [class@InputCaptureSession]
+ * @activation_id: the activation the events belong to
+ * @events: (array length=n_events): the captured events, in order
+ * @n_events: the number of events
+ * @data: the data passed to
+ *   [method@InputCaptureSession.start_receiving]
+ *
+ * Receives the events captured while @session was activated with
+ * @activation_id. @events is only valid during the call.
+ *
+ * Since: 0.9
+ */
+typedef void (* XdpCapturedEventsFunc) (XdpInputCaptureSession *session,
+                                        guint                   activation_id,
+                                        const XdpCapturedEvent *events,
+                                        gsize                   n_events,
+                                        gpointer                data);
+
+XDP_PUBLIC
+gboolean   xdp_input_capture_session_start_receiving (XdpInputCaptureSession  *session,
+                                                      int                      fd,
+                                                      GMainContext            *context,
+                                                      XdpCapturedEventsFunc    func,
+                                                      gpointer                 data,
+                                                      GDestroyNotify           destroy,
+                                                      GError                 **error);
+
+XDP_PUBLIC
+void       xdp_input_capture_session_stop_receiving  (XdpInputCaptureSession  *session);
+
 G_END_DECLS
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define XDP_KEYMAP_MAX_MODIFIERS 2
+
+typedef struct _XdpKeymap XdpKeymap;
+
+/* The evdev key codes to press, in order, to type a keysym */
+typedef struct {
+  guint32 modifiers[XDP_KEYMAP_MAX_MODIFIERS];
+  guint n_modifiers;
+  guint32 key;
+} XdpKeyCombo;
+
+guint32     _xdp_keysym_from_unichar  (gunichar      c);
+
+XdpKeymap * _xdp_keymap_get_default   (void);
+
+XdpKeymap * _xdp_keymap_new_from_fd   (int           fd,
+                                       gsize         size);
+
+gboolean    _xdp_keymap_lookup        (XdpKeymap    *keymap,
+                                       guint32       keysym,
+                                       XdpKeyCombo  *combo);
+
+void        _xdp_keymap_free          (XdpKeymap    *keymap);
+
+G_END_DECLS
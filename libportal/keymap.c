@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include "keymap-private.h"
+
+/*
+ * XdpKeymap:
+ *
+ * Maps keysyms to the key codes, and the modifiers to hold, that type
+ * them in an XKB keymap. The whole table is built once per keymap, so
+ * that typing text costs a hash table lookup per character.
+ *
+ * Only the first layout of the keymap is used, and only the levels
+ * reachable with Shift and AltGr.
+ */
+
+/* Keysyms for Latin-1 are the code points themselves; other characters
+ * have Unicode keysyms, see xkb_utf32_to_keysym() */
+guint32
+_xdp_keysym_from_unichar (gunichar c)
+{
+  switch (c)
+    {
+    case '\b':
+      return 0xff08; /* BackSpace */
+    case '\t':
+      return 0xff09; /* Tab */
+    case '\n':
+    case '\r':
+      return 0xff0d; /* Return */
+    case 0x1b:
+      return 0xff1b; /* Escape */
+    case 0x7f:
+      return 0xffff; /* Delete */
+    default:
+      break;
+    }
+
+  if (c < 0x20 || (c >= 0x7f && c < 0xa0) || c > 0x10ffff)
+    return 0;
+
+  if (c < 0x100)
+    return c;
+
+  return 0x01000000 | c;
+}
+
+#ifdef HAVE_XKBCOMMON
+
+#include <string.h>
+#include <sys/mman.h>
+#include <xkbcommon/xkbcommon.h>
+
+/* evdev key codes are offset by 8 in XKB */
+#define EVDEV_OFFSET 8
+
+struct _XdpKeymap {
+  GHashTable *combos; /* keysym → XdpKeyCombo */
+};
+
+static xkb_keycode_t
+find_keycode (struct xkb_keymap *keymap,
+              xkb_keysym_t       keysym)
+{
+  xkb_keycode_t min = xkb_keymap_min_keycode (keymap);
+  xkb_keycode_t max = xkb_keymap_max_keycode (keymap);
+  xkb_keycode_t keycode;
+
+  for (keycode = min; keycode <= max; keycode++)
+    {
+      const xkb_keysym_t *syms;
+
+      if (xkb_keymap_key_get_syms_by_level (keymap, keycode, 0, 0, &syms) == 1 &&
+          syms[0] == keysym)
+        return keycode;
+    }
+
+  return XKB_KEYCODE_INVALID;
+}
+
+static void
+add_combo (XdpKeymap         *self,
+           xkb_keysym_t       keysym,
+           const XdpKeyCombo *combo)
+{
+  gpointer key = GUINT_TO_POINTER (keysym);
+  XdpKeyCombo *copy;
+
+  /* Prefer the combo with the fewest modifiers */
+  if (keysym == XKB_KEY_NoSymbol || g_hash_table_contains (self->combos, key))
+    return;
+
+  copy = g_new (XdpKeyCombo, 1);
+  *copy = *combo;
+  g_hash_table_insert (self->combos, key, copy);
+}
+
+static XdpKeymap *
+keymap_new (struct xkb_keymap *keymap)
+{
+  xkb_keycode_t modifier_keys[XDP_KEYMAP_MAX_MODIFIERS];
+  xkb_keycode_t min = xkb_keymap_min_keycode (keymap);
+  xkb_keycode_t max = xkb_keymap_max_keycode (keymap);
+  XdpKeymap *self;
+  guint mask;
+
+  self = g_new0 (XdpKeymap, 1);
+  self->combos = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  modifier_keys[0] = find_keycode (keymap, XKB_KEY_Shift_L);
+  modifier_keys[1] = find_keycode (keymap, XKB_KEY_ISO_Level3_Shift);
+
+  /* Every combination of the modifiers, fewest first */
+  for (mask = 0; mask < (1 << XDP_KEYMAP_MAX_MODIFIERS); mask++)
+    {
+      struct xkb_state *state;
+      XdpKeyCombo combo = { { 0, }, 0, 0 };
+      xkb_keycode_t keycode;
+      guint i;
+
+      state = xkb_state_new (keymap);
+
+      for (i = 0; i < XDP_KEYMAP_MAX_MODIFIERS; i++)
+        {
+          if ((mask & (1 << i)) == 0)
+            continue;
+          if (modifier_keys[i] == XKB_KEYCODE_INVALID)
+            break;
+
+          xkb_state_update_key (state, modifier_keys[i], XKB_KEY_DOWN);
+          combo.modifiers[combo.n_modifiers++] = modifier_keys[i] - EVDEV_OFFSET;
+        }
+
+      if (i < XDP_KEYMAP_MAX_MODIFIERS)
+        {
+          xkb_state_unref (state);
+          continue;
+        }
+
+      for (keycode = min; keycode <= max; keycode++)
+        {
+          xkb_keysym_t keysym = xkb_state_key_get_one_sym (state, keycode);
+          guint32 c = xkb_keysym_to_utf32 (keysym);
+
+          combo.key = keycode - EVDEV_OFFSET;
+          add_combo (self, keysym, &combo);
+
+          /* Also reachable through the keysym of its character */
+          if (c != 0)
+            add_combo (self, _xdp_keysym_from_unichar (c), &combo);
+        }
+
+      xkb_state_unref (state);
+    }
+
+  return self;
+}
+
+static XdpKeymap *
+load_default_keymap (void)
+{
+  struct xkb_context *context;
+  struct xkb_keymap *keymap;
+  XdpKeymap *self = NULL;
+
+  context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
+  if (context == NULL)
+    return NULL;
+
+  /* The XKB_DEFAULT_* environment variables pick the layout */
+  keymap = xkb_keymap_new_from_names (context, NULL, XKB_KEYMAP_COMPILE_NO_FLAGS);
+  if (keymap)
+    {
+      self = keymap_new (keymap);
+      xkb_keymap_unref (keymap);
+    }
+  else
+    {
+      g_warning ("Failed to compile the default keymap");
+    }
+
+  xkb_context_unref (context);
+
+  return self;
+}
+
+/* Shared by all sessions and never freed. The once holds a wrapper so
+ * that it completes even when there is no keymap to load. */
+XdpKeymap *
+_xdp_keymap_get_default (void)
+{
+  static gsize keymap = 0;
+
+  if (g_once_init_enter (&keymap))
+    {
+      XdpKeymap **slot = g_new (XdpKeymap *, 1);
+
+      *slot = load_default_keymap ();
+      g_once_init_leave (&keymap, (gsize) slot);
+    }
+
+  return *(XdpKeymap **) keymap;
+}
+
+XdpKeymap *
+_xdp_keymap_new_from_fd (int   fd,
+                         gsize size)
+{
+  struct xkb_context *context;
+  struct xkb_keymap *keymap = NULL;
+  XdpKeymap *self = NULL;
+  char *data;
+
+  data = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED)
+    return NULL;
+
+  context = xkb_context_new (XKB_CONTEXT_NO_FLAGS);
+  if (context)
+    keymap = xkb_keymap_new_from_buffer (context, data, strnlen (data, size),
+                                         XKB_KEYMAP_FORMAT_TEXT_V1,
+                                         XKB_KEYMAP_COMPILE_NO_FLAGS);
+  munmap (data, size);
+
+  if (keymap)
+    {
+      self = keymap_new (keymap);
+      xkb_keymap_unref (keymap);
+    }
+
+  g_clear_pointer (&context, xkb_context_unref);
+
+  return self;
+}
+
+gboolean
+_xdp_keymap_lookup (XdpKeymap   *keymap,
+                    guint32      keysym,
+                    XdpKeyCombo *combo)
+{
+  XdpKeyCombo *found;
+
+  found = g_hash_table_lookup (keymap->combos, GUINT_TO_POINTER (keysym));
+  if (found == NULL)
+    return FALSE;
+
+  *combo = *found;
+  return TRUE;
+}
+
+void
+_xdp_keymap_free (XdpKeymap *keymap)
+{
+  g_clear_pointer (&keymap->combos, g_hash_table_unref);
+  g_free (keymap);
+}
+
+#else /* HAVE_XKBCOMMON */
+
+XdpKeymap *
+_xdp_keymap_get_default (void)
+{
+  return NULL;
+}
+
+XdpKeymap *
+_xdp_keymap_new_from_fd (int   fd,
+                         gsize size)
+{
+  return NULL;
+}
+
+gboolean
+_xdp_keymap_lookup (XdpKeymap   *keymap,
+                    guint32      keysym,
+                    XdpKeyCombo *combo)
+{
+  return FALSE;
+}
+
+void
+_xdp_keymap_free (XdpKeymap *keymap)
+{
+}
+
+#endif /* HAVE_XKBCOMMON */
@@ -28,7 +28,6 @@ typedef struct {
   XdpParent *parent;
   char *parent_handle;
   char *id;
-  guint signal_id;
   GTask *task;
   char *request_path;
   guint cancelled_id;
@@ -47,8 +46,7 @@ create_call_free (CreateCall *call)
     }
   g_free (call->parent_handle);
 
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -90,7 +88,7 @@ session_started (GDBusConnection *bus,
     {
       if (call->portal->location_updated_signal != 0)
         {
-          g_dbus_connection_signal_unsubscribe (call->portal->bus, call->portal->location_updated_signal);
+          g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (call->portal), call->portal->location_updated_signal);
           call->portal->location_updated_signal = 0;
         }
       g_clear_pointer (&call->portal->location_monitor_handle, g_free);
@@ -142,7 +140,7 @@ ensure_location_updated_connected (XdpPortal *portal)
 {
   if (portal->location_updated_signal == 0)
     portal->location_updated_signal =
-        g_dbus_connection_signal_subscribe (portal->bus,
+        g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                             PORTAL_BUS_NAME,
                                             "org.freedesktop.portal.Location",
                                             "LocationUpdated",
@@ -160,7 +158,7 @@ cancelled_cb (GCancellable *cancellable,
 {
   CreateCall *call = data;
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -221,18 +219,9 @@ session_created (GObject *object,
       return;
     }
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        session_started,
-                                                        call,
-                                                        NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, session_started, call);
 
   g_variant_get (ret, "(o)", &call->portal->location_monitor_handle);
   ensure_location_updated_connected (call->portal);
@@ -244,7 +233,7 @@ session_created (GObject *object,
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Location",
@@ -293,8 +282,8 @@ create_session (CreateCall *call)
       return;
     }
 
-  session_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->id = g_strconcat (SESSION_PATH_PREFIX, call->portal->sender, "/", session_token, NULL);
+  session_token = _xdp_portal_new_token (call->portal);
+  call->id = g_strconcat (SESSION_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", session_token, NULL);
 
   cancellable = g_task_get_cancellable (call->task);
 
@@ -303,7 +292,7 @@ create_session (CreateCall *call)
   g_variant_builder_add (&options, "{sv}", "distance-threshold", g_variant_new_uint32 (call->distance));
   g_variant_builder_add (&options, "{sv}", "time-threshold", g_variant_new_uint32 (call->time));
   g_variant_builder_add (&options, "{sv}", "accuracy", g_variant_new_uint32 (call->accuracy));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Location",
@@ -411,7 +400,7 @@ xdp_portal_location_monitor_stop (XdpPortal *portal)
 
   if (portal->location_monitor_handle != NULL)
     {
-      g_dbus_connection_call (portal->bus,
+      g_dbus_connection_call (_xdp_portal_get_bus (portal),
                               PORTAL_BUS_NAME,
                               portal->location_monitor_handle,
                               SESSION_INTERFACE,
@@ -423,7 +412,7 @@ xdp_portal_location_monitor_stop (XdpPortal *portal)
 
   if (portal->location_updated_signal)
     {
-      g_dbus_connection_signal_unsubscribe (portal->bus, portal->location_updated_signal);
+      g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (portal), portal->location_updated_signal);
       portal->location_updated_signal = 0;
     }
 }
@@ -47,7 +47,7 @@ ensure_action_invoked_connection (XdpPortal *portal)
 {
   if (portal->action_invoked_signal == 0)
     portal->action_invoked_signal =
-       g_dbus_connection_signal_subscribe (portal->bus,
+       g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                            PORTAL_BUS_NAME,
                                            "org.freedesktop.portal.Notification",
                                            "ActionInvoked",
@@ -146,7 +146,7 @@ xdp_portal_add_notification (XdpPortal *portal,
       call_done_data->data = data;
     }
 
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Notification",
@@ -179,7 +179,7 @@ xdp_portal_add_notification_finish (XdpPortal     *portal,
 {
   g_autoptr(GVariant) res = NULL;
 
-  res = g_dbus_connection_call_finish (portal->bus, result, error);
+  res = g_dbus_connection_call_finish (_xdp_portal_get_bus (portal), result, error);
 
   return !!res;
 }
@@ -197,7 +197,7 @@ xdp_portal_remove_notification (XdpPortal  *portal,
 {
   g_return_if_fail (XDP_IS_PORTAL (portal));
 
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.Notification",
@@ -45,6 +45,18 @@ XdpPortal *xdp_portal_new                   (void);
 XDP_PUBLIC
 XdpPortal *xdp_portal_initable_new          (GError **error);
 
+XDP_PUBLIC
+XdpPortal *xdp_portal_new_lazy              (void);
+
+XDP_PUBLIC
+void       xdp_portal_new_async             (GCancellable         *cancellable,
+                                             GAsyncReadyCallback   callback,
+                                             gpointer              data);
+
+XDP_PUBLIC
+XdpPortal *xdp_portal_new_finish            (GAsyncResult         *result,
+                                             GError              **error);
+
 XDP_PUBLIC
 gboolean   xdp_portal_running_under_flatpak (void);
 
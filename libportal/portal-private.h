@@ -22,12 +22,29 @@
 #include "parent-private.h"
 #include "portal-helpers.h"
 
+typedef struct _XdpSettingsCache XdpSettingsCache;
+
 struct _XdpPortal {
   GObject parent_instance;
 
   GError *init_error;
   GDBusConnection *bus;
   char *sender;
+  gsize bus_ready;
+
+  /* requests and session signals, which may be used from any thread */
+  GMutex subscriptions_lock;
+
+  /* requests */
+  guint instance_serial;
+  gint next_request_serial;
+  GHashTable *pending_requests;
+  GHashTable *response_subscriptions; /* GMainContext → ResponseSubscription */
+
+  /* session signals */
+  GHashTable *session_signals;
+  GHashTable *session_handlers;
+  guint next_session_handler_id;
 
   /* inhibit */
   int next_inhibit_id;
@@ -50,16 +67,73 @@ struct _XdpPortal {
   /* notification */
   guint action_invoked_signal;
 
-  /* screencast */
-  guint screencast_interface_version;
-  guint remote_desktop_interface_version;
+  /* settings */
+  XdpSettingsCache *settings_cache;
 
-  /* background */
-  guint background_interface_version;
+  /* properties */
+  GMutex properties_lock;
+  GHashTable *properties;
+  guint properties_serial;
+  guint properties_changed_signal;
+  guint name_owner_changed_signal;
 };
 
 const char * portal_get_bus_name (void);
 
+GDBusConnection * _xdp_portal_get_bus    (XdpPortal *portal);
+
+const char *      _xdp_portal_get_sender (XdpPortal *portal);
+
+char * _xdp_portal_new_token (XdpPortal *portal);
+
+void   _xdp_portal_register_request (XdpPortal           *portal,
+                                     const char          *request_path,
+                                     GDBusSignalCallback  callback,
+                                     gpointer             data);
+
+void   _xdp_portal_unregister_request (XdpPortal  *portal,
+                                       const char *request_path);
+
+guint  _xdp_portal_subscribe_session_signal (XdpPortal           *portal,
+                                             const char          *interface_name,
+                                             const char          *signal_name,
+                                             const char          *session_path,
+                                             GDBusSignalCallback  callback,
+                                             gpointer             data);
+
+void   _xdp_portal_unsubscribe_session_signal (XdpPortal *portal,
+                                               guint      handler_id);
+
+void       _xdp_portal_load_properties        (XdpPortal            *portal,
+                                              const char * const   *interfaces,
+                                              GCancellable         *cancellable,
+                                              GAsyncReadyCallback   callback,
+                                              gpointer              data);
+
+gboolean   _xdp_portal_load_properties_finish (XdpPortal            *portal,
+                                              GAsyncResult         *result,
+                                              GError              **error);
+
+GVariant * _xdp_portal_get_property           (XdpPortal            *portal,
+                                              const char           *interface,
+                                              const char           *property);
+
+guint      _xdp_portal_get_interface_version  (XdpPortal            *portal,
+                                              const char           *interface);
+
+guint      _xdp_portal_get_cached_interface_version (XdpPortal      *portal,
+                                                    const char     *interface);
+
+void       _xdp_portal_call_fd                (XdpPortal            *portal,
+                                              const char           *object_path,
+                                              const char           *interface,
+                                              const char           *method,
+                                              GVariant             *parameters,
+                                              GTask                *task);
+
+int        _xdp_portal_call_fd_finish         (GAsyncResult         *result,
+                                              GError              **error);
+
 #define PORTAL_BUS_NAME (portal_get_bus_name ())
 #define PORTAL_OBJECT_PATH  "/org/freedesktop/portal/desktop"
 #define REQUEST_PATH_PREFIX "/org/freedesktop/portal/desktop/request/"
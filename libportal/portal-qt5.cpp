@@ -76,7 +76,7 @@ namespace XdpQt {
 
 class LibPortalQt5 {
 public:
-    LibPortalQt5() : m_xdpPortal(xdp_portal_new()) { }
+    LibPortalQt5() : m_xdpPortal(xdp_portal_new_lazy()) { }
     ~LibPortalQt5() { if (m_xdpPortal) { g_object_unref(m_xdpPortal); } }
     XdpPortal *portalObject() const { return m_xdpPortal; }
 private:
@@ -83,7 +83,7 @@ namespace XdpQt {
 
 class LibPortalQt6 {
 public:
-    LibPortalQt6() : m_xdpPortal(xdp_portal_new()) { }
+    LibPortalQt6() : m_xdpPortal(xdp_portal_new_lazy()) { }
     ~LibPortalQt6() { if (m_xdpPortal) { g_object_unref(m_xdpPortal); } }
     XdpPortal *portalObject() const { return m_xdpPortal; }
 private:
@@ -24,6 +24,8 @@
 
 #include "config.h"
 
+#include <gio/gunixfdlist.h>
+
 #include "portal-helpers.h"
 #include "portal-private.h"
 #include "portal-enums.h"
@@ -37,6 +39,7 @@
 #include <sys/vfs.h>
 #endif
 #include <stdio.h>
+#include <stdlib.h>
 
 const char *
 portal_get_bus_name (void)
@@ -76,10 +79,26 @@ enum {
 
 static guint signals[LAST_SIGNAL];
 static void xdp_portal_initable_iface_init (GInitableIface  *iface);
+static void xdp_portal_async_initable_iface_init (GAsyncInitableIface *iface);
 
 G_DEFINE_TYPE_WITH_CODE (XdpPortal, xdp_portal, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
-                                                xdp_portal_initable_iface_init))
+                                                xdp_portal_initable_iface_init)
+                         G_IMPLEMENT_INTERFACE (G_TYPE_ASYNC_INITABLE,
+                                                xdp_portal_async_initable_iface_init))
+
+/* Set while xdp_portal_new_async() or xdp_portal_new_lazy() construct
+ * an instance, so that xdp_portal_init() doesn't connect to the bus */
+static GPrivate defer_connection;
+
+typedef struct {
+  XdpPortal *portal;
+  GMainContext *context;
+  char *key;
+  guint subscription;
+  guint n_handlers;
+  GHashTable *handlers; /* session path → SessionHandler, not owned */
+} SessionSignal;
 
 static void
 xdp_portal_finalize (GObject *object)
@@ -88,6 +107,23 @@ xdp_portal_finalize (GObject *object)
 
   g_clear_error (&portal->init_error);
 
+  /* requests; dropping the last request of a context unsubscribes */
+  g_clear_pointer (&portal->pending_requests, g_hash_table_unref);
+  g_clear_pointer (&portal->response_subscriptions, g_hash_table_unref);
+
+  /* session signals; dropping the last handler of a signal unsubscribes */
+  g_clear_pointer (&portal->session_handlers, g_hash_table_unref);
+  g_clear_pointer (&portal->session_signals, g_hash_table_unref);
+
+  /* properties */
+  if (portal->properties_changed_signal)
+    g_dbus_connection_signal_unsubscribe (portal->bus, portal->properties_changed_signal);
+  if (portal->name_owner_changed_signal)
+    g_dbus_connection_signal_unsubscribe (portal->bus, portal->name_owner_changed_signal);
+  g_clear_pointer (&portal->properties, g_hash_table_unref);
+  g_mutex_clear (&portal->properties_lock);
+  g_mutex_clear (&portal->subscriptions_lock);
+
   /* inhibit */
   if (portal->inhibit_handles)
     g_hash_table_unref (portal->inhibit_handles);
@@ -117,6 +153,9 @@ xdp_portal_finalize (GObject *object)
   if (portal->action_invoked_signal)
     g_dbus_connection_signal_unsubscribe (portal->bus, portal->action_invoked_signal);
 
+  /* settings */
+  g_clear_pointer (&portal->settings_cache, _xdp_settings_cache_free);
+
   g_clear_object (&portal->bus);
   g_free (portal->sender);
 
@@ -301,28 +340,958 @@ create_bus_from_address (const char *address,
   return g_steal_pointer (&bus);
 }
 
-/* Historically, g_object_new() on an XdpPortal initialized it. We follow
- * that here by doing the actual initialization early, and only dealing
- * with the result in initable_init(). */
 static void
-xdp_portal_init (XdpPortal *portal)
+set_bus (XdpPortal       *portal,
+         GDBusConnection *bus)
 {
   int i;
 
+  portal->bus = bus;
+  portal->sender = g_strdup (g_dbus_connection_get_unique_name (portal->bus) + 1);
+  for (i = 0; portal->sender[i]; i++)
+    if (portal->sender[i] == '.')
+      portal->sender[i] = '_';
+}
+
+static void
+connect_to_bus_sync (XdpPortal    *portal,
+                     GCancellable *cancellable)
+{
+  GDBusConnection *bus;
+
   /* g_bus_get_sync() returns a singleton. In the test suite we may restart
    * the session bus, so we have to manually connect to the new bus */
   if (getenv ("LIBPORTAL_TEST_SUITE"))
-    portal->bus = create_bus_from_address (getenv ("DBUS_SESSION_BUS_ADDRESS"), &portal->init_error);
+    bus = create_bus_from_address (getenv ("DBUS_SESSION_BUS_ADDRESS"), &portal->init_error);
   else
-    portal->bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &portal->init_error);
+    bus = g_bus_get_sync (G_BUS_TYPE_SESSION, cancellable, &portal->init_error);
 
-  if (portal->bus == NULL)
+  if (bus)
+    set_bus (portal, bus);
+}
+
+/* Historically, g_object_new() on an XdpPortal initialized it. We follow
+ * that here by doing the actual initialization early, and only dealing
+ * with the result in initable_init().
+ * xdp_portal_new_async() is the exception: it defers connecting to
+ * init_async(). */
+static void
+xdp_portal_init (XdpPortal *portal)
+{
+  static gint instance_serial = 0;
+
+  /* Instances created in the same process share the session bus connection,
+   * and with it the unique name that request paths are built from. Give
+   * each instance its own token prefix so their counters can't collide. */
+  portal->instance_serial = g_atomic_int_add (&instance_serial, 1);
+
+  g_mutex_init (&portal->properties_lock);
+  g_mutex_init (&portal->subscriptions_lock);
+  portal->properties = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              NULL, (GDestroyNotify) g_hash_table_unref);
+
+  if (!g_private_get (&defer_connection))
+    connect_to_bus_sync (portal, NULL);
+}
+
+/*
+ * _xdp_portal_get_bus:
+ *
+ * Returns the session bus connection of @portal. Instances created
+ * with xdp_portal_new_lazy() connect here, the first time the bus is
+ * needed.
+ */
+GDBusConnection *
+_xdp_portal_get_bus (XdpPortal *portal)
+{
+  if (g_once_init_enter (&portal->bus_ready))
+    {
+      if (portal->bus == NULL && portal->init_error == NULL)
+        connect_to_bus_sync (portal, NULL);
+
+      /* Same contract as xdp_portal_new() */
+      if (portal->init_error != NULL)
+        {
+          g_critical ("Failed to connect XdpPortal to the session bus: %s", portal->init_error->message);
+          abort ();
+        }
+
+      g_once_init_leave (&portal->bus_ready, 1);
+    }
+
+  return portal->bus;
+}
+
+/*
+ * _xdp_portal_get_sender:
+ *
+ * Returns the unique name of the bus connection of @portal in the
+ * form used for request and session object paths.
+ */
+const char *
+_xdp_portal_get_sender (XdpPortal *portal)
+{
+  _xdp_portal_get_bus (portal);
+
+  return portal->sender;
+}
+
+/* The Response subscription of one main context. GDBus dispatches a
+ * signal in the thread-default context of the subscription, so each
+ * context that has requests in flight needs its own. */
+typedef struct {
+  XdpPortal *portal;
+  GMainContext *context;
+  guint subscription;
+  guint n_requests;
+} ResponseSubscription;
+
+typedef struct {
+  ResponseSubscription *subscription;
+  GDBusSignalCallback callback;
+  gpointer data;
+} PendingRequest;
+
+static void
+response_subscription_free (gpointer data)
+{
+  ResponseSubscription *subscription = data;
+
+  g_main_context_unref (subscription->context);
+  g_free (subscription);
+}
+
+/* Called with the subscriptions lock held */
+static void
+pending_request_free (gpointer data)
+{
+  PendingRequest *request = data;
+  ResponseSubscription *subscription = request->subscription;
+
+  if (--subscription->n_requests == 0)
+    {
+      g_hash_table_remove (subscription->portal->response_subscriptions, subscription->context);
+      g_dbus_connection_signal_unsubscribe (subscription->portal->bus, subscription->subscription);
+    }
+
+  g_free (request);
+}
+
+/* Dispatches Request::Response to whichever call registered the object path.
+ * There is a single subscription per main context, so issuing a request
+ * no longer touches GDBusConnection's signal tables. */
+static void
+request_response_received (GDBusConnection *bus,
+                           const char *sender_name,
+                           const char *object_path,
+                           const char *interface_name,
+                           const char *signal_name,
+                           GVariant *parameters,
+                           gpointer data)
+{
+  ResponseSubscription *subscription = data;
+  XdpPortal *portal = subscription->portal;
+  GDBusSignalCallback callback = NULL;
+  gpointer callback_data = NULL;
+  PendingRequest *request;
+
+  g_mutex_lock (&portal->subscriptions_lock);
+  request = g_hash_table_lookup (portal->pending_requests, object_path);
+  /* Requests made from other contexts are handled by their own subscription */
+  if (request && request->subscription == subscription)
+    {
+      callback = request->callback;
+      callback_data = request->data;
+    }
+  g_mutex_unlock (&portal->subscriptions_lock);
+
+  /* The callback usually unregisters the request */
+  if (callback)
+    callback (bus, sender_name, object_path, interface_name,
+              signal_name, parameters, callback_data);
+}
+
+/*
+ * _xdp_portal_new_token:
+ *
+ * Returns a handle token that is unique for the lifetime of the
+ * connection, suitable for the handle_token and session_handle_token
+ * options.
+ */
+char *
+_xdp_portal_new_token (XdpPortal *portal)
+{
+  return g_strdup_printf ("portal%u_%u",
+                          portal->instance_serial,
+                          (guint) g_atomic_int_add (&portal->next_request_serial, 1) + 1);
+}
+
+/*
+ * _xdp_portal_register_request:
+ *
+ * Routes the Response signal of the request at @request_path to
+ * @callback. The registration must be dropped again with
+ * _xdp_portal_unregister_request() once the request is finished.
+ *
+ * Responses are dispatched in the thread-default main context of the
+ * caller, like any other D-Bus signal.
+ */
+void
+_xdp_portal_register_request (XdpPortal           *portal,
+                              const char          *request_path,
+                              GDBusSignalCallback  callback,
+                              gpointer             data)
+{
+  ResponseSubscription *subscription;
+  PendingRequest *request;
+  GMainContext *context;
+
+  context = g_main_context_ref_thread_default ();
+
+  g_mutex_lock (&portal->subscriptions_lock);
+
+  if (portal->pending_requests == NULL)
+    {
+      portal->pending_requests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, pending_request_free);
+      portal->response_subscriptions = g_hash_table_new (NULL, NULL);
+    }
+
+  subscription = g_hash_table_lookup (portal->response_subscriptions, context);
+  if (subscription == NULL)
+    {
+      subscription = g_new0 (ResponseSubscription, 1);
+      subscription->portal = portal;
+      subscription->context = g_main_context_ref (context);
+      subscription->subscription =
+        g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
+                                            PORTAL_BUS_NAME,
+                                            REQUEST_INTERFACE,
+                                            "Response",
+                                            NULL,
+                                            NULL,
+                                            G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+                                            request_response_received,
+                                            subscription,
+                                            response_subscription_free);
+      g_hash_table_insert (portal->response_subscriptions, context, subscription);
+    }
+  subscription->n_requests++;
+
+  request = g_new (PendingRequest, 1);
+  request->subscription = subscription;
+  request->callback = callback;
+  request->data = data;
+
+  g_hash_table_replace (portal->pending_requests, g_strdup (request_path), request);
+
+  g_mutex_unlock (&portal->subscriptions_lock);
+
+  g_main_context_unref (context);
+}
+
+void
+_xdp_portal_unregister_request (XdpPortal  *portal,
+                                const char *request_path)
+{
+  if (request_path == NULL)
     return;
 
-  portal->sender = g_strdup (g_dbus_connection_get_unique_name (portal->bus) + 1);
-  for (i = 0; portal->sender[i]; i++)
-    if (portal->sender[i] == '.')
-      portal->sender[i] = '_';
+  g_mutex_lock (&portal->subscriptions_lock);
+  if (portal->pending_requests)
+    g_hash_table_remove (portal->pending_requests, request_path);
+  g_mutex_unlock (&portal->subscriptions_lock);
+}
+
+typedef struct {
+  SessionSignal *signal;
+  char *session_path;
+  GDBusSignalCallback callback;
+  gpointer data;
+} SessionHandler;
+
+static void
+session_signal_free (gpointer data)
+{
+  SessionSignal *signal = data;
+
+  g_hash_table_unref (signal->handlers);
+  g_main_context_unref (signal->context);
+  g_free (signal->key);
+  g_free (signal);
+}
+
+/* Called with the subscriptions lock held */
+static void
+session_handler_free (gpointer data)
+{
+  SessionHandler *handler = data;
+  SessionSignal *signal = handler->signal;
+
+  if (g_hash_table_lookup (signal->handlers, handler->session_path) == handler)
+    g_hash_table_remove (signal->handlers, handler->session_path);
+
+  if (--signal->n_handlers == 0)
+    {
+      g_hash_table_remove (signal->portal->session_signals, signal->key);
+      g_dbus_connection_signal_unsubscribe (signal->portal->bus, signal->subscription);
+    }
+
+  g_free (handler->session_path);
+  g_free (handler);
+}
+
+/* Dispatches a session signal to the handler registered for its session.
+ * The portal interfaces pass the session handle as the first argument,
+ * Session::Closed is emitted on the session object itself. */
+static void
+session_signal_received (GDBusConnection *bus,
+                         const char *sender_name,
+                         const char *object_path,
+                         const char *interface_name,
+                         const char *signal_name,
+                         GVariant *parameters,
+                         gpointer data)
+{
+  SessionSignal *signal = data;
+  XdpPortal *portal = signal->portal;
+  g_autoptr(GVariant) arg0 = NULL;
+  const char *session_path = object_path;
+  GDBusSignalCallback callback = NULL;
+  gpointer callback_data = NULL;
+  SessionHandler *handler;
+
+  if (g_variant_n_children (parameters) > 0)
+    {
+      arg0 = g_variant_get_child_value (parameters, 0);
+      if (g_variant_is_of_type (arg0, G_VARIANT_TYPE_OBJECT_PATH))
+        session_path = g_variant_get_string (arg0, NULL);
+    }
+
+  g_mutex_lock (&portal->subscriptions_lock);
+  handler = g_hash_table_lookup (signal->handlers, session_path);
+  if (handler)
+    {
+      callback = handler->callback;
+      callback_data = handler->data;
+    }
+  g_mutex_unlock (&portal->subscriptions_lock);
+
+  /* The callback may unsubscribe */
+  if (callback)
+    callback (bus, sender_name, object_path, interface_name,
+              signal_name, parameters, callback_data);
+}
+
+/*
+ * _xdp_portal_subscribe_session_signal:
+ *
+ * Routes @signal_name on @interface_name to @callback, but only when it
+ * concerns the session at @session_path. All sessions of a main context
+ * share one subscription per signal, so the cost of a signal doesn't
+ * grow with the number of sessions.
+ *
+ * Like request responses, the signal is dispatched in the thread-default
+ * main context of the caller.
+ *
+ * Returns: an id for _xdp_portal_unsubscribe_session_signal()
+ */
+guint
+_xdp_portal_subscribe_session_signal (XdpPortal           *portal,
+                                      const char          *interface_name,
+                                      const char          *signal_name,
+                                      const char          *session_path,
+                                      GDBusSignalCallback  callback,
+                                      gpointer             data)
+{
+  g_autofree char *key = NULL;
+  SessionSignal *signal;
+  SessionHandler *handler;
+  GMainContext *context;
+  guint id;
+
+  context = g_main_context_ref_thread_default ();
+
+  /* The signal holds a reference on its context, so the address can't
+   * be reused while the key is in the table */
+  key = g_strdup_printf ("%s.%s %p", interface_name, signal_name, context);
+
+  g_mutex_lock (&portal->subscriptions_lock);
+
+  if (portal->session_signals == NULL)
+    {
+      portal->session_signals = g_hash_table_new (g_str_hash, g_str_equal);
+      portal->session_handlers = g_hash_table_new_full (NULL, NULL, NULL, session_handler_free);
+    }
+
+  signal = g_hash_table_lookup (portal->session_signals, key);
+  if (signal == NULL)
+    {
+      signal = g_new0 (SessionSignal, 1);
+      signal->portal = portal;
+      signal->context = g_main_context_ref (context);
+      signal->key = g_steal_pointer (&key);
+      signal->handlers = g_hash_table_new (g_str_hash, g_str_equal);
+      signal->subscription =
+        g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
+                                            PORTAL_BUS_NAME,
+                                            interface_name,
+                                            signal_name,
+                                            NULL,
+                                            NULL,
+                                            G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+                                            session_signal_received,
+                                            signal,
+                                            session_signal_free);
+      g_hash_table_insert (portal->session_signals, signal->key, signal);
+    }
+  signal->n_handlers++;
+
+  handler = g_new (SessionHandler, 1);
+  handler->signal = signal;
+  handler->session_path = g_strdup (session_path);
+  handler->callback = callback;
+  handler->data = data;
+
+  g_hash_table_replace (signal->handlers, handler->session_path, handler);
+
+  id = ++portal->next_session_handler_id;
+  g_hash_table_insert (portal->session_handlers, GUINT_TO_POINTER (id), handler);
+
+  g_mutex_unlock (&portal->subscriptions_lock);
+
+  g_main_context_unref (context);
+
+  return id;
+}
+
+void
+_xdp_portal_unsubscribe_session_signal (XdpPortal *portal,
+                                        guint      handler_id)
+{
+  if (handler_id == 0)
+    return;
+
+  g_mutex_lock (&portal->subscriptions_lock);
+  if (portal->session_handlers)
+    g_hash_table_remove (portal->session_handlers, GUINT_TO_POINTER (handler_id));
+  g_mutex_unlock (&portal->subscriptions_lock);
+}
+
+/* Interfaces whose properties are fetched together, the first time
+ * any of them is needed */
+static const char * const known_interfaces[] = {
+  "org.freedesktop.portal.Account",
+  "org.freedesktop.portal.Background",
+  "org.freedesktop.portal.Camera",
+  "org.freedesktop.portal.DynamicLauncher",
+  "org.freedesktop.portal.Email",
+  "org.freedesktop.portal.FileChooser",
+  "org.freedesktop.portal.Inhibit",
+  "org.freedesktop.portal.InputCapture",
+  "org.freedesktop.portal.Location",
+  "org.freedesktop.portal.Notification",
+  "org.freedesktop.portal.OpenURI",
+  "org.freedesktop.portal.Print",
+  "org.freedesktop.portal.RemoteDesktop",
+  "org.freedesktop.portal.ScreenCast",
+  "org.freedesktop.portal.Screenshot",
+  "org.freedesktop.portal.Settings",
+  "org.freedesktop.portal.Trash",
+  "org.freedesktop.portal.Wallpaper",
+  NULL
+};
+
+static void
+name_owner_changed (GDBusConnection *bus,
+                    const char *sender_name,
+                    const char *object_path,
+                    const char *interface_name,
+                    const char *signal_name,
+                    GVariant *parameters,
+                    gpointer data)
+{
+  XdpPortal *portal = data;
+  const char *new_owner;
+
+  /* A new portal instance may implement different interfaces and
+   * versions, so forget everything we know about the old one */
+  g_mutex_lock (&portal->properties_lock);
+  g_hash_table_remove_all (portal->properties);
+  portal->properties_serial++;
+  g_mutex_unlock (&portal->properties_lock);
+
+  g_variant_get (parameters, "(&s&s&s)", NULL, NULL, &new_owner);
+  if (portal->settings_cache)
+    _xdp_settings_cache_name_owner_changed (portal->settings_cache, new_owner);
+}
+
+static void
+properties_changed (GDBusConnection *bus,
+                    const char *sender_name,
+                    const char *object_path,
+                    const char *interface_name,
+                    const char *signal_name,
+                    GVariant *parameters,
+                    gpointer data)
+{
+  XdpPortal *portal = data;
+  g_autoptr(GVariant) changed = NULL;
+  g_autofree const char **invalidated = NULL;
+  const char *interface;
+  GHashTable *properties;
+
+  g_variant_get (parameters, "(&s@a{sv}^a&s)", &interface, &changed, &invalidated);
+
+  g_mutex_lock (&portal->properties_lock);
+
+  /* Interfaces that aren't cached yet will be fetched fresh anyway */
+  properties = g_hash_table_lookup (portal->properties, interface);
+  if (properties)
+    {
+      GVariantIter iter;
+      const char *name;
+      GVariant *value;
+      int i;
+
+      g_variant_iter_init (&iter, changed);
+      while (g_variant_iter_next (&iter, "{&sv}", &name, &value))
+        g_hash_table_replace (properties, g_strdup (name), value);
+
+      for (i = 0; invalidated[i]; i++)
+        g_hash_table_remove (properties, invalidated[i]);
+    }
+
+  g_mutex_unlock (&portal->properties_lock);
+}
+
+static void
+ensure_properties_subscriptions (XdpPortal *portal)
+{
+  g_mutex_lock (&portal->properties_lock);
+
+  if (portal->name_owner_changed_signal == 0)
+    portal->name_owner_changed_signal =
+      g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
+                                          "org.freedesktop.DBus",
+                                          "org.freedesktop.DBus",
+                                          "NameOwnerChanged",
+                                          "/org/freedesktop/DBus",
+                                          PORTAL_BUS_NAME,
+                                          G_DBUS_SIGNAL_FLAGS_NONE,
+                                          name_owner_changed,
+                                          portal,
+                                          NULL);
+
+  if (portal->properties_changed_signal == 0)
+    portal->properties_changed_signal =
+      g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
+                                          PORTAL_BUS_NAME,
+                                          "org.freedesktop.DBus.Properties",
+                                          "PropertiesChanged",
+                                          PORTAL_OBJECT_PATH,
+                                          NULL,
+                                          G_DBUS_SIGNAL_FLAGS_NONE,
+                                          properties_changed,
+                                          portal,
+                                          NULL);
+
+  g_mutex_unlock (&portal->properties_lock);
+}
+
+static void
+store_properties (XdpPortal  *portal,
+                  guint       serial,
+                  const char *interface,
+                  GVariant   *dict)
+{
+  g_autoptr(GVariant) owned_dict = g_variant_ref_sink (dict);
+  GHashTable *properties;
+  GVariantIter iter;
+  const char *name;
+  GVariant *value;
+
+  properties = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                      g_free, (GDestroyNotify) g_variant_unref);
+
+  g_variant_iter_init (&iter, owned_dict);
+  while (g_variant_iter_next (&iter, "{&sv}", &name, &value))
+    g_hash_table_insert (properties, g_strdup (name), value);
+
+  g_mutex_lock (&portal->properties_lock);
+  /* Drop results that raced with the portal changing owner */
+  if (serial == portal->properties_serial)
+    g_hash_table_replace (portal->properties, (gpointer) g_intern_string (interface), properties);
+  else
+    g_hash_table_unref (properties);
+  g_mutex_unlock (&portal->properties_lock);
+}
+
+static gboolean
+lookup_property (XdpPortal   *portal,
+                 const char  *interface,
+                 const char  *property,
+                 GVariant   **out_value)
+{
+  GHashTable *properties;
+  GVariant *value = NULL;
+
+  g_mutex_lock (&portal->properties_lock);
+  properties = g_hash_table_lookup (portal->properties, interface);
+  if (properties)
+    value = g_hash_table_lookup (properties, property);
+  if (value)
+    g_variant_ref (value);
+  g_mutex_unlock (&portal->properties_lock);
+
+  *out_value = value;
+
+  return properties != NULL;
+}
+
+/* The portal answers GetAll for interfaces it doesn't implement with
+ * one of these; remember those as empty instead of asking again */
+static gboolean
+is_missing_interface_error (const GError *error)
+{
+  return g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS) ||
+         g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE);
+}
+
+typedef struct {
+  guint serial;
+  guint n_pending;
+} LoadPropertiesData;
+
+typedef struct {
+  GTask *task;
+  const char *interface;
+} GetAllCall;
+
+static void
+get_all_returned (GObject      *object,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  GetAllCall *call = data;
+  g_autoptr(GTask) task = call->task;
+  XdpPortal *portal = g_task_get_source_object (task);
+  LoadPropertiesData *load = g_task_get_task_data (task);
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) dict = NULL;
+  g_autoptr(GError) error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret)
+    {
+      g_variant_get (ret, "(@a{sv})", &dict);
+      store_properties (portal, load->serial, call->interface, dict);
+    }
+  else if (is_missing_interface_error (error))
+    {
+      store_properties (portal, load->serial, call->interface,
+                        g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+    }
+  else
+    {
+      /* Not fatal; the interface is fetched again when it's read */
+      g_debug ("Failed to get properties of %s: %s", call->interface, error->message);
+    }
+
+  if (--load->n_pending == 0 && !g_task_return_error_if_cancelled (task))
+    g_task_return_boolean (task, TRUE);
+
+  g_free (call);
+}
+
+static void
+load_interface (XdpPortal    *portal,
+                GTask        *task,
+                const char   *interface)
+{
+  LoadPropertiesData *load = g_task_get_task_data (task);
+  GetAllCall *call;
+
+  call = g_new0 (GetAllCall, 1);
+  call->task = g_object_ref (task);
+  call->interface = g_intern_string (interface);
+
+  load->n_pending++;
+
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.DBus.Properties",
+                          "GetAll",
+                          g_variant_new ("(s)", interface),
+                          G_VARIANT_TYPE ("(a{sv})"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          g_task_get_cancellable (task),
+                          get_all_returned,
+                          call);
+}
+
+static gboolean
+is_interface_cached (XdpPortal  *portal,
+                     const char *interface)
+{
+  gboolean cached;
+
+  g_mutex_lock (&portal->properties_lock);
+  cached = g_hash_table_contains (portal->properties, interface);
+  g_mutex_unlock (&portal->properties_lock);
+
+  return cached;
+}
+
+/*
+ * _xdp_portal_load_properties:
+ * @interfaces: (nullable): interfaces that must be loaded
+ *
+ * Makes sure the properties of @interfaces are cached. Every other
+ * known portal interface that isn't cached yet is fetched in the same
+ * batch; all GetAll calls are in flight at the same time, so this
+ * costs a single round-trip.
+ */
+void
+_xdp_portal_load_properties (XdpPortal            *portal,
+                             const char * const   *interfaces,
+                             GCancellable         *cancellable,
+                             GAsyncReadyCallback   callback,
+                             gpointer              data)
+{
+  g_autoptr(GTask) task = NULL;
+  LoadPropertiesData *load;
+  int i;
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, _xdp_portal_load_properties);
+
+  ensure_properties_subscriptions (portal);
+
+  load = g_new0 (LoadPropertiesData, 1);
+  g_mutex_lock (&portal->properties_lock);
+  load->serial = portal->properties_serial;
+  g_mutex_unlock (&portal->properties_lock);
+  g_task_set_task_data (task, load, g_free);
+
+  /* Hold a pending slot so that replies can't finish the task early */
+  load->n_pending = 1;
+
+  for (i = 0; interfaces && interfaces[i]; i++)
+    {
+      if (!is_interface_cached (portal, interfaces[i]) &&
+          !g_strv_contains (known_interfaces, interfaces[i]))
+        load_interface (portal, task, interfaces[i]);
+    }
+
+  for (i = 0; known_interfaces[i]; i++)
+    {
+      if (!is_interface_cached (portal, known_interfaces[i]))
+        load_interface (portal, task, known_interfaces[i]);
+    }
+
+  if (--load->n_pending == 0)
+    g_task_return_boolean (task, TRUE);
+}
+
+gboolean
+_xdp_portal_load_properties_finish (XdpPortal     *portal,
+                                    GAsyncResult  *result,
+                                    GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, portal), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == _xdp_portal_load_properties, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/*
+ * _xdp_portal_get_property:
+ *
+ * Returns the cached value of @property on @interface. If @interface
+ * has not been cached yet, its properties are fetched synchronously.
+ *
+ * Returns: (transfer full) (nullable): the property value
+ */
+GVariant *
+_xdp_portal_get_property (XdpPortal  *portal,
+                          const char *interface,
+                          const char *property)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) dict = NULL;
+  g_autoptr(GError) error = NULL;
+  GVariant *value = NULL;
+  guint serial;
+
+  if (lookup_property (portal, interface, property, &value))
+    return value;
+
+  ensure_properties_subscriptions (portal);
+
+  g_mutex_lock (&portal->properties_lock);
+  serial = portal->properties_serial;
+  g_mutex_unlock (&portal->properties_lock);
+
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (portal),
+                                     PORTAL_BUS_NAME,
+                                     PORTAL_OBJECT_PATH,
+                                     "org.freedesktop.DBus.Properties",
+                                     "GetAll",
+                                     g_variant_new ("(s)", interface),
+                                     G_VARIANT_TYPE ("(a{sv})"),
+                                     G_DBUS_CALL_FLAGS_NONE,
+                                     -1,
+                                     NULL,
+                                     &error);
+  if (!ret)
+    {
+      if (is_missing_interface_error (error))
+        store_properties (portal, serial, interface,
+                          g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+      else
+        g_warning ("Failed to get properties of %s: %s", interface, error->message);
+      return NULL;
+    }
+
+  g_variant_get (ret, "(@a{sv})", &dict);
+  store_properties (portal, serial, interface, dict);
+
+  return g_variant_lookup_value (dict, property, NULL);
+}
+
+/*
+ * _xdp_portal_get_cached_interface_version:
+ *
+ * Like _xdp_portal_get_interface_version(), but never blocks; for
+ * async callers that ran _xdp_portal_load_properties() first.
+ *
+ * Returns: the cached version of @interface, or 0 if it isn't
+ *   implemented or couldn't be fetched
+ */
+guint
+_xdp_portal_get_cached_interface_version (XdpPortal  *portal,
+                                          const char *interface)
+{
+  g_autoptr(GVariant) version = NULL;
+
+  lookup_property (portal, interface, "version", &version);
+  if (version == NULL || !g_variant_is_of_type (version, G_VARIANT_TYPE_UINT32))
+    return 0;
+
+  return g_variant_get_uint32 (version);
+}
+
+/*
+ * _xdp_portal_get_interface_version:
+ *
+ * Returns: the version of @interface, or 0 if the portal doesn't
+ *   implement it
+ */
+guint
+_xdp_portal_get_interface_version (XdpPortal  *portal,
+                                   const char *interface)
+{
+  g_autoptr(GVariant) version = NULL;
+
+  version = _xdp_portal_get_property (portal, interface, "version");
+  if (version == NULL || !g_variant_is_of_type (version, G_VARIANT_TYPE_UINT32))
+    return 0;
+
+  return g_variant_get_uint32 (version);
+}
+
+static void
+fd_call_done (GObject      *object,
+              GAsyncResult *result,
+              gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  g_autoptr(GVariant) ret = NULL;
+  GError *error = NULL;
+  int handle;
+  int fd;
+
+  ret = g_dbus_connection_call_with_unix_fd_list_finish (G_DBUS_CONNECTION (object),
+                                                         &fd_list,
+                                                         result,
+                                                         &error);
+  if (ret == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_variant_get (ret, "(h)", &handle);
+  fd = fd_list ? g_unix_fd_list_get (fd_list, handle, &error) : -1;
+  if (fd < 0)
+    {
+      if (error == NULL)
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED, "No file descriptor in the reply");
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* The list owns the fd until it is finished, so it isn't leaked if
+   * it never is */
+  g_task_return_pointer (task, g_unix_fd_list_new_from_array (&fd, 1), g_object_unref);
+}
+
+/*
+ * _xdp_portal_call_fd:
+ * @portal: a [class@Portal]
+ * @object_path: the object to call @method on
+ * @interface: the interface of @method
+ * @method: a method returning `(h)`
+ * @parameters: the parameters of @method
+ * @task: (transfer none): the task to complete with the fd
+ *
+ * Makes a method call that returns a file descriptor without blocking,
+ * for the _async() variants of calls such as
+ * [method@Session.open_pipewire_remote]. Use
+ * _xdp_portal_call_fd_finish() to get the fd.
+ */
+void
+_xdp_portal_call_fd (XdpPortal  *portal,
+                     const char *object_path,
+                     const char *interface,
+                     const char *method,
+                     GVariant   *parameters,
+                     GTask      *task)
+{
+  g_dbus_connection_call_with_unix_fd_list (_xdp_portal_get_bus (portal),
+                                            PORTAL_BUS_NAME,
+                                            object_path,
+                                            interface,
+                                            method,
+                                            parameters,
+                                            G_VARIANT_TYPE ("(h)"),
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1,
+                                            NULL,
+                                            g_task_get_cancellable (task),
+                                            fd_call_done,
+                                            g_object_ref (task));
+}
+
+/*
+ * _xdp_portal_call_fd_finish:
+ *
+ * Returns: the fd of a call made with _xdp_portal_call_fd(), or -1
+ */
+int
+_xdp_portal_call_fd_finish (GAsyncResult  *result,
+                            GError       **error)
+{
+  g_autoptr(GUnixFDList) fd_list = NULL;
+
+  fd_list = g_task_propagate_pointer (G_TASK (result), error);
+  if (fd_list == NULL)
+    return -1;
+
+  return g_unix_fd_list_get (fd_list, 0, error);
 }
 
 static gboolean
@@ -332,6 +1301,10 @@ xdp_portal_initable_init (GInitable     *initable,
 {
   XdpPortal *portal = (XdpPortal*) initable;
 
+  /* Construction was deferred for init_async(), but we got here instead */
+  if (portal->bus == NULL && portal->init_error == NULL)
+    connect_to_bus_sync (portal, cancellable);
+
   if (portal->init_error != NULL)
     {
       g_propagate_error (out_error, g_error_copy (portal->init_error));
@@ -348,6 +1321,106 @@ xdp_portal_initable_iface_init (GInitableIface *iface)
   iface->init = xdp_portal_initable_init;
 }
 
+static void
+bus_connected (GObject      *object,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  XdpPortal *portal = g_task_get_source_object (task);
+  GDBusConnection *bus;
+  GError *error = NULL;
+
+  if (getenv ("LIBPORTAL_TEST_SUITE"))
+    bus = g_dbus_connection_new_for_address_finish (result, &error);
+  else
+    bus = g_bus_get_finish (result, &error);
+
+  if (bus == NULL)
+    {
+      if (portal->bus == NULL)
+        portal->init_error = g_error_copy (error);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* A method call may have connected synchronously in the meantime */
+  if (portal->bus == NULL)
+    set_bus (portal, bus);
+  else
+    g_object_unref (bus);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+xdp_portal_async_initable_init_async (GAsyncInitable      *initable,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             data)
+{
+  XdpPortal *portal = (XdpPortal*) initable;
+  g_autoptr(GTask) task = NULL;
+
+  task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_portal_async_initable_init_async);
+  g_task_set_priority (task, io_priority);
+
+  /* Constructed with g_object_new(), which already connected */
+  if (portal->init_error != NULL)
+    {
+      g_task_return_error (task, g_error_copy (portal->init_error));
+      return;
+    }
+  else if (portal->bus != NULL)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  /* See connect_to_bus_sync() for why the test suite doesn't use the singleton */
+  if (getenv ("LIBPORTAL_TEST_SUITE"))
+    {
+      const char *address = getenv ("DBUS_SESSION_BUS_ADDRESS");
+
+      if (!address)
+        {
+          g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "Missing D-Bus session bus address");
+          return;
+        }
+
+      g_dbus_connection_new_for_address (address,
+                                         G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                         G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                         NULL,
+                                         cancellable,
+                                         bus_connected,
+                                         g_steal_pointer (&task));
+    }
+  else
+    {
+      g_bus_get (G_BUS_TYPE_SESSION, cancellable, bus_connected, g_steal_pointer (&task));
+    }
+}
+
+static gboolean
+xdp_portal_async_initable_init_finish (GAsyncInitable  *initable,
+                                       GAsyncResult    *result,
+                                       GError         **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, initable), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+xdp_portal_async_initable_iface_init (GAsyncInitableIface *iface)
+{
+  iface->init_async = xdp_portal_async_initable_init_async;
+  iface->init_finish = xdp_portal_async_initable_init_finish;
+}
+
 /**
  * xdp_portal_initable_new:
  * @error: A GError location to store the error occurring, or NULL to ignore.
@@ -364,6 +1437,92 @@ xdp_portal_initable_new (GError **error)
   return g_initable_new (XDP_TYPE_PORTAL, NULL, error, NULL);
 }
 
+/**
+ * xdp_portal_new_lazy:
+ *
+ * Creates a new [class@Portal] object that doesn't connect to the
+ * session bus until the first portal call that needs it.
+ *
+ * This is useful for applications that create a portal object at
+ * startup but rarely use it. Sandbox checks such as
+ * [func@Portal.running_under_sandbox] never connect to the bus.
+ *
+ * Like [ctor@Portal.new], this aborts if D-Bus is unavailable, but not
+ * here: the process aborts inside whichever later call first needs the
+ * bus, such as a [method@Portal.set_wallpaper] call long after startup.
+ * Use [ctor@Portal.new_async] or [ctor@Portal.initable_new] to handle
+ * the failure instead.
+ *
+ * Returns: (transfer full): a newly created [class@Portal] object
+ *
+ * Since: 0.9
+ */
+XdpPortal *
+xdp_portal_new_lazy (void)
+{
+  XdpPortal *portal;
+
+  g_private_set (&defer_connection, GINT_TO_POINTER (TRUE));
+  portal = g_object_new (XDP_TYPE_PORTAL, NULL);
+  g_private_set (&defer_connection, NULL);
+
+  return portal;
+}
+
+/**
+ * xdp_portal_new_async:
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the portal is ready
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously creates a new [class@Portal] object.
+ *
+ * Unlike [ctor@Portal.initable_new], this does not block on connecting
+ * to the session bus. When the portal is ready, @callback will be called.
+ * You can then call [ctor@Portal.new_finish] to get the result.
+ *
+ * Since: 0.9
+ */
+void
+xdp_portal_new_async (GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             data)
+{
+  g_private_set (&defer_connection, GINT_TO_POINTER (TRUE));
+  g_async_initable_new_async (XDP_TYPE_PORTAL,
+                              G_PRIORITY_DEFAULT,
+                              cancellable,
+                              callback,
+                              data,
+                              NULL);
+  g_private_set (&defer_connection, NULL);
+}
+
+/**
+ * xdp_portal_new_finish:
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes creating a [class@Portal] object.
+ *
+ * Returns: (transfer full) (nullable): a newly created [class@Portal] object
+ *   or `NULL` on error
+ *
+ * Since: 0.9
+ */
+XdpPortal *
+xdp_portal_new_finish (GAsyncResult  *result,
+                       GError       **error)
+{
+  g_autoptr(GObject) source_object = NULL;
+  GObject *portal;
+
+  source_object = g_async_result_get_source_object (result);
+  portal = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), result, error);
+
+  return (XdpPortal *) portal;
+}
+
 /**
  * xdp_portal_new:
  *
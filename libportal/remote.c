@@ -22,6 +22,8 @@
 #include <gio/gunixfdlist.h>
 
 #include "remote.h"
+#include "input-batch-private.h"
+#include "keymap-private.h"
 #include "portal-private.h"
 #include "session-private.h"
 
@@ -35,7 +37,6 @@ typedef struct {
   XdpPersistMode persist_mode;
   char *restore_token;
   gboolean multiple;
-  guint signal_id;
   GTask *task;
   char *request_path;
   guint cancelled_id;
@@ -44,8 +45,7 @@ typedef struct {
 static void
 create_call_free (CreateCall *call)
 {
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -125,33 +125,23 @@ select_sources (CreateCall *call)
 {
   GVariantBuilder options;
   g_autofree char *token = NULL;
-  g_autofree char *handle = NULL;
-
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  handle = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        handle,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        sources_selected,
-                                                        call,
-                                                        NULL);
+
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, sources_selected, call);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
   g_variant_builder_add (&options, "{sv}", "types", g_variant_new_uint32 (call->outputs));
   g_variant_builder_add (&options, "{sv}", "multiple", g_variant_new_boolean (call->multiple));
   g_variant_builder_add (&options, "{sv}", "cursor_mode", g_variant_new_uint32 (call->cursor_mode));
-  if (call->portal->screencast_interface_version >= 4)
+  if (_xdp_portal_get_interface_version (call->portal, "org.freedesktop.portal.ScreenCast") >= 4)
     {
       g_variant_builder_add (&options, "{sv}", "persist_mode", g_variant_new_uint32 (call->persist_mode));
       if (call->restore_token)
         g_variant_builder_add (&options, "{sv}", "restore_token", g_variant_new_string (call->restore_token));
     }
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.ScreenCast",
@@ -188,8 +178,8 @@ devices_selected (GDBusConnection *bus,
 
   if (response == 0)
     {
-      g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-      call->signal_id = 0;
+      _xdp_portal_unregister_request (call->portal, call->request_path);
+      g_clear_pointer (&call->request_path, g_free);
 
       if (call->outputs != XDP_OUTPUT_NONE)
         select_sources (call);
@@ -219,31 +209,21 @@ select_devices (CreateCall *call)
 {
   GVariantBuilder options;
   g_autofree char *token = NULL;
-  g_autofree char *handle = NULL;
-
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  handle = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        handle,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        devices_selected,
-                                                        call,
-                                                        NULL);
+
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, devices_selected, call);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
   g_variant_builder_add (&options, "{sv}", "types", g_variant_new_uint32 (call->devices));
-  if (call->portal->remote_desktop_interface_version >= 2)
+  if (_xdp_portal_get_interface_version (call->portal, "org.freedesktop.portal.RemoteDesktop") >= 2)
     {
       g_variant_builder_add (&options, "{sv}", "persist_mode", g_variant_new_uint32 (call->persist_mode));
       if (call->restore_token)
         g_variant_builder_add (&options, "{sv}", "restore_token", g_variant_new_string (call->restore_token));
     }
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           "org.freedesktop.portal.RemoteDesktop",
@@ -280,8 +260,8 @@ session_created (GDBusConnection *bus,
 
   if (response == 0)
     {
-      g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-      call->signal_id = 0;
+      _xdp_portal_unregister_request (call->portal, call->request_path);
+      g_clear_pointer (&call->request_path, g_free);
 
       if (call->type == XDP_SESSION_REMOTE_DESKTOP)
         select_devices (call);
@@ -303,7 +283,7 @@ create_cancelled_cb (GCancellable *cancellable,
 {
   CreateCall *call = data;
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -323,21 +303,12 @@ create_session (CreateCall *call)
   g_autofree char *session_token = NULL;
   GCancellable *cancellable;
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        session_created,
-                                                        call,
-                                                        NULL);
-
-  session_token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->id = g_strconcat (SESSION_PATH_PREFIX, call->portal->sender, "/", session_token, NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, session_created, call);
+
+  session_token = _xdp_portal_new_token (call->portal);
+  call->id = g_strconcat (SESSION_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", session_token, NULL);
 
   cancellable = g_task_get_cancellable (call->task);
   if (cancellable)
@@ -346,7 +317,7 @@ create_session (CreateCall *call)
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
   g_variant_builder_add (&options, "{sv}", "session_handle_token", g_variant_new_string (session_token));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           call->type == XDP_SESSION_REMOTE_DESKTOP ?
@@ -363,88 +334,37 @@ create_session (CreateCall *call)
 }
 
 static void
-get_screencast_interface_version_returned (GObject *object,
-                                           GAsyncResult *result,
-                                           gpointer data)
+properties_loaded (GObject *object,
+                   GAsyncResult *result,
+                   gpointer data)
 {
   CreateCall *call = data;
   GError *error = NULL;
-  g_autoptr(GVariant) version_variant = NULL;
-  g_autoptr(GVariant) ret = NULL;
 
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
+  if (!_xdp_portal_load_properties_finish (call->portal, result, &error))
     {
       g_task_return_error (call->task, error);
       create_call_free (call);
       return;
     }
 
-  g_variant_get_child (ret, 0, "v", &version_variant);
-  call->portal->screencast_interface_version = g_variant_get_uint32 (version_variant);
-
   create_session (call);
 }
 
 static void
-get_screencast_interface_version (CreateCall *call)
-{
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.DBus.Properties",
-                          "Get",
-                          g_variant_new ("(ss)", "org.freedesktop.portal.ScreenCast", "version"),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          g_task_get_cancellable (call->task),
-                          get_screencast_interface_version_returned,
-                          call);
-}
-
-static void
-get_remote_desktop_interface_version_returned (GObject *object,
-                                               GAsyncResult *result,
-                                               gpointer data)
-{
-  CreateCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) version_variant = NULL;
-  g_autoptr(GVariant) ret = NULL;
-
-  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-  if (error)
-    {
-      g_task_return_error (call->task, error);
-      create_call_free (call);
-      return;
-    }
-
-  g_variant_get_child (ret, 0, "v", &version_variant);
-  call->portal->remote_desktop_interface_version = g_variant_get_uint32 (version_variant);
-
-  if (call->portal->screencast_interface_version == 0)
-    get_screencast_interface_version (call);
-  else
-    create_session (call);
-}
-
-static void
-get_remote_desktop_interface_version (CreateCall *call)
+load_session_properties (CreateCall *call)
 {
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.DBus.Properties",
-                          "Get",
-                          g_variant_new ("(ss)", "org.freedesktop.portal.RemoteDesktop", "version"),
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          g_task_get_cancellable (call->task),
-                          get_remote_desktop_interface_version_returned,
-                          call);
+  static const char * const interfaces[] = {
+    "org.freedesktop.portal.ScreenCast",
+    "org.freedesktop.portal.RemoteDesktop",
+    NULL
+  };
+
+  _xdp_portal_load_properties (call->portal,
+                               interfaces,
+                               g_task_get_cancellable (call->task),
+                               properties_loaded,
+                               call);
 }
 
 /**
@@ -491,10 +411,7 @@ xdp_portal_create_screencast_session (XdpPortal *portal,
   call->multiple = (flags & XDP_SCREENCAST_FLAG_MULTIPLE) != 0;
   call->task = g_task_new (portal, cancellable, callback, data);
 
-  if (portal->screencast_interface_version == 0)
-    get_screencast_interface_version (call);
-  else
-    create_session (call);
+  load_session_properties (call);
 }
 
 /**
@@ -608,10 +525,7 @@ xdp_portal_create_remote_desktop_session_full (XdpPortal *portal,
   call->multiple = (flags & XDP_REMOTE_DESKTOP_FLAG_MULTIPLE) != 0;
   call->task = g_task_new (portal, cancellable, callback, data);
 
-  if (portal->remote_desktop_interface_version == 0)
-    get_remote_desktop_interface_version (call);
-  else
-    create_session (call);
+  load_session_properties (call);
 }
 
 /**
@@ -648,7 +562,6 @@ typedef struct {
   XdpSession *session;
   XdpParent *parent;
   char *parent_handle;
-  guint signal_id;
   GTask *task;
   char *request_path;
   guint cancelled_id;
@@ -664,8 +577,7 @@ start_call_free (StartCall *call)
     }
   g_free (call->parent_handle);
 
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
+  _xdp_portal_unregister_request (call->portal, call->request_path);
 
   if (call->cancelled_id)
     g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
@@ -749,7 +661,7 @@ start_cancelled_cb (GCancellable *cancellable,
 {
   StartCall *call = data;
 
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           call->request_path,
                           REQUEST_INTERFACE,
@@ -774,18 +686,9 @@ start_session (StartCall *call)
       return;
     }
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        session_started,
-                                                        call,
-                                                        NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
+  _xdp_portal_register_request (call->portal, call->request_path, session_started, call);
 
   cancellable = g_task_get_cancellable (call->task);
   if (cancellable)
@@ -793,7 +696,7 @@ start_session (StartCall *call)
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           PORTAL_BUS_NAME,
                           PORTAL_OBJECT_PATH,
                           call->session->type == XDP_SESSION_REMOTE_DESKTOP
@@ -894,7 +797,7 @@ xdp_session_open_pipewire_remote (XdpSession *session)
   g_return_val_if_fail (XDP_IS_SESSION (session), -1);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  ret = g_dbus_connection_call_with_unix_fd_list_sync (session->portal->bus,
+  ret = g_dbus_connection_call_with_unix_fd_list_sync (_xdp_portal_get_bus (session->portal),
                                                        PORTAL_BUS_NAME,
                                                        PORTAL_OBJECT_PATH,
                                                        "org.freedesktop.portal.ScreenCast",
@@ -918,66 +821,125 @@ xdp_session_open_pipewire_remote (XdpSession *session)
   return g_unix_fd_list_get (fd_list, fd_out, NULL);
 }
 
-static inline gboolean
-is_active_remote_desktop_session (XdpSession    *session,
-                                  XdpDeviceType  required_device)
+/**
+ * xdp_session_open_pipewire_remote_async:
+ * @session: a [class@Session]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Opens a file descriptor to the pipewire remote where the screencast
+ * streams are available, like [method@Session.open_pipewire_remote],
+ * but without blocking on the portal.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_open_pipewire_remote_async (XdpSession          *session,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             data)
 {
-  return XDP_IS_SESSION (session) &&
-         session->type == XDP_SESSION_REMOTE_DESKTOP &&
-         session->state == XDP_SESSION_ACTIVE &&
-         !session->uses_eis &&
-         (session->devices & required_device) != 0;
+  g_autoptr(GTask) task = NULL;
+  GVariantBuilder options;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_open_pipewire_remote_async);
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  _xdp_portal_call_fd (session->portal,
+                       PORTAL_OBJECT_PATH,
+                       "org.freedesktop.portal.ScreenCast",
+                       "OpenPipeWireRemote",
+                       g_variant_new ("(oa{sv})", session->id, &options),
+                       task);
 }
 
 /**
- * xdp_session_connect_to_eis
+ * xdp_session_open_pipewire_remote_finish:
  * @session: a [class@Session]
- * @error: return location for a #GError pointer
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
  *
- * Connect this XdpRemoteDesktopSession to an EIS implementation and return the fd.
- * This fd can be passed into ei_setup_backend_fd(). See the libei
- * documentation for details.
+ * Finishes opening the pipewire remote.
  *
- * This call must be issued before xdp_session_start(). If successful, all input
- * event emulation must be handled via the EIS connection and calls to
- * xdp_session_pointer_motion() etc. are silently ignored.
+ * Returns: the file descriptor, or -1 on error
  *
- * Returns: the file descriptor to the EIS implementation
+ * Since: 0.9
  */
 int
-xdp_session_connect_to_eis (XdpSession  *session,
-                            GError     **error)
+xdp_session_open_pipewire_remote_finish (XdpSession    *session,
+                                         GAsyncResult  *result,
+                                         GError       **error)
 {
-  XdpPortal *portal = session->portal;
-  GVariantBuilder options;
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GUnixFDList) fd_list = NULL;
-  int fd_out = -1;
+  g_return_val_if_fail (XDP_IS_SESSION (session), -1);
+  g_return_val_if_fail (g_task_is_valid (result, session), -1);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_open_pipewire_remote_async, -1);
+
+  return _xdp_portal_call_fd_finish (result, error);
+}
+
+static inline gboolean
+is_active_remote_desktop_session (XdpSession    *session,
+                                  XdpDeviceType  required_device)
+{
+  return XDP_IS_SESSION (session) &&
+         session->type == XDP_SESSION_REMOTE_DESKTOP &&
+         session->state == XDP_SESSION_ACTIVE &&
+         (!session->uses_eis || session->eis_sender != NULL) &&
+         (required_device == XDP_DEVICE_NONE || (session->devices & required_device) != 0);
+}
+
+static void dispatch_event (XdpSession       *session,
+                            const InputEvent *event);
 
-  if (portal->remote_desktop_interface_version < 2)
+static gboolean
+can_connect_to_eis (XdpSession  *session,
+                    GError     **error)
+{
+  if (_xdp_portal_get_interface_version (session->portal, "org.freedesktop.portal.RemoteDesktop") < 2)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Not supported by the portal interface");
-      return -1;
+      return FALSE;
     }
   else if (session->type != XDP_SESSION_REMOTE_DESKTOP)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not a Remote Desktop session");
-      return -1;
+      return FALSE;
     }
   else if (xdp_session_get_session_state (session) != XDP_SESSION_ACTIVE)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session has not been started");
-      return -1;
+      return FALSE;
     }
   else if (session->uses_eis)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is already connected to EIS");
-      return -1;
+      return FALSE;
     }
 
+  return TRUE;
+}
+
+/* Asks the portal for an EIS fd without switching @session over to EIS */
+static int
+connect_to_eis (XdpSession  *session,
+                GError     **error)
+{
+  XdpPortal *portal = session->portal;
+  GVariantBuilder options;
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GUnixFDList) fd_list = NULL;
+  int fd_out = -1;
+
+  if (!can_connect_to_eis (session, error))
+    return -1;
+
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
 
-  ret = g_dbus_connection_call_with_unix_fd_list_sync (portal->bus,
+  ret = g_dbus_connection_call_with_unix_fd_list_sync (_xdp_portal_get_bus (portal),
                                                        PORTAL_BUS_NAME,
                                                        PORTAL_OBJECT_PATH,
                                                        "org.freedesktop.portal.RemoteDesktop",
@@ -995,11 +957,111 @@ xdp_session_connect_to_eis (XdpSession  *session,
   if (!ret)
       return -1;
 
-  session->uses_eis = TRUE;
-
   g_variant_get (ret, "(h)", &fd_out);
 
-  return g_unix_fd_list_get (fd_list, fd_out, NULL);
+  return g_unix_fd_list_get (fd_list, fd_out, error);
+}
+
+/**
+ * xdp_session_connect_to_eis
+ * @session: a [class@Session]
+ * @error: return location for a #GError pointer
+ *
+ * Connect this XdpRemoteDesktopSession to an EIS implementation and return the fd.
+ * This fd can be passed into ei_setup_backend_fd(). See the libei
+ * documentation for details.
+ *
+ * This call must be issued before xdp_session_start(). If successful, all input
+ * event emulation must be handled via the EIS connection and calls to
+ * xdp_session_pointer_motion() etc. are silently ignored, unless the fd
+ * is passed to xdp_session_enable_eis_input().
+ *
+ * Returns: the file descriptor to the EIS implementation
+ */
+int
+xdp_session_connect_to_eis (XdpSession  *session,
+                            GError     **error)
+{
+  int fd;
+
+  fd = connect_to_eis (session, error);
+  if (fd >= 0)
+    session->uses_eis = TRUE;
+
+  return fd;
+}
+
+/**
+ * xdp_session_connect_to_eis_async:
+ * @session: a [class@Session]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: data to pass to @callback
+ *
+ * Connects @session to an EIS implementation, like
+ * [method@Session.connect_to_eis], but without blocking on the portal.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_connect_to_eis_async (XdpSession          *session,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  GVariantBuilder options;
+  GError *error = NULL;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_connect_to_eis_async);
+
+  if (!can_connect_to_eis (session, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
+  _xdp_portal_call_fd (session->portal,
+                       PORTAL_OBJECT_PATH,
+                       "org.freedesktop.portal.RemoteDesktop",
+                       "ConnectToEIS",
+                       g_variant_new ("(oa{sv})", session->id, &options),
+                       task);
+}
+
+/**
+ * xdp_session_connect_to_eis_finish:
+ * @session: a [class@Session]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes connecting to EIS. From then on, input is handled as
+ * described for [method@Session.connect_to_eis].
+ *
+ * Returns: the file descriptor to the EIS implementation, or -1 on error
+ *
+ * Since: 0.9
+ */
+int
+xdp_session_connect_to_eis_finish (XdpSession    *session,
+                                   GAsyncResult  *result,
+                                   GError       **error)
+{
+  int fd;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), -1);
+  g_return_val_if_fail (g_task_is_valid (result, session), -1);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_connect_to_eis_async, -1);
+
+  fd = _xdp_portal_call_fd_finish (result, error);
+  if (fd >= 0)
+    session->uses_eis = TRUE;
+
+  return fd;
 }
 
 /**
@@ -1018,18 +1080,13 @@ xdp_session_pointer_motion (XdpSession *session,
                             double dx,
                             double dy)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_POINTER_MOTION, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_POINTER));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyPointerMotion",
-                          g_variant_new ("(oa{sv}dd)", session->id, &options, dx, dy),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.motion.dx = dx;
+  event.u.motion.dy = dy;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1051,18 +1108,14 @@ xdp_session_pointer_position (XdpSession *session,
                               double x,
                               double y)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_POINTER_POSITION, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_POINTER));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyPointerMotionAbsolute",
-                          g_variant_new ("(oa{sv}udd)", session->id, &options, stream, x, y),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.position.stream = stream;
+  event.u.position.x = x;
+  event.u.position.y = y;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1081,18 +1134,13 @@ xdp_session_pointer_button (XdpSession *session,
                             int button,
                             XdpButtonState state)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_POINTER_BUTTON, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_POINTER));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyPointerButton",
-                          g_variant_new ("(oa{sv}iu)", session->id, &options, button, state),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.button.button = button;
+  event.u.button.state = state;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1115,19 +1163,14 @@ xdp_session_pointer_axis (XdpSession *session,
                           double dx,
                           double dy)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_POINTER_AXIS, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_POINTER));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "finish", g_variant_new_boolean (finish));
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyPointerAxis",
-                          g_variant_new ("(oa{sv}dd)", session->id, &options, dx, dy),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.axis.finish = !!finish;
+  event.u.axis.dx = dx;
+  event.u.axis.dy = dy;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1146,18 +1189,13 @@ xdp_session_pointer_axis_discrete (XdpSession *session,
                                    XdpDiscreteAxis axis,
                                    int steps)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_POINTER_AXIS_DISCRETE, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_POINTER));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyPointerAxisDiscrete",
-                          g_variant_new ("(oa{sv}ui)", session->id, &options, axis, steps),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.axis_discrete.axis = axis;
+  event.u.axis_discrete.steps = steps;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1178,18 +1216,14 @@ xdp_session_keyboard_key (XdpSession *session,
                           int key,
                           XdpKeyState state)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_KEYBOARD_KEY, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_KEYBOARD));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          keysym ? "NotifyKeyboardKeysym" : "NotifyKeyboardKeycode",
-                          g_variant_new ("(oa{sv}iu)", session->id, &options, key, state),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.key.keysym = !!keysym;
+  event.u.key.key = key;
+  event.u.key.state = state;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1215,18 +1249,15 @@ xdp_session_touch_down (XdpSession *session,
                         double x,
                         double y)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_TOUCH_DOWN, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_TOUCHSCREEN));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyTouchDown",
-                          g_variant_new ("(oa{sv}uudd)", session->id, &options, stream, slot, x, y),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.touch.stream = stream;
+  event.u.touch.slot = slot;
+  event.u.touch.x = x;
+  event.u.touch.y = y;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1252,18 +1283,15 @@ xdp_session_touch_position (XdpSession *session,
                             double x,
                             double y)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_TOUCH_POSITION, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_TOUCHSCREEN));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyTouchMotion",
-                          g_variant_new ("(oa{sv}uudd)", session->id, &options, stream, slot, x, y),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.touch.stream = stream;
+  event.u.touch.slot = slot;
+  event.u.touch.x = x;
+  event.u.touch.y = y;
+  dispatch_event (session, &event);
 }
 
 /**
@@ -1280,18 +1308,980 @@ void
 xdp_session_touch_up (XdpSession *session,
                       guint slot)
 {
-  GVariantBuilder options;
+  InputEvent event = { INPUT_EVENT_TOUCH_UP, };
 
   g_return_if_fail (is_active_remote_desktop_session (session, XDP_DEVICE_TOUCHSCREEN));
 
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (session->portal->bus,
-                          PORTAL_BUS_NAME,
-                          PORTAL_OBJECT_PATH,
-                          "org.freedesktop.portal.RemoteDesktop",
-                          "NotifyTouchUp",
-                          g_variant_new ("(oa{sv}u)", session->id, &options, slot),
-                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+  event.u.touch.slot = slot;
+  dispatch_event (session, &event);
+}
+
+typedef struct {
+  guint n_pending;
+  guint n_delivered;
+  GError *error;
+} SendEventsCall;
+
+static void
+send_events_call_free (SendEventsCall *call)
+{
+  g_clear_error (&call->error);
+  g_free (call);
+}
+
+static void
+event_sent (GObject      *object,
+            GAsyncResult *result,
+            gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  SendEventsCall *call = g_task_get_task_data (task);
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GError) error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
+  if (ret)
+    call->n_delivered++;
+  else if (call->error == NULL)
+    call->error = g_steal_pointer (&error);
+
+  if (--call->n_pending > 0)
+    return;
+
+  if (call->error)
+    g_task_return_error (task, g_steal_pointer (&call->error));
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+/* All events without options of their own share this */
+static GVariant *
+get_empty_options (void)
+{
+  static gsize options = 0;
+
+  if (g_once_init_enter (&options))
+    {
+      GVariant *empty = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
+
+      g_once_init_leave (&options, (gsize) g_variant_ref_sink (empty));
+    }
+
+  return (GVariant *) options;
+}
+
+/* @finish_options holds the options of smooth scroll events without and
+ * with the finish flag; if it is %NULL, they are built as needed */
+static GVariant *
+event_to_parameters (const InputEvent *event,
+                     const char       *session_id,
+                     GVariant         *options,
+                     GVariant         *finish_options[2],
+                     const char      **method)
+{
+  switch (event->type)
+    {
+    case INPUT_EVENT_POINTER_MOTION:
+      *method = "NotifyPointerMotion";
+      return g_variant_new ("(o@a{sv}dd)", session_id, options,
+                            event->u.motion.dx, event->u.motion.dy);
+
+    case INPUT_EVENT_POINTER_POSITION:
+      *method = "NotifyPointerMotionAbsolute";
+      return g_variant_new ("(o@a{sv}udd)", session_id, options,
+                            event->u.position.stream,
+                            event->u.position.x, event->u.position.y);
+
+    case INPUT_EVENT_POINTER_BUTTON:
+      *method = "NotifyPointerButton";
+      return g_variant_new ("(o@a{sv}iu)", session_id, options,
+                            event->u.button.button, event->u.button.state);
+
+    case INPUT_EVENT_POINTER_AXIS:
+      *method = "NotifyPointerAxis";
+      if (finish_options)
+        {
+          options = finish_options[event->u.axis.finish];
+        }
+      else
+        {
+          GVariantBuilder builder;
+
+          g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+          g_variant_builder_add (&builder, "{sv}", "finish", g_variant_new_boolean (event->u.axis.finish));
+          options = g_variant_builder_end (&builder);
+        }
+      return g_variant_new ("(o@a{sv}dd)", session_id, options,
+                            event->u.axis.dx, event->u.axis.dy);
+
+    case INPUT_EVENT_POINTER_AXIS_DISCRETE:
+      *method = "NotifyPointerAxisDiscrete";
+      return g_variant_new ("(o@a{sv}ui)", session_id, options,
+                            event->u.axis_discrete.axis, event->u.axis_discrete.steps);
+
+    case INPUT_EVENT_KEYBOARD_KEY:
+      *method = event->u.key.keysym ? "NotifyKeyboardKeysym" : "NotifyKeyboardKeycode";
+      return g_variant_new ("(o@a{sv}iu)", session_id, options,
+                            event->u.key.key, event->u.key.state);
+
+    case INPUT_EVENT_TOUCH_DOWN:
+    case INPUT_EVENT_TOUCH_POSITION:
+      *method = event->type == INPUT_EVENT_TOUCH_DOWN ? "NotifyTouchDown" : "NotifyTouchMotion";
+      return g_variant_new ("(o@a{sv}uudd)", session_id, options,
+                            event->u.touch.stream, event->u.touch.slot,
+                            event->u.touch.x, event->u.touch.y);
+
+    case INPUT_EVENT_TOUCH_UP:
+      *method = "NotifyTouchUp";
+      return g_variant_new ("(o@a{sv}u)", session_id, options, event->u.touch.slot);
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return NULL;
+}
+
+static void
+send_event (XdpSession       *session,
+            const InputEvent *event)
+{
+  const char *method = NULL;
+  GVariant *parameters;
+
+  if (session->eis_sender)
+    {
+      _xdp_eis_sender_send (session->eis_sender, event);
+      return;
+    }
+
+  parameters = event_to_parameters (event, session->id, get_empty_options (), NULL, &method);
+  g_dbus_connection_call (_xdp_portal_get_bus (session->portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          "org.freedesktop.portal.RemoteDesktop",
+                          method,
+                          parameters,
+                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
+}
+
+void
+_xdp_session_flush_motion (XdpSession *session)
+{
+  g_autoptr(GArray) pending = NULL;
+  guint i;
+
+  if (session->motion_source)
+    {
+      g_source_destroy (session->motion_source);
+      g_clear_pointer (&session->motion_source, g_source_unref);
+    }
+
+  pending = g_steal_pointer (&session->pending_motion);
+  if (pending == NULL || pending->len == 0)
+    return;
+
+  /* Motion that is still pending when the session ends is dropped */
+  if (session->state != XDP_SESSION_ACTIVE ||
+      (session->uses_eis && session->eis_sender == NULL))
+    return;
+
+  for (i = 0; i < pending->len; i++)
+    send_event (session, &g_array_index (pending, InputEvent, i));
+}
+
+static gboolean
+flush_motion (gpointer data)
+{
+  XdpSession *session = data;
+
+  g_clear_pointer (&session->motion_source, g_source_unref);
+  _xdp_session_flush_motion (session);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_motion (XdpSession       *session,
+              const InputEvent *event)
+{
+  InputEvent *last = NULL;
+  guint i;
+
+  if (session->pending_motion == NULL)
+    session->pending_motion = g_array_new (FALSE, FALSE, sizeof (InputEvent));
+
+  if (session->pending_motion->len > 0)
+    last = &g_array_index (session->pending_motion, InputEvent, session->pending_motion->len - 1);
+
+  if (event->type == INPUT_EVENT_POINTER_MOTION)
+    {
+      /* Consecutive relative motion adds up to a single delta */
+      if (last && last->type == INPUT_EVENT_POINTER_MOTION)
+        {
+          last->u.motion.dx += event->u.motion.dx;
+          last->u.motion.dy += event->u.motion.dy;
+        }
+      else
+        {
+          g_array_append_val (session->pending_motion, *event);
+        }
+    }
+  else
+    {
+      /* Only the latest position within a stream matters */
+      for (i = 0; i < session->pending_motion->len; i++)
+        {
+          InputEvent *pending = &g_array_index (session->pending_motion, InputEvent, i);
+
+          if (pending->type == INPUT_EVENT_POINTER_POSITION &&
+              pending->u.position.stream == event->u.position.stream)
+            {
+              g_array_remove_index (session->pending_motion, i);
+              break;
+            }
+        }
+      g_array_append_val (session->pending_motion, *event);
+    }
+
+  if (session->motion_source)
+    return;
+
+  if (session->coalesce_interval == 0)
+    session->motion_source = g_idle_source_new ();
+  else
+    session->motion_source = g_timeout_source_new (session->coalesce_interval);
+
+  g_source_set_callback (session->motion_source, flush_motion, session, NULL);
+  g_source_set_name (session->motion_source, "[libportal] pointer motion");
+  g_source_attach (session->motion_source, g_main_context_get_thread_default ());
+}
+
+/* Called on the thread that owns the pending motion: the thread of the
+ * caller, or the input thread once it is enabled */
+void
+_xdp_session_handle_event (XdpSession       *session,
+                           const InputEvent *event)
+{
+  if (session->coalesce_motion &&
+      (event->type == INPUT_EVENT_POINTER_MOTION ||
+       event->type == INPUT_EVENT_POINTER_POSITION))
+    {
+      queue_motion (session, event);
+      return;
+    }
+
+  _xdp_session_flush_motion (session);
+  send_event (session, event);
+}
+
+static void
+dispatch_event (XdpSession       *session,
+                const InputEvent *event)
+{
+  g_mutex_lock (&session->recorder_lock);
+  if (session->recorder)
+    _xdp_input_recorder_add (session->recorder, event);
+  g_mutex_unlock (&session->recorder_lock);
+
+  if (session->input_thread)
+    _xdp_input_thread_push (session->input_thread, event);
+  else
+    _xdp_session_handle_event (session, event);
+}
+
+/**
+ * xdp_session_enable_motion_coalescing:
+ * @session: a remote desktop [class@Session]
+ * @interval_ms: how long to collect motion for, in milliseconds, or 0
+ *   to send it once the main loop is idle
+ *
+ * Makes @session coalesce pointer motion.
+ *
+ * Instead of sending each call to [method@Session.pointer_motion] and
+ * [method@Session.pointer_position] to the portal right away, the
+ * motion is collected for @interval_ms: consecutive relative motion is
+ * summed up, and only the latest absolute position in each stream is
+ * kept. Collected motion is sent before any other input event, so
+ * button, key, scroll and touch events stay in order with it.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_enable_motion_coalescing (XdpSession *session,
+                                      guint       interval_ms)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (session->type == XDP_SESSION_REMOTE_DESKTOP);
+  g_return_if_fail (session->input_thread == NULL);
+
+  /* Don't keep motion that was collected with a different interval
+   * waiting any longer than that */
+  if (session->coalesce_motion && session->coalesce_interval != interval_ms)
+    _xdp_session_flush_motion (session);
+
+  session->coalesce_motion = TRUE;
+  session->coalesce_interval = interval_ms;
+}
+
+/**
+ * xdp_session_disable_motion_coalescing:
+ * @session: a remote desktop [class@Session]
+ *
+ * Stops coalescing pointer motion, after sending any motion that was
+ * collected so far.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_disable_motion_coalescing (XdpSession *session)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (session->input_thread == NULL);
+
+  _xdp_session_flush_motion (session);
+  session->coalesce_motion = FALSE;
+}
+
+/**
+ * xdp_session_enable_input_thread:
+ * @session: a remote desktop [class@Session]
+ *
+ * Makes @session send its input events from a thread of its own.
+ *
+ * Afterwards, the input functions of @session, such as
+ * [method@Session.pointer_motion] and [method@Session.keyboard_key],
+ * may be called from any thread. Events are sent in the order of the
+ * calls. Collected pointer motion, see
+ * [method@Session.enable_motion_coalescing], is flushed by that thread,
+ * so it isn't delayed while the main loop of the application is busy.
+ * Motion coalescing must be configured before calling this.
+ *
+ * The thread stops when @session is closed or finalized. It can't be
+ * combined with [method@Session.enable_eis_input].
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_enable_input_thread (XdpSession *session)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (session->type == XDP_SESSION_REMOTE_DESKTOP);
+  g_return_if_fail (session->eis_sender == NULL);
+
+  if (session->input_thread)
+    return;
+
+  /* Pending motion waits on the main context of the caller; send it
+   * before the input thread takes over */
+  _xdp_session_flush_motion (session);
+  session->input_thread = _xdp_input_thread_new (session);
+}
+
+/**
+ * xdp_session_enable_eis_input:
+ * @session: an active remote desktop [class@Session]
+ * @fd: a connection to EIS, as returned by [method@Session.connect_to_eis],
+ *   or -1 to connect
+ * @error: return location for a #GError pointer
+ *
+ * Makes @session send the events of its input functions, such as
+ * [method@Session.pointer_motion], over EIS with libei, instead of
+ * making a portal method call for each of them.
+ *
+ * The EIS connection is dispatched by the thread-default main context
+ * of the caller; the input functions must be called from the same
+ * thread. Absolute positions and touch points are in the logical
+ * coordinate space of the EIS devices rather than that of a stream, and
+ * keysyms can't be sent.
+ *
+ * This takes ownership of @fd, even on failure.
+ *
+ * Returns: %TRUE if input is now sent over EIS. Fails with
+ *   %G_IO_ERROR_NOT_SUPPORTED if libportal was built without libei.
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_session_enable_eis_input (XdpSession  *session,
+                              int          fd,
+                              GError     **error)
+{
+  g_return_val_if_fail (XDP_IS_SESSION (session), FALSE);
+  g_return_val_if_fail (session->input_thread == NULL, FALSE);
+  g_return_val_if_fail (session->eis_sender == NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#ifndef HAVE_LIBEI
+  /* Don't ask the portal for a connection we can't use */
+  if (fd < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "libportal was built without libei support");
+      return FALSE;
+    }
+#endif
+
+  /* The session only switches to EIS once the sender exists, so on
+   * failure input keeps going through the portal */
+  if (fd < 0)
+    {
+      fd = connect_to_eis (session, error);
+      if (fd < 0)
+        return FALSE;
+    }
+
+  /* Pending motion is for the portal */
+  _xdp_session_flush_motion (session);
+
+  session->eis_sender = _xdp_eis_sender_new (fd, error);
+  if (session->eis_sender == NULL)
+    return FALSE;
+
+  session->uses_eis = TRUE;
+
+  return TRUE;
+}
+
+/**
+ * xdp_session_send_events:
+ * @session: a remote desktop [class@Session]
+ * @batch: the events to send
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when all events were handled
+ * @data: data to pass to @callback
+ *
+ * Sends the events of @batch to the portal.
+ *
+ * The events are sent back to back, in the order they were added to
+ * @batch, without waiting for the portal to handle each one in turn.
+ * They all share one options dictionary, rather than building one per
+ * event.
+ *
+ * The session must have access to the devices of all events in @batch;
+ * otherwise, no event is sent.
+ *
+ * When all events have been handled, @callback is called, and
+ * [method@Session.send_events_finish] reports how many of them the
+ * portal accepted.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_send_events (XdpSession          *session,
+                         XdpInputBatch       *batch,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             data)
+{
+  g_autoptr(GVariant) options = NULL;
+  GVariant *finish_options[2];
+  g_autoptr(GTask) task = NULL;
+  SendEventsCall *call;
+  const InputEvent *events;
+  XdpDeviceType devices = XDP_DEVICE_NONE;
+  GDBusConnection *bus;
+  guint n_events;
+  guint i;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (XDP_IS_INPUT_BATCH (batch));
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_send_events);
+
+  call = g_new0 (SendEventsCall, 1);
+  g_task_set_task_data (task, call, (GDestroyNotify) send_events_call_free);
+
+  events = _xdp_input_batch_get_events (batch, &n_events);
+  for (i = 0; i < n_events; i++)
+    devices |= _xdp_input_event_get_device (&events[i]);
+
+  if (session->type != XDP_SESSION_REMOTE_DESKTOP)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not a Remote Desktop session");
+      return;
+    }
+  else if (session->state != XDP_SESSION_ACTIVE)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session has not been started");
+      return;
+    }
+  else if (session->uses_eis && session->eis_sender == NULL)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is connected to EIS");
+      return;
+    }
+  else if ((session->devices & devices) != devices)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED, "Session has no access to all devices of the batch");
+      return;
+    }
+
+  g_mutex_lock (&session->recorder_lock);
+  if (session->recorder)
+    {
+      for (i = 0; i < n_events; i++)
+        _xdp_input_recorder_add (session->recorder, &events[i]);
+    }
+  g_mutex_unlock (&session->recorder_lock);
+
+  if (session->input_thread)
+    _xdp_input_thread_sync (session->input_thread);
+  else
+    _xdp_session_flush_motion (session);
+
+  /* EIS has no replies; events are delivered once they are written */
+  if (n_events == 0 || session->eis_sender)
+    {
+      for (i = 0; i < n_events; i++)
+        send_event (session, &events[i]);
+      call->n_delivered = n_events;
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  options = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+  for (i = 0; i < 2; i++)
+    {
+      GVariantBuilder builder;
+
+      g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+      g_variant_builder_add (&builder, "{sv}", "finish", g_variant_new_boolean (i));
+      finish_options[i] = g_variant_ref_sink (g_variant_builder_end (&builder));
+    }
+
+  /* Messages on a connection are sent in the order they are queued,
+   * so the portal sees the events in batch order */
+  bus = _xdp_portal_get_bus (session->portal);
+  call->n_pending = n_events;
+  for (i = 0; i < n_events; i++)
+    {
+      const char *method = NULL;
+      GVariant *parameters;
+
+      parameters = event_to_parameters (&events[i], session->id, options, finish_options, &method);
+      g_dbus_connection_call (bus,
+                              PORTAL_BUS_NAME,
+                              PORTAL_OBJECT_PATH,
+                              "org.freedesktop.portal.RemoteDesktop",
+                              method,
+                              parameters,
+                              NULL, G_DBUS_CALL_FLAGS_NONE, -1,
+                              cancellable,
+                              event_sent,
+                              g_object_ref (task));
+    }
+
+  g_variant_unref (finish_options[0]);
+  g_variant_unref (finish_options[1]);
+}
+
+/**
+ * xdp_session_send_events_finish:
+ * @session: a [class@Session]
+ * @result: a [iface@Gio.AsyncResult]
+ * @n_delivered: (out) (optional): return location for the number of
+ *   events the portal accepted
+ * @error: return location for an error
+ *
+ * Finishes sending a batch of events.
+ *
+ * @n_delivered is set even if sending some of the events failed.
+ *
+ * Returns: %TRUE if all events were delivered
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_session_send_events_finish (XdpSession    *session,
+                                GAsyncResult  *result,
+                                guint         *n_delivered,
+                                GError       **error)
+{
+  SendEventsCall *call;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, session), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_send_events, FALSE);
+
+  call = g_task_get_task_data (G_TASK (result));
+  if (n_delivered)
+    *n_delivered = call->n_delivered;
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+text_typed (GObject      *object,
+            GAsyncResult *result,
+            gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  GError *error = NULL;
+
+  if (xdp_session_send_events_finish (XDP_SESSION (object), result, NULL, &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+/**
+ * xdp_session_type_text:
+ * @session: a remote desktop [class@Session]
+ * @text: the UTF-8 text to type
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the text was typed
+ * @data: data to pass to @callback
+ *
+ * Types @text by pressing and releasing a key for each of its
+ * characters. Newlines and tabs are typed with the Return and Tab keys;
+ * other control characters are skipped.
+ *
+ * All key events are sent as one batch, see [method@Session.send_events].
+ * They are sent as keysyms, which the portal types with whatever keys
+ * and modifiers produce them. Over EIS, see
+ * [method@Session.enable_eis_input], which only knows key codes, each
+ * keysym is looked up in the keymap of the EIS keyboard, or the default
+ * keymap, and typed with its key and the Shift and AltGr modifiers it
+ * needs; characters the keymap can't type are skipped.
+ *
+ * May only be called on a remote desktop session
+ * with `XDP_DEVICE_KEYBOARD` access.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_type_text (XdpSession          *session,
+                       const char          *text,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             data)
+{
+  g_autoptr(XdpInputBatch) batch = NULL;
+  g_autoptr(GTask) task = NULL;
+  const char *p;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (text != NULL);
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_type_text);
+
+  if (!g_utf8_validate (text, -1, NULL))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Text is not valid UTF-8");
+      return;
+    }
+
+  batch = xdp_input_batch_new ();
+  for (p = text; *p; p = g_utf8_next_char (p))
+    {
+      guint32 keysym;
+
+      /* Type CR LF once */
+      if (p[0] == '\r' && p[1] == '\n')
+        continue;
+
+      keysym = _xdp_keysym_from_unichar (g_utf8_get_char (p));
+      if (keysym == 0)
+        continue;
+
+      xdp_input_batch_keyboard_key (batch, TRUE, keysym, XDP_KEY_PRESSED);
+      xdp_input_batch_keyboard_key (batch, TRUE, keysym, XDP_KEY_RELEASED);
+    }
+
+  xdp_session_send_events (session, batch, cancellable, text_typed, g_steal_pointer (&task));
+}
+
+/**
+ * xdp_session_type_text_finish:
+ * @session: a [class@Session]
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for an error
+ *
+ * Finishes typing text.
+ *
+ * Returns: %TRUE if all keys were sent
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_session_type_text_finish (XdpSession    *session,
+                              GAsyncResult  *result,
+                              GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SESSION (session), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, session), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_type_text, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * xdp_session_start_recording:
+ * @session: a remote desktop [class@Session]
+ *
+ * Starts recording the input events of @session, as they are made with
+ * its input functions, such as [method@Session.pointer_motion], or
+ * [method@Session.send_events], along with the time they were made.
+ *
+ * Use [method@Session.stop_recording] to get the recording, and
+ * [method@Session.replay] to play it back.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_start_recording (XdpSession *session)
+{
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (session->type == XDP_SESSION_REMOTE_DESKTOP);
+
+  g_mutex_lock (&session->recorder_lock);
+  if (session->recorder == NULL)
+    session->recorder = _xdp_input_recorder_new ();
+  else
+    g_critical ("%s: the session is already being recorded", G_STRFUNC);
+  g_mutex_unlock (&session->recorder_lock);
+}
+
+/**
+ * xdp_session_stop_recording:
+ * @session: a remote desktop [class@Session]
+ *
+ * Stops recording the input events of @session, see
+ * [method@Session.start_recording].
+ *
+ * The recording is in a compact binary format with a fixed size per
+ * event. It can be saved to a file as it is, and replayed from a mapped
+ * file, see [method@GLib.MappedFile.get_bytes].
+ *
+ * Returns: (transfer full): the recording
+ *
+ * Since: 0.9
+ */
+GBytes *
+xdp_session_stop_recording (XdpSession *session)
+{
+  XdpInputRecorder *recorder;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), NULL);
+
+  /* Once the recorder is taken, no thread can add to it any more */
+  g_mutex_lock (&session->recorder_lock);
+  recorder = g_steal_pointer (&session->recorder);
+  g_mutex_unlock (&session->recorder_lock);
+
+  g_return_val_if_fail (recorder != NULL, NULL);
+
+  return _xdp_input_recorder_finish (recorder);
+}
+
+/* Yield to the main loop this often when replaying at full speed */
+#define REPLAY_CHUNK 256
+
+typedef struct {
+  GVariant *events;
+  gsize n_events;
+  gsize next;
+  double speed;
+  gint64 start;
+  GSource *source;
+} ReplayCall;
+
+static void
+replay_call_free (ReplayCall *call)
+{
+  if (call->source)
+    g_source_destroy (call->source);
+  g_clear_pointer (&call->source, g_source_unref);
+  g_clear_pointer (&call->events, g_variant_unref);
+  g_free (call);
+}
+
+static gboolean
+replay_dispatch (GSource     *source,
+                 GSourceFunc  callback,
+                 gpointer     data)
+{
+  return callback (data);
+}
+
+static GSourceFuncs replay_source_funcs = {
+  NULL,
+  NULL,
+  replay_dispatch,
+  NULL,
+};
+
+static gboolean
+replay_events (gpointer data)
+{
+  GTask *task = data;
+  XdpSession *session = g_task_get_source_object (task);
+  ReplayCall *call = g_task_get_task_data (task);
+  gsize n_sent = 0;
+  gint64 now;
+
+  if (g_task_return_error_if_cancelled (task))
+    return G_SOURCE_REMOVE;
+
+  if (!is_active_remote_desktop_session (session, XDP_DEVICE_NONE))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CLOSED, "Session is not active");
+      return G_SOURCE_REMOVE;
+    }
+
+  now = g_get_monotonic_time ();
+  while (call->next < call->n_events)
+    {
+      InputEvent event;
+      gint64 time;
+
+      _xdp_input_recording_get_event (call->events, call->next, &time, &event);
+
+      if (call->speed > 0)
+        {
+          gint64 due = call->start + (gint64) (time / call->speed);
+
+          if (due > now)
+            {
+              g_source_set_ready_time (call->source, due);
+              return G_SOURCE_CONTINUE;
+            }
+        }
+      else if (n_sent == REPLAY_CHUNK)
+        {
+          g_source_set_ready_time (call->source, 0);
+          return G_SOURCE_CONTINUE;
+        }
+
+      dispatch_event (session, &event);
+      call->next++;
+      n_sent++;
+    }
+
+  g_task_return_boolean (task, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * xdp_session_replay:
+ * @session: a remote desktop [class@Session]
+ * @recording: a recording made with [method@Session.stop_recording]
+ * @speed: how much faster than recorded to replay, or 0 to replay as
+ *   fast as possible
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the recording was replayed
+ * @data: data to pass to @callback
+ *
+ * Replays the input events of @recording through @session, as if its
+ * input functions were called again.
+ *
+ * With a @speed of 1, the events are sent with the same time between
+ * them as when they were recorded; with 2, twice as fast. Pacing is to
+ * the microsecond, as far as the main loop of the thread-default main
+ * context allows.
+ *
+ * The session must have access to the devices of all events in
+ * @recording; otherwise, no event is sent.
+ *
+ * Since: 0.9
+ */
+void
+xdp_session_replay (XdpSession          *session,
+                    GBytes              *recording,
+                    double               speed,
+                    GCancellable        *cancellable,
+                    GAsyncReadyCallback  callback,
+                    gpointer             data)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(GVariant) events = NULL;
+  XdpDeviceType devices;
+  ReplayCall *call;
+  GError *error = NULL;
+
+  g_return_if_fail (XDP_IS_SESSION (session));
+  g_return_if_fail (recording != NULL);
+  g_return_if_fail (speed >= 0);
+
+  task = g_task_new (session, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_session_replay);
+
+  events = _xdp_input_recording_load (recording, &devices, &error);
+  if (events == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  if (!is_active_remote_desktop_session (session, XDP_DEVICE_NONE))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Session is not an active Remote Desktop session");
+      return;
+    }
+  else if ((session->devices & devices) != devices)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED, "Session has no access to all devices of the recording");
+      return;
+    }
+
+  call = g_new0 (ReplayCall, 1);
+  call->events = g_steal_pointer (&events);
+  call->n_events = g_variant_n_children (call->events);
+  call->speed = speed;
+  call->start = g_get_monotonic_time ();
+  g_task_set_task_data (task, call, (GDestroyNotify) replay_call_free);
+
+  call->source = g_source_new (&replay_source_funcs, sizeof (GSource));
+  g_source_set_callback (call->source, replay_events, g_object_ref (task), g_object_unref);
+  g_source_set_name (call->source, "[libportal] input replay");
+  g_source_set_ready_time (call->source, 0);
+  if (cancellable)
+    {
+      g_autoptr(GSource) cancel_source = g_cancellable_source_new (cancellable);
+
+      g_source_set_dummy_callback (cancel_source);
+      g_source_add_child_source (call->source, cancel_source);
+    }
+  g_source_attach (call->source, g_main_context_get_thread_default ());
+}
+
+/**
+ * xdp_session_replay_finish:
+ * @session: a [class@Session]
+ * @result: a [iface@Gio.AsyncResult]
+ * @n_events: (out) (optional): return location for the number of
+ *   events replayed
+ * @error: return location for an error
+ *
+ * Finishes replaying a recording.
+ *
+ * @n_events is set even if the replay was cancelled.
+ *
+ * Returns: %TRUE if the whole recording was replayed
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_session_replay_finish (XdpSession    *session,
+                           GAsyncResult  *result,
+                           guint         *n_events,
+                           GError       **error)
+{
+  ReplayCall *call;
+
+  g_return_val_if_fail (XDP_IS_SESSION (session), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, session), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_session_replay, FALSE);
+
+  call = g_task_get_task_data (G_TASK (result));
+  if (n_events)
+    *n_events = call ? call->next : 0;
+
+  return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
@@ -184,6 +184,17 @@ gboolean    xdp_session_start_finish         (XdpSession           *session,
 XDP_PUBLIC
 int         xdp_session_open_pipewire_remote (XdpSession           *session);
 
+XDP_PUBLIC
+void        xdp_session_open_pipewire_remote_async  (XdpSession           *session,
+                                                     GCancellable         *cancellable,
+                                                     GAsyncReadyCallback   callback,
+                                                     gpointer              data);
+
+XDP_PUBLIC
+int         xdp_session_open_pipewire_remote_finish (XdpSession           *session,
+                                                     GAsyncResult         *result,
+                                                     GError              **error);
+
 XDP_PUBLIC
 XdpDeviceType   xdp_session_get_devices       (XdpSession *session);
 
@@ -194,6 +205,17 @@ XDP_PUBLIC
 int       xdp_session_connect_to_eis    (XdpSession  *session,
                                          GError     **error);
 
+XDP_PUBLIC
+void      xdp_session_connect_to_eis_async  (XdpSession           *session,
+                                             GCancellable         *cancellable,
+                                             GAsyncReadyCallback   callback,
+                                             gpointer              data);
+
+XDP_PUBLIC
+int       xdp_session_connect_to_eis_finish (XdpSession           *session,
+                                             GAsyncResult         *result,
+                                             GError              **error);
+
 XDP_PUBLIC
 void      xdp_session_pointer_motion    (XdpSession *session,
                                          double      dx,
@@ -265,6 +287,38 @@ void      xdp_session_keyboard_key   (XdpSession *session,
                                       int         key,
                                       XdpKeyState state);
 
+XDP_PUBLIC
+void      xdp_session_type_text        (XdpSession          *session,
+                                        const char          *text,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_session_type_text_finish (XdpSession          *session,
+                                        GAsyncResult        *result,
+                                        GError             **error);
+
+XDP_PUBLIC
+void      xdp_session_start_recording  (XdpSession          *session);
+
+XDP_PUBLIC
+GBytes   *xdp_session_stop_recording   (XdpSession          *session);
+
+XDP_PUBLIC
+void      xdp_session_replay           (XdpSession          *session,
+                                        GBytes              *recording,
+                                        double               speed,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_session_replay_finish    (XdpSession          *session,
+                                        GAsyncResult        *result,
+                                        guint               *n_events,
+                                        GError             **error);
+
 XDP_PUBLIC
 void      xdp_session_touch_down     (XdpSession *session,
                                       guint       stream,
@@ -284,6 +338,21 @@ void      xdp_session_touch_up       (XdpSession *session,
                                       guint       slot);
 
 
+XDP_PUBLIC
+void      xdp_session_enable_motion_coalescing  (XdpSession *session,
+                                                 guint       interval_ms);
+
+XDP_PUBLIC
+void      xdp_session_disable_motion_coalescing (XdpSession *session);
+
+XDP_PUBLIC
+void      xdp_session_enable_input_thread       (XdpSession *session);
+
+XDP_PUBLIC
+gboolean  xdp_session_enable_eis_input          (XdpSession  *session,
+                                                 int          fd,
+                                                 GError     **error);
+
 XDP_PUBLIC
 XdpPersistMode  xdp_session_get_persist_mode  (XdpSession *session);
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024, Georges Basile Stavracas Neto
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#pragma once
+
+#include <gio/gunixfdlist.h>
+
+#include "portal-private.h"
+
+G_BEGIN_DECLS
+
+/*
+ * XdpRequestResponseFunc:
+ * @task: the task of the request
+ * @results: the results vardict of a successful response
+ *
+ * Turns the results of a successful Request::Response into the
+ * return value of @task. Per-call state can be stored as the task
+ * data of @task.
+ */
+typedef void (* XdpRequestResponseFunc) (GTask    *task,
+                                         GVariant *results);
+
+typedef struct _XdpRequest XdpRequest;
+
+struct _XdpRequest {
+  /* One reference until @task is returned, one while the method
+   * call is in flight */
+  gint ref_count;
+  gboolean finished;
+
+  XdpPortal *portal;
+  XdpParent *parent;
+  char *parent_handle;
+  GTask *task;
+  GCancellable *cancellable;
+  guint cancelled_id;
+  char *request_path;
+
+  /* The method call; the parent handle is prepended to @args, and
+   * @options (with the handle token added) is appended */
+  const char *interface;
+  const char *method;
+  GVariant *args;
+  GUnixFDList *fd_list;
+  GVariantBuilder options;
+  gboolean has_parent_handle;
+
+  XdpRequestResponseFunc response_func;
+};
+
+XdpRequest * _xdp_request_new               (XdpPortal              *portal,
+                                             XdpParent              *parent,
+                                             const char             *interface,
+                                             const char             *method,
+                                             GCancellable           *cancellable,
+                                             GAsyncReadyCallback     callback,
+                                             gpointer                data,
+                                             gpointer                source_tag);
+
+void         _xdp_request_set_args          (XdpRequest             *request,
+                                             GVariant               *args,
+                                             GUnixFDList            *fd_list);
+
+void         _xdp_request_send              (XdpRequest             *request);
+
+void         _xdp_request_return_boolean    (GTask                  *task,
+                                             GVariant               *results);
+
+G_END_DECLS
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2024, Georges Basile Stavracas Neto
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "request-private.h"
+
+/* Most applications have at most a couple of requests in flight, so
+ * a handful of recycled structs covers the common case without ever
+ * holding on to much memory. */
+#define MAX_FREE_REQUESTS 8
+
+G_LOCK_DEFINE_STATIC (free_requests);
+static XdpRequest *free_requests[MAX_FREE_REQUESTS];
+static guint n_free_requests = 0;
+
+static XdpRequest *
+request_alloc (void)
+{
+  XdpRequest *request = NULL;
+
+  G_LOCK (free_requests);
+  if (n_free_requests > 0)
+    request = free_requests[--n_free_requests];
+  G_UNLOCK (free_requests);
+
+  if (request == NULL)
+    request = g_new0 (XdpRequest, 1);
+
+  return request;
+}
+
+static void
+request_free (XdpRequest *request)
+{
+  if (request->parent)
+    {
+      request->parent->parent_unexport (request->parent);
+      xdp_parent_free (request->parent);
+    }
+  g_free (request->parent_handle);
+
+  g_free (request->request_path);
+
+  g_clear_object (&request->cancellable);
+  g_clear_object (&request->fd_list);
+  g_clear_pointer (&request->args, g_variant_unref);
+  g_variant_builder_clear (&request->options);
+
+  g_object_unref (request->portal);
+  g_object_unref (request->task);
+
+  memset (request, 0, sizeof (XdpRequest));
+
+  G_LOCK (free_requests);
+  if (n_free_requests < MAX_FREE_REQUESTS)
+    {
+      free_requests[n_free_requests++] = request;
+      request = NULL;
+    }
+  G_UNLOCK (free_requests);
+
+  g_free (request);
+}
+
+static void
+request_unref (XdpRequest *request)
+{
+  if (g_atomic_int_dec_and_test (&request->ref_count))
+    request_free (request);
+}
+
+/* Called once the task has been returned; stops listening for the
+ * response and for cancellation. The method call may still be in
+ * flight, in which case call_returned() drops the last reference. */
+static void
+request_finish (XdpRequest *request)
+{
+  if (request->finished)
+    return;
+
+  request->finished = TRUE;
+
+  if (request->cancelled_id)
+    {
+      g_signal_handler_disconnect (request->cancellable, request->cancelled_id);
+      request->cancelled_id = 0;
+    }
+
+  _xdp_portal_unregister_request (request->portal, request->request_path);
+
+  request_unref (request);
+}
+
+static void
+response_received (GDBusConnection *bus,
+                   const char *sender_name,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *signal_name,
+                   GVariant *parameters,
+                   gpointer data)
+{
+  XdpRequest *request = data;
+  guint32 response;
+  g_autoptr(GVariant) ret = NULL;
+
+  if (request->finished)
+    return;
+
+  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
+
+  if (response == 0)
+    {
+      if (request->response_func)
+        request->response_func (request->task, ret);
+      else
+        g_task_return_pointer (request->task, g_variant_ref (ret), (GDestroyNotify)g_variant_unref);
+    }
+  else if (response == 1)
+    g_task_return_new_error (request->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "%s canceled", request->method);
+  else
+    g_task_return_new_error (request->task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s failed", request->method);
+
+  request_finish (request);
+}
+
+static void
+parent_exported (XdpParent *parent,
+                 const char *handle,
+                 gpointer data)
+{
+  XdpRequest *request = data;
+  request->parent_handle = g_strdup (handle);
+  _xdp_request_send (request);
+}
+
+static void
+cancelled_cb (GCancellable *cancellable,
+              gpointer data)
+{
+  XdpRequest *request = data;
+
+  if (request->finished)
+    return;
+
+  g_dbus_connection_call (_xdp_portal_get_bus (request->portal),
+                          PORTAL_BUS_NAME,
+                          request->request_path,
+                          REQUEST_INTERFACE,
+                          "Close",
+                          NULL,
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL, NULL, NULL);
+
+  g_task_return_new_error (request->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "%s call canceled by caller", request->method);
+
+  request_finish (request);
+}
+
+static void
+call_returned (GObject *object,
+               GAsyncResult *result,
+               gpointer data)
+{
+  XdpRequest *request = data;
+  GError *error = NULL;
+  g_autoptr(GVariant) ret = NULL;
+
+  ret = g_dbus_connection_call_with_unix_fd_list_finish (G_DBUS_CONNECTION (object), NULL, result, &error);
+  if (error)
+    {
+      if (!request->finished)
+        {
+          g_task_return_error (request->task, error);
+          request_finish (request);
+        }
+      else
+        g_error_free (error);
+    }
+
+  /* The reference held by the method call */
+  request_unref (request);
+}
+
+/*
+ * _xdp_request_new:
+ *
+ * Creates a request for @method on the portal @interface. Callers add
+ * their options to the options builder, set any positional arguments
+ * with _xdp_request_set_args() and then call _xdp_request_send(). The
+ * request frees itself once it has returned @task and the method call
+ * has returned.
+ *
+ * Without a @response_func, the results vardict of the response is
+ * returned as a [struct@GLib.Variant].
+ */
+XdpRequest *
+_xdp_request_new (XdpPortal           *portal,
+                  XdpParent           *parent,
+                  const char          *interface,
+                  const char          *method,
+                  GCancellable        *cancellable,
+                  GAsyncReadyCallback  callback,
+                  gpointer             data,
+                  gpointer             source_tag)
+{
+  XdpRequest *request;
+
+  request = request_alloc ();
+  request->ref_count = 1;
+  request->portal = g_object_ref (portal);
+  if (parent)
+    request->parent = xdp_parent_copy (parent);
+  else
+    request->parent_handle = g_strdup ("");
+  request->has_parent_handle = TRUE;
+  request->interface = interface;
+  request->method = method;
+  if (cancellable)
+    request->cancellable = g_object_ref (cancellable);
+  request->task = g_task_new (portal, cancellable, callback, data);
+  g_task_set_source_tag (request->task, source_tag);
+
+  g_variant_builder_init (&request->options, G_VARIANT_TYPE_VARDICT);
+
+  return request;
+}
+
+/*
+ * _xdp_request_set_args:
+ * @args: (nullable): a tuple with the arguments that go between the
+ *   parent handle and the options
+ * @fd_list: (nullable): file descriptors referenced by @args
+ */
+void
+_xdp_request_set_args (XdpRequest  *request,
+                       GVariant    *args,
+                       GUnixFDList *fd_list)
+{
+  g_clear_pointer (&request->args, g_variant_unref);
+  g_clear_object (&request->fd_list);
+
+  if (args)
+    request->args = g_variant_ref_sink (args);
+  if (fd_list)
+    request->fd_list = g_object_ref (fd_list);
+}
+
+void
+_xdp_request_send (XdpRequest *request)
+{
+  GVariantBuilder parameters;
+  g_autofree char *token = NULL;
+  GVariantIter iter;
+  GVariant *arg;
+
+  if (request->parent_handle == NULL)
+    {
+      request->parent->parent_export (request->parent, parent_exported, request);
+      return;
+    }
+
+  token = _xdp_portal_new_token (request->portal);
+  request->request_path = g_strconcat (REQUEST_PATH_PREFIX, _xdp_portal_get_sender (request->portal), "/", token, NULL);
+  _xdp_portal_register_request (request->portal, request->request_path, response_received, request);
+
+  if (request->cancellable)
+    request->cancelled_id = g_signal_connect (request->cancellable, "cancelled", G_CALLBACK (cancelled_cb), request);
+
+  g_variant_builder_add (&request->options, "{sv}", "handle_token", g_variant_new_string (token));
+
+  g_variant_builder_init (&parameters, G_VARIANT_TYPE_TUPLE);
+  if (request->has_parent_handle)
+    g_variant_builder_add (&parameters, "s", request->parent_handle);
+  if (request->args)
+    {
+      g_variant_iter_init (&iter, request->args);
+      while ((arg = g_variant_iter_next_value (&iter)))
+        {
+          g_variant_builder_add_value (&parameters, arg);
+          g_variant_unref (arg);
+        }
+    }
+  g_variant_builder_add_value (&parameters, g_variant_builder_end (&request->options));
+
+  g_dbus_connection_call_with_unix_fd_list (_xdp_portal_get_bus (request->portal),
+                                            PORTAL_BUS_NAME,
+                                            PORTAL_OBJECT_PATH,
+                                            request->interface,
+                                            request->method,
+                                            g_variant_builder_end (&parameters),
+                                            NULL,
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1,
+                                            request->fd_list,
+                                            NULL,
+                                            call_returned,
+                                            request);
+  g_atomic_int_inc (&request->ref_count);
+}
+
+/*
+ * _xdp_request_return_boolean:
+ *
+ * A response func for requests that only report success.
+ */
+void
+_xdp_request_return_boolean (GTask    *task,
+                             GVariant *results)
+{
+  g_task_return_boolean (task, TRUE);
+}
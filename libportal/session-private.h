@@ -22,6 +22,10 @@
 #include <libportal/remote.h>
 #include <libportal/inputcapture.h>
 
+#include "eis-sender-private.h"
+#include "input-recording-private.h"
+#include "input-thread-private.h"
+
 struct _XdpSession {
   GObject parent_instance;
 
@@ -42,6 +46,23 @@ struct _XdpSession {
 
   gboolean uses_eis;
 
+  /* Pointer motion coalescing, see xdp_session_enable_motion_coalescing() */
+  gboolean coalesce_motion;
+  guint coalesce_interval;
+  GArray *pending_motion; /* InputEvent */
+  GSource *motion_source;
+
+  /* Sends input events, see xdp_session_enable_input_thread() */
+  XdpInputThread *input_thread;
+
+  /* Sends input events over EIS, see xdp_session_enable_eis_input() */
+  XdpEisSender *eis_sender;
+
+  /* See xdp_session_start_recording(); events may be recorded from
+   * any thread, so @recorder is only used with @recorder_lock held */
+  GMutex recorder_lock;
+  XdpInputRecorder *recorder;
+
   /* InputCapture */
   XdpInputCaptureSession *input_capture_session; /* weak ref */
 };
@@ -60,3 +81,8 @@ void         _xdp_session_set_streams (XdpSession *session,
                                        GVariant   *streams);
 
 void         _xdp_session_close (XdpSession *session);
+
+void         _xdp_session_flush_motion (XdpSession *session);
+
+void         _xdp_session_handle_event (XdpSession       *session,
+                                        const InputEvent *event);
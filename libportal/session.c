@@ -51,8 +51,16 @@ xdp_session_finalize (GObject *object)
 {
   XdpSession *session = XDP_SESSION (object);
 
-  if (session->signal_id)
-    g_dbus_connection_signal_unsubscribe (session->portal->bus, session->signal_id);
+  g_clear_pointer (&session->input_thread, _xdp_input_thread_free);
+  if (session->motion_source)
+    g_source_destroy (session->motion_source);
+  g_clear_pointer (&session->motion_source, g_source_unref);
+  g_clear_pointer (&session->pending_motion, g_array_unref);
+  g_clear_pointer (&session->eis_sender, _xdp_eis_sender_free);
+  g_clear_pointer (&session->recorder, _xdp_input_recorder_free);
+  g_mutex_clear (&session->recorder_lock);
+
+  _xdp_portal_unsubscribe_session_signal (session->portal, session->signal_id);
 
   g_clear_object (&session->portal);
   g_clear_pointer (&session->restore_token, g_free);
@@ -90,6 +98,7 @@ xdp_session_class_init (XdpSessionClass *klass)
 static void
 xdp_session_init (XdpSession *session)
 {
+  g_mutex_init (&session->recorder_lock);
 }
 
 static void
@@ -120,16 +129,12 @@ _xdp_session_new (XdpPortal *portal,
   session->state = XDP_SESSION_INITIAL;
   session->input_capture_session = NULL;
 
-  session->signal_id = g_dbus_connection_signal_subscribe (portal->bus,
-                                                           PORTAL_BUS_NAME,
-                                                           SESSION_INTERFACE,
-                                                           "Closed",
-                                                           id,
-                                                           NULL,
-                                                           G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                           session_closed,
-                                                           session,
-                                                           NULL);
+  session->signal_id = _xdp_portal_subscribe_session_signal (portal,
+                                                             SESSION_INTERFACE,
+                                                             "Closed",
+                                                             id,
+                                                             session_closed,
+                                                             session);
   return session;
 }
 
@@ -171,7 +176,14 @@ xdp_session_close (XdpSession *session)
 {
   g_return_if_fail (XDP_IS_SESSION (session));
 
-  g_dbus_connection_call (session->portal->bus,
+  /* Stopping the input thread sends the events it still has */
+  if (session->input_thread)
+    g_clear_pointer (&session->input_thread, _xdp_input_thread_free);
+  else
+    _xdp_session_flush_motion (session);
+  g_clear_pointer (&session->eis_sender, _xdp_eis_sender_free);
+
+  g_dbus_connection_call (_xdp_portal_get_bus (session->portal),
                           PORTAL_BUS_NAME,
                           session->id,
                           SESSION_INTERFACE,
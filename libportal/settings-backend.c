@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#define G_SETTINGS_ENABLE_BACKEND
+#include <gio/gsettingsbackend.h>
+
+#include "settings-private.h"
+
+/*
+ * XdpSettingsBackend:
+ *
+ * A read-only [class@Gio.SettingsBackend] on top of the settings
+ * portal. GSettings paths map to portal namespaces by replacing the
+ * slashes of the directory with dots, so the key
+ * `/org/gnome/desktop/interface/gtk-theme` is `gtk-theme` within
+ * `org.gnome.desktop.interface`.
+ *
+ * Each namespace is loaded into the settings cache with one ReadAll on
+ * first use; after that, lookups don't touch the bus. Namespaces that
+ * GSettings subscribes to are watched, so their change notifications
+ * are forwarded as GSettings change notifications.
+ */
+
+#define XDP_TYPE_SETTINGS_BACKEND (xdp_settings_backend_get_type ())
+G_DECLARE_FINAL_TYPE (XdpSettingsBackend, xdp_settings_backend, XDP, SETTINGS_BACKEND, GSettingsBackend)
+
+struct _XdpSettingsBackend {
+  GSettingsBackend parent_instance;
+
+  XdpSettings *settings;
+  gulong changed_id;
+
+  GMutex lock;
+  GHashTable *loaded_namespaces;
+  GHashTable *failed_namespaces;
+  GHashTable *watches; /* namespace → SubscribedNamespace */
+};
+
+typedef struct {
+  guint watch_id;
+  guint n_subscriptions;
+} SubscribedNamespace;
+
+G_DEFINE_TYPE (XdpSettingsBackend, xdp_settings_backend, G_TYPE_SETTINGS_BACKEND)
+
+/* "/org/gnome/desktop/interface/" → "org.gnome.desktop.interface" */
+static char *
+dir_to_namespace (const char *dir,
+                  gsize       len)
+{
+  char *namespace;
+  gsize i;
+
+  if (len < 2 || dir[0] != '/')
+    return NULL;
+
+  namespace = g_strndup (dir + 1, len - 1);
+  for (i = 0; namespace[i]; i++)
+    {
+      if (namespace[i] == '/')
+        namespace[i] = '.';
+    }
+
+  return namespace;
+}
+
+static gboolean
+split_key (const char  *path,
+           char       **namespace,
+           const char **key)
+{
+  const char *slash;
+
+  slash = strrchr (path, '/');
+  if (slash == NULL || slash[1] == '\0')
+    return FALSE;
+
+  *namespace = dir_to_namespace (path, slash - path);
+  *key = slash + 1;
+
+  return *namespace != NULL;
+}
+
+/* Returns %FALSE if @namespace couldn't be loaded. That isn't retried;
+ * a missing portal would otherwise cost a timeout per lookup, and
+ * GSettings falls back to the schema defaults */
+static gboolean
+ensure_namespace_loaded (XdpSettingsBackend *self,
+                         const char         *namespace)
+{
+  const char *namespaces[] = { namespace, NULL };
+  g_autoptr(GError) error = NULL;
+  gboolean loaded;
+  gboolean failed;
+
+  g_mutex_lock (&self->lock);
+  loaded = !g_hash_table_add (self->loaded_namespaces, g_strdup (namespace));
+  failed = g_hash_table_contains (self->failed_namespaces, namespace);
+  g_mutex_unlock (&self->lock);
+
+  if (loaded)
+    return !failed;
+
+  if (!xdp_settings_enable_cache (self->settings, namespaces, NULL, &error))
+    {
+      g_debug ("Failed to load settings namespace %s: %s", namespace, error->message);
+
+      g_mutex_lock (&self->lock);
+      g_hash_table_add (self->failed_namespaces, g_strdup (namespace));
+      g_mutex_unlock (&self->lock);
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GVariant *
+xdp_settings_backend_read (GSettingsBackend   *backend,
+                           const char         *path,
+                           const GVariantType *expected_type,
+                           gboolean            default_value)
+{
+  XdpSettingsBackend *self = XDP_SETTINGS_BACKEND (backend);
+  g_autofree char *namespace = NULL;
+  g_autoptr(GVariant) value = NULL;
+  const char *key;
+
+  /* The portal has no defaults of its own */
+  if (default_value)
+    return NULL;
+
+  if (!split_key (path, &namespace, &key))
+    return NULL;
+
+  if (!ensure_namespace_loaded (self, namespace))
+    return NULL;
+
+  value = xdp_settings_read_value (self->settings, namespace, key, NULL, NULL);
+  if (value == NULL)
+    return NULL;
+
+  if (!g_variant_is_of_type (value, expected_type))
+    {
+      g_debug ("Setting %s has type %s, expected %.*s",
+               path, g_variant_get_type_string (value),
+               (int) g_variant_type_get_string_length (expected_type),
+               g_variant_type_peek_string (expected_type));
+      return NULL;
+    }
+
+  return g_steal_pointer (&value);
+}
+
+static gboolean
+xdp_settings_backend_write (GSettingsBackend *backend,
+                            const char       *path,
+                            GVariant         *value,
+                            gpointer          origin_tag)
+{
+  g_variant_ref_sink (value);
+  g_variant_unref (value);
+
+  return FALSE;
+}
+
+static gboolean
+xdp_settings_backend_write_tree (GSettingsBackend *backend,
+                                 GTree            *tree,
+                                 gpointer          origin_tag)
+{
+  return FALSE;
+}
+
+static void
+xdp_settings_backend_reset (GSettingsBackend *backend,
+                            const char       *path,
+                            gpointer          origin_tag)
+{
+}
+
+static gboolean
+xdp_settings_backend_get_writable (GSettingsBackend *backend,
+                                   const char       *path)
+{
+  return FALSE;
+}
+
+static GPermission *
+xdp_settings_backend_get_permission (GSettingsBackend *backend,
+                                     const char       *path)
+{
+  return g_simple_permission_new (FALSE);
+}
+
+static void
+xdp_settings_backend_subscribe (GSettingsBackend *backend,
+                                const char       *name)
+{
+  XdpSettingsBackend *self = XDP_SETTINGS_BACKEND (backend);
+  g_autofree char *namespace = NULL;
+  SubscribedNamespace *subscribed;
+
+  namespace = dir_to_namespace (name, strlen (name) - 1);
+  if (namespace == NULL)
+    return;
+
+  g_mutex_lock (&self->lock);
+
+  subscribed = g_hash_table_lookup (self->watches, namespace);
+  if (subscribed == NULL)
+    {
+      subscribed = g_new0 (SubscribedNamespace, 1);
+      subscribed->watch_id = xdp_settings_watch (self->settings, namespace, NULL);
+      g_hash_table_insert (self->watches, g_steal_pointer (&namespace), subscribed);
+    }
+  subscribed->n_subscriptions++;
+
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+xdp_settings_backend_unsubscribe (GSettingsBackend *backend,
+                                  const char       *name)
+{
+  XdpSettingsBackend *self = XDP_SETTINGS_BACKEND (backend);
+  g_autofree char *namespace = NULL;
+  SubscribedNamespace *subscribed;
+
+  namespace = dir_to_namespace (name, strlen (name) - 1);
+  if (namespace == NULL)
+    return;
+
+  g_mutex_lock (&self->lock);
+
+  subscribed = g_hash_table_lookup (self->watches, namespace);
+  if (subscribed && --subscribed->n_subscriptions == 0)
+    {
+      xdp_settings_unwatch (self->settings, subscribed->watch_id);
+      g_hash_table_remove (self->watches, namespace);
+    }
+
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+settings_changed (XdpSettings *settings,
+                  const char  *namespace,
+                  const char  *key,
+                  GVariant    *value,
+                  gpointer     data)
+{
+  XdpSettingsBackend *self = data;
+  g_autofree char *path = NULL;
+  gsize len = strlen (namespace);
+  gsize i;
+
+  path = g_strconcat ("/", namespace, "/", key, NULL);
+  for (i = 1; i <= len; i++)
+    {
+      if (path[i] == '.')
+        path[i] = '/';
+    }
+
+  g_settings_backend_changed (G_SETTINGS_BACKEND (self), path, NULL);
+}
+
+static void
+xdp_settings_backend_finalize (GObject *object)
+{
+  XdpSettingsBackend *self = XDP_SETTINGS_BACKEND (object);
+
+  if (self->changed_id)
+    g_signal_handler_disconnect (self->settings, self->changed_id);
+  g_clear_object (&self->settings);
+
+  g_clear_pointer (&self->loaded_namespaces, g_hash_table_unref);
+  g_clear_pointer (&self->failed_namespaces, g_hash_table_unref);
+  g_clear_pointer (&self->watches, g_hash_table_unref);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (xdp_settings_backend_parent_class)->finalize (object);
+}
+
+static void
+xdp_settings_backend_class_init (XdpSettingsBackendClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GSettingsBackendClass *backend_class = G_SETTINGS_BACKEND_CLASS (klass);
+
+  object_class->finalize = xdp_settings_backend_finalize;
+
+  backend_class->read = xdp_settings_backend_read;
+  backend_class->write = xdp_settings_backend_write;
+  backend_class->write_tree = xdp_settings_backend_write_tree;
+  backend_class->reset = xdp_settings_backend_reset;
+  backend_class->get_writable = xdp_settings_backend_get_writable;
+  backend_class->get_permission = xdp_settings_backend_get_permission;
+  backend_class->subscribe = xdp_settings_backend_subscribe;
+  backend_class->unsubscribe = xdp_settings_backend_unsubscribe;
+}
+
+static void
+xdp_settings_backend_init (XdpSettingsBackend *self)
+{
+  g_mutex_init (&self->lock);
+  self->loaded_namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->failed_namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->watches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+GSettingsBackend *
+_xdp_settings_backend_new (XdpPortal *portal)
+{
+  XdpSettingsBackend *self;
+
+  self = g_object_new (XDP_TYPE_SETTINGS_BACKEND, NULL);
+
+  /* A settings object of our own, since watches change which
+   * notifications it reports */
+  self->settings = _xdp_settings_new (portal);
+  self->changed_id = g_signal_connect (self->settings, "changed",
+                                       G_CALLBACK (settings_changed), self);
+
+  return G_SETTINGS_BACKEND (self);
+}
@@ -25,9 +25,22 @@
 #include <libportal/types.h>
 
 #include "settings.h"
+#include "portal-private.h"
 
 G_BEGIN_DECLS
 
 XdpSettings * _xdp_settings_new (XdpPortal *portal);
 
+void _xdp_settings_cache_free (XdpSettingsCache *cache);
+
+void _xdp_settings_cache_name_owner_changed (XdpSettingsCache *cache,
+                                             const char       *new_owner);
+
+GSettingsBackend * _xdp_settings_backend_new (XdpPortal *portal);
+
+GVariant * _xdp_settings_snapshot_load (void);
+
+gboolean   _xdp_settings_snapshot_save (GVariant  *values,
+                                        GError   **error);
+
 G_END_DECLS
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+#include "config.h"
+
+#include <errno.h>
+
+#include "settings-private.h"
+
+/*
+ * The snapshot is a serialized (ua{sa{sv}}) GVariant: a format version,
+ * followed by the values in the shape ReadAll returns them. Loading maps
+ * the file and reads the values in place. The file lives in the user
+ * cache directory, which is private to the application when sandboxed.
+ */
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_TYPE G_VARIANT_TYPE ("(ua{sa{sv}})")
+
+static char *
+snapshot_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "libportal", "settings.snapshot", NULL);
+}
+
+/*
+ * _xdp_settings_snapshot_load:
+ *
+ * Returns: (transfer full) (nullable): the a{sa{sv}} of the snapshot, or
+ *   %NULL if there is no usable snapshot
+ */
+GVariant *
+_xdp_settings_snapshot_load (void)
+{
+  g_autofree char *path = snapshot_path ();
+  g_autoptr(GMappedFile) mapped = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GVariant) snapshot = NULL;
+  g_autoptr(GVariant) values = NULL;
+  guint32 version;
+
+  mapped = g_mapped_file_new (path, FALSE, NULL);
+  if (mapped == NULL)
+    return NULL;
+
+  /* Values keep the mapping alive for as long as they are cached */
+  bytes = g_mapped_file_get_bytes (mapped);
+  snapshot = g_variant_ref_sink (g_variant_new_from_bytes (SNAPSHOT_TYPE, bytes, FALSE));
+
+  g_variant_get (snapshot, "(u@a{sa{sv}})", &version, &values);
+  if (version != SNAPSHOT_VERSION)
+    {
+      g_debug ("Ignoring settings snapshot with version %u", version);
+      return NULL;
+    }
+
+  return g_steal_pointer (&values);
+}
+
+/*
+ * _xdp_settings_snapshot_save:
+ * @values: the a{sa{sv}} to store
+ *
+ * Atomically replaces the snapshot with @values.
+ */
+gboolean
+_xdp_settings_snapshot_save (GVariant  *values,
+                             GError   **error)
+{
+  g_autofree char *path = snapshot_path ();
+  g_autofree char *dir = g_path_get_dirname (path);
+  g_autoptr(GVariant) snapshot = NULL;
+
+  if (g_mkdir_with_parents (dir, 0700) != 0)
+    {
+      int errsv = errno;
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to create %s: %s", dir, g_strerror (errsv));
+      return FALSE;
+    }
+
+  snapshot = g_variant_ref_sink (g_variant_new ("(u@a{sa{sv}})", SNAPSHOT_VERSION, values));
+
+  return g_file_set_contents (path,
+                              g_variant_get_data (snapshot),
+                              g_variant_get_size (snapshot),
+                              error);
+}
@@ -22,10 +22,13 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "portal.h"
 #include "settings.h"
 
 #include "portal-private.h"
+#include "settings-private.h"
 
 /**
  * XdpSettings
@@ -38,57 +41,281 @@
  * It is obtained from [method@Portal.get_settings]. Call
  * [method@Settings.read_value] to read a settings value. Connect to
  * [signal@Settings::changed] to observe value changes.
+ *
+ * Reads normally go to the portal. After
+ * [method@Settings.enable_cache] has loaded a set of namespaces, reads
+ * within those namespaces are answered from memory, and the cached
+ * values are kept current from the change notifications of the portal.
+ * All [class@Settings] objects of a [class@Portal] share that cache.
  */
 struct _XdpSettings {
   GObject parent_instance;
 
   XdpPortal *portal;
+
+  /* Once watches are installed, only watched settings are reported */
+  gboolean watched;
+  GList *watches;
+
+  /* changed-batch */
+  gboolean batching;
+  guint batch_window;
+  GSource *batch_source;
+  GHashTable *batch; /* namespace → (key → GVariant) */
+};
+
+typedef struct {
+  XdpSettings *settings; /* unowned */
+  char *namespace;
+  char *key;
+  char *match_rule;
   guint signal_id;
+} SettingsWatch;
+
+#define APPEARANCE_NAMESPACE "org.freedesktop.appearance"
+
+/* The well-known keys of org.freedesktop.appearance, decoded */
+typedef struct {
+  XdpColorScheme color_scheme;
+  gboolean has_accent_color;
+  double accent_color[3];
+  XdpContrast contrast;
+  XdpReducedMotion reduced_motion;
+} Appearance;
 
+/* Shared by all XdpSettings instances of a portal, so that there is a
+ * single copy of the values and a single SettingChanged subscription.
+ * Unwatched settings objects and the cached namespaces all share it. */
+struct _XdpSettingsCache {
+  XdpPortal *portal; /* unowned, owns us */
+  GList *instances; /* unowned XdpSettings */
+
+  guint all_signal_id;
+  guint all_users;
+  gboolean caching; /* holds one of all_users */
+
+  GMutex lock;
+  GPtrArray *namespaces; /* patterns loaded with ReadAll */
+  GHashTable *values; /* namespace → (key → GVariant) */
+
+  /* Patterns kept in the on-disk snapshot, see settings-snapshot.c */
+  GPtrArray *snapshot_namespaces;
+  GSource *snapshot_source;
+
+  /* Valid once the appearance namespace is cached */
+  gboolean appearance_loaded;
+  Appearance appearance;
+
+  /* Set when loading the appearance failed, so that the getters serve
+   * the defaults instead of blocking again; see cache_retry_appearance() */
+  gboolean appearance_failed;
+  gboolean appearance_retrying;
 };
 
 enum {
   CHANGED,
+  CHANGED_BATCH,
   LAST_SIGNAL
 };
 
 static guint signals[LAST_SIGNAL];
 
+enum {
+  PROP_0,
+
+  PROP_COLOR_SCHEME,
+  PROP_ACCENT_COLOR,
+  PROP_CONTRAST,
+  PROP_REDUCED_MOTION,
+
+  N_PROPERTIES
+};
+
+static GParamSpec *properties[N_PROPERTIES] = { NULL, };
+
 G_DEFINE_TYPE (XdpSettings, xdp_settings, G_TYPE_OBJECT)
 
+static void cache_acquire_all         (XdpSettingsCache *cache);
+static void cache_retry_appearance    (XdpSettingsCache *cache);
+static void cache_release_all         (XdpSettingsCache *cache);
+static void cache_schedule_snapshot   (XdpSettingsCache *cache);
+static void cache_begin_loading       (XdpSettingsCache *cache);
+
 static void
 xdp_settings_finalize (GObject *object)
 {
   XdpSettings *settings = XDP_SETTINGS (object);
 
-  if (settings->signal_id)
-    g_dbus_connection_signal_unsubscribe (settings->portal->bus, settings->signal_id);
+  if (settings->portal)
+    {
+      XdpSettingsCache *cache = settings->portal->settings_cache;
+
+      while (settings->watches)
+        {
+          SettingsWatch *watch = settings->watches->data;
+          xdp_settings_unwatch (settings, watch->signal_id);
+        }
+
+      if (!settings->watched)
+        cache_release_all (cache);
+
+      cache->instances = g_list_remove (cache->instances, settings);
+    }
+
+  if (settings->batch_source)
+    g_source_destroy (settings->batch_source);
+  g_clear_pointer (&settings->batch_source, g_source_unref);
+  g_clear_pointer (&settings->batch, g_hash_table_unref);
 
   g_clear_object (&settings->portal);
 
   G_OBJECT_CLASS (xdp_settings_parent_class)->finalize (object);
 }
 
+static void
+xdp_settings_get_property (GObject    *object,
+                           guint       prop_id,
+                           GValue     *value,
+                           GParamSpec *pspec)
+{
+  XdpSettings *settings = XDP_SETTINGS (object);
+  double rgb[3];
+
+  switch (prop_id)
+    {
+    case PROP_COLOR_SCHEME:
+      g_value_set_enum (value, xdp_settings_get_color_scheme (settings));
+      break;
+
+    case PROP_ACCENT_COLOR:
+      if (xdp_settings_get_accent_color (settings, &rgb[0], &rgb[1], &rgb[2]))
+        g_value_set_variant (value, g_variant_new ("(ddd)", rgb[0], rgb[1], rgb[2]));
+      else
+        g_value_set_variant (value, NULL);
+      break;
+
+    case PROP_CONTRAST:
+      g_value_set_enum (value, xdp_settings_get_contrast (settings));
+      break;
+
+    case PROP_REDUCED_MOTION:
+      g_value_set_enum (value, xdp_settings_get_reduced_motion (settings));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
 static void
 xdp_settings_class_init (XdpSettingsClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->finalize = xdp_settings_finalize;
+  object_class->get_property = xdp_settings_get_property;
+
+  /**
+   * XdpSettings:color-scheme:
+   *
+   * The color scheme the user prefers.
+   *
+   * Reading this property can block, see
+   * [method@Settings.get_color_scheme].
+   *
+   * Since: 0.9
+   */
+  properties[PROP_COLOR_SCHEME] =
+    g_param_spec_enum ("color-scheme",
+                       "Color scheme",
+                       "The color scheme the user prefers",
+                       XDP_TYPE_COLOR_SCHEME,
+                       XDP_COLOR_SCHEME_NO_PREFERENCE,
+                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * XdpSettings:accent-color:
+   *
+   * The accent color the user prefers, as a `(ddd)` [struct@GLib.Variant]
+   * of red, green and blue in the range [0, 1], or %NULL if the user
+   * has no preference.
+   *
+   * Reading this property can block, see
+   * [method@Settings.get_color_scheme].
+   *
+   * Since: 0.9
+   */
+  properties[PROP_ACCENT_COLOR] =
+    g_param_spec_variant ("accent-color",
+                          "Accent color",
+                          "The accent color the user prefers",
+                          G_VARIANT_TYPE ("(ddd)"),
+                          NULL,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * XdpSettings:contrast:
+   *
+   * The contrast the user prefers.
+   *
+   * Reading this property can block, see
+   * [method@Settings.get_color_scheme].
+   *
+   * Since: 0.9
+   */
+  properties[PROP_CONTRAST] =
+    g_param_spec_enum ("contrast",
+                       "Contrast",
+                       "The contrast the user prefers",
+                       XDP_TYPE_CONTRAST,
+                       XDP_CONTRAST_NO_PREFERENCE,
+                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * XdpSettings:reduced-motion:
+   *
+   * Whether the user prefers reduced motion.
+   *
+   * Reading this property can block, see
+   * [method@Settings.get_color_scheme].
+   *
+   * Since: 0.9
+   */
+  properties[PROP_REDUCED_MOTION] =
+    g_param_spec_enum ("reduced-motion",
+                       "Reduced motion",
+                       "Whether the user prefers reduced motion",
+                       XDP_TYPE_REDUCED_MOTION,
+                       XDP_REDUCED_MOTION_NO_PREFERENCE,
+                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (object_class, N_PROPERTIES, properties);
 
   /**
    * XdpSettings::changed:
    * @settings: the [class@Settings] object
    * @namespace: the value namespace
    * @key: the value key
-   * @value: the value
+   * @value: (nullable): the value, or %NULL if the setting no longer
+   *   exists
    *
    * Emitted when a setting value is changed externally.
+   *
+   * The value is only %NULL when revalidating a snapshot, see
+   * [method@Settings.enable_cache_from_snapshot], finds that the portal
+   * dropped a setting.
+   *
+   * The signal detail is the namespace and key of the setting, joined
+   * with a dot, so handlers can be connected for a single setting, e.g.
+   * `changed::org.freedesktop.appearance.color-scheme`.
+   *
+   * If watches were installed with [method@Settings.watch], the signal
+   * is only emitted for watched settings.
    */
   signals[CHANGED] =
     g_signal_new ("changed",
                   G_TYPE_FROM_CLASS (object_class),
-                  G_SIGNAL_RUN_FIRST,
+                  G_SIGNAL_RUN_FIRST | G_SIGNAL_DETAILED,
                   0,
                   NULL, NULL,
                   NULL,
@@ -96,6 +323,31 @@ xdp_settings_class_init (XdpSettingsClass *klass)
                   G_TYPE_STRING,
                   G_TYPE_STRING,
                   G_TYPE_VARIANT);
+
+  /**
+   * XdpSettings::changed-batch:
+   * @settings: the [class@Settings] object
+   * @changes: a `a{sa{sv}}` [struct@GLib.Variant] with the changed
+   *   values, grouped by namespace
+   *
+   * Emitted once for a burst of setting changes, after
+   * [method@Settings.enable_batching] was called.
+   *
+   * Each setting appears in @changes once, with its latest value. The
+   * same changes are also reported individually through
+   * [signal@Settings::changed].
+   *
+   * Since: 0.9
+   */
+  signals[CHANGED_BATCH] =
+    g_signal_new ("changed-batch",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 1,
+                  G_TYPE_VARIANT);
 }
 
 static void
@@ -103,219 +355,2351 @@ xdp_settings_init (XdpSettings *settings)
 {
 }
 
-static void
-settings_changed (GDBusConnection *bus,
-		  const char *sender_name,
-		  const char *object_path,
-		  const char *interface_name,
-		  const char *signal_name,
-		  GVariant *parameters,
-		  gpointer data)
+/* Whether the ReadAll namespace @pattern covers @namespace, which may
+ * itself be a pattern. An empty pattern matches everything, and a
+ * trailing '*' matches any suffix. */
+static gboolean
+namespace_matches (const char *pattern,
+                   const char *namespace)
 {
-  const char *namespace = NULL;
-  const char *key = NULL;
-  g_autoptr(GVariant) value = NULL;
-  guint n_params;
+  size_t len = strlen (pattern);
 
-  XdpSettings *settings = data;
-
-  n_params = g_variant_n_children (parameters);
-  if (n_params != 3)
-    {
-      g_warning ("Incorrect number of parameters, expected 3, got %u", n_params);
-      return;
-    }
+  if (len == 0)
+    return TRUE;
 
-  g_variant_get_child (parameters, 0, "&s", &namespace);
-  g_variant_get_child (parameters, 1, "&s", &key);
-  g_variant_get_child (parameters, 2, "v", &value);
+  if (pattern[len - 1] == '*')
+    return strncmp (namespace, pattern, len - 1) == 0;
 
-  g_signal_emit (settings, signals[CHANGED], 0, namespace, key, value);
+  return strcmp (namespace, pattern) == 0;
 }
 
-/**
- * xdp_settings_read_uint:
- * @settings: the [class@Settings] object.
- * @namespace: the namespace of the value.
- * @key: the key of the value.
- * @cancellable: a GCancellable or NULL.
- * @error: return location for error or NULL.
- *
- * Read a setting value as unsigned int within @namespace, with @key.
- *
- * Returns: the uint value, or 0 if not found or not
- * the right type. If @error is not NULL, then the error is returned.
- */
-guint32
-xdp_settings_read_uint (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+/* Must be called with the cache lock held */
+static gboolean
+namespace_is_cached (XdpSettingsCache *cache,
+                     const char       *namespace)
 {
-  g_autoptr(GVariant) value = NULL;
+  guint i;
 
-  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
-  if (value)
+  for (i = 0; i < cache->namespaces->len; i++)
     {
-      if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32))
-        return g_variant_get_uint32 (value);
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Value doesn't contain an integer.");
+      if (namespace_matches (g_ptr_array_index (cache->namespaces, i), namespace))
+        return TRUE;
     }
 
-  return 0;
+  return FALSE;
 }
 
-/**
- * xdp_settings_read_string:
- * @settings: the [class@Settings] object.
- * @namespace: the namespace of the value.
- * @key: the key of the value.
- * @cancellable: a GCancellable or NULL.
- * @error: return location for error or NULL.
- *
- * Read a setting value as unsigned int within @namespace, with @key.
- *
- * Returns: (transfer full): the stringint value, or NULL if not found or not
- * the right type. If @error is not NULL, then the error is returned.
- */
-char *
-xdp_settings_read_string (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+static void
+appearance_reset (Appearance *appearance)
 {
-  g_autoptr(GVariant) value = NULL;
+  memset (appearance, 0, sizeof (Appearance));
+}
 
-  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
-  if (value)
+static void
+appearance_update (Appearance *appearance,
+                   const char *key,
+                   GVariant   *value)
+{
+  if (strcmp (key, "color-scheme") == 0)
     {
-      if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
-        return g_variant_dup_string (value, NULL);
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Value doesn't contain a string.");
+      guint32 color_scheme = 0;
+
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32))
+        color_scheme = g_variant_get_uint32 (value);
+      appearance->color_scheme = color_scheme <= XDP_COLOR_SCHEME_PREFER_LIGHT ? color_scheme : XDP_COLOR_SCHEME_NO_PREFERENCE;
     }
+  else if (strcmp (key, "accent-color") == 0)
+    {
+      double r, g, b;
 
-  return NULL;
+      /* Out of range values mean the user has no preference */
+      appearance->has_accent_color = FALSE;
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE ("(ddd)")))
+        {
+          g_variant_get (value, "(ddd)", &r, &g, &b);
+          if (r >= 0.0 && r <= 1.0 && g >= 0.0 && g <= 1.0 && b >= 0.0 && b <= 1.0)
+            {
+              appearance->has_accent_color = TRUE;
+              appearance->accent_color[0] = r;
+              appearance->accent_color[1] = g;
+              appearance->accent_color[2] = b;
+            }
+        }
+    }
+  else if (strcmp (key, "contrast") == 0)
+    {
+      appearance->contrast = XDP_CONTRAST_NO_PREFERENCE;
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32) && g_variant_get_uint32 (value) == 1)
+        appearance->contrast = XDP_CONTRAST_HIGH;
+    }
+  else if (strcmp (key, "reduced-motion") == 0)
+    {
+      appearance->reduced_motion = XDP_REDUCED_MOTION_NO_PREFERENCE;
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32) && g_variant_get_uint32 (value) == 1)
+        appearance->reduced_motion = XDP_REDUCED_MOTION_REDUCED;
+    }
 }
 
-/**
- * xdp_settings_read:
- * @settings: the [class@Settings] object.
- * @namespace: the namespace of the value.
- * @key: the key of the value.
- * @cancellable: a GCancellable or NULL.
- * @error: return location for error or NULL.
- * @format: a #GVariant format string
- * @...: arguments as per @format
- *
- * Read a setting value within @namespace, with @key.
- *
- * A convenience function that combines xdp_settings_read_value() with
- * g_variant_get().
- *
- * In case of error, if @error is not NULL, then the error is
- * returned.
- */
-void
-xdp_settings_read (XdpSettings *settings, const char *namespace, const gchar *key, GCancellable *cancellable, GError **error, const gchar *format, ...)
+/* Must be called with the cache lock held */
+static void
+cache_store (XdpSettingsCache *cache,
+             const char       *namespace,
+             const char       *key,
+             GVariant         *value)
 {
-  g_autoptr(GVariant) value = NULL;
-  va_list ap;
+  GHashTable *keys;
 
-  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
-  if (value)
+  if (strcmp (namespace, APPEARANCE_NAMESPACE) == 0)
+    appearance_update (&cache->appearance, key, value);
+
+  keys = g_hash_table_lookup (cache->values, namespace);
+  if (keys == NULL)
     {
-      va_start (ap, format);
-      g_variant_get_va (value, format, NULL, &ap);
-      va_end (ap);
+      keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+      g_hash_table_insert (cache->values, g_strdup (namespace), keys);
     }
+
+  g_hash_table_insert (keys, g_strdup (key), g_variant_ref (value));
 }
 
-/**
- * xdp_settings_read_value:
- * @settings: the [class@Settings] object.
- * @namespace: the namespace of the value.
- * @key: the key of the value.
- * @cancellable: a GCancellable or NULL.
- * @error: return location for error or NULL.
- *
- * Read a setting value within @namespace, with @key.
+/*
+ * cache_lookup:
  *
- * Returns: (transfer full): the value, or %NULL if not
- * found. If @error is not NULL, then the error is returned.
+ * Returns %TRUE if @namespace is cached, in which case @value is set to
+ * the cached value, or %NULL if the portal doesn't have @key.
  */
-GVariant *
-xdp_settings_read_value (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+static gboolean
+cache_lookup (XdpSettingsCache  *cache,
+              const char        *namespace,
+              const char        *key,
+              GVariant         **value)
 {
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GVariant) inner = NULL;
+  GHashTable *keys;
+  GVariant *cached = NULL;
+  gboolean found;
 
-  ret = g_dbus_connection_call_sync (settings->portal->bus,
-                                     PORTAL_BUS_NAME,
-                                     PORTAL_OBJECT_PATH,
-                                     SETTINGS_INTERFACE,
-                                     "ReadOne",
-                                     g_variant_new ("(ss)", namespace, key),
-                                     NULL,
-                                     G_DBUS_CALL_FLAGS_NONE,
-                                     5000,
-                                     cancellable, error);
-  if (!ret)
-    return NULL;
+  g_mutex_lock (&cache->lock);
 
-  g_variant_get (ret, "(v)", &inner);
+  found = namespace_is_cached (cache, namespace);
+  if (found)
+    {
+      keys = g_hash_table_lookup (cache->values, namespace);
+      if (keys)
+        cached = g_hash_table_lookup (keys, key);
+      if (cached)
+        g_variant_ref (cached);
+    }
 
-  return g_steal_pointer (&inner);
+  g_mutex_unlock (&cache->lock);
+
+  *value = cached;
+  return found;
 }
 
-/**
- * xdp_settings_read_all_values:
- * @settings: the [class@Settings] object.
- * @namespaces: List of namespaces to filter results by, supports
- * simple globbing explained below.
- * @cancellable: a GCancellable or NULL.
- * @error: return location for error or NULL.
- *
- * Read all the setting values within @namespace.
- *
- * Returns: (transfer full): a value containing all the values, or
- * %NULL if not found. If @error is not NULL, then the error is
- * returned.
- */
-GVariant *
-xdp_settings_read_all_values (XdpSettings *settings, const char *const *namespaces, GCancellable *cancellable, GError **error)
+/* Returns the a{sa{sv}} of all cached values within @namespaces, or
+ * %NULL if any of @namespaces is not cached */
+static GVariant *
+cache_lookup_all (XdpSettingsCache  *cache,
+                  const char *const *namespaces)
 {
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GVariant) inner = NULL;
+  static const char *const all[] = { "", NULL };
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const char *namespace;
+  GHashTable *keys;
+  gsize i;
 
-  ret = g_dbus_connection_call_sync (settings->portal->bus,
-                                     PORTAL_BUS_NAME,
-                                     PORTAL_OBJECT_PATH,
-                                     SETTINGS_INTERFACE,
-                                     "ReadAll",
-                                     g_variant_new ("(^as)", namespaces),
-                                     NULL,
-                                     G_DBUS_CALL_FLAGS_NONE,
-                                     5000,
-                                     cancellable, error);
-  if (!ret)
-    return NULL;
+  if (namespaces == NULL || namespaces[0] == NULL)
+    namespaces = all;
 
-  g_variant_get (ret, "(@a{sa{sv}})", &inner);
+  g_mutex_lock (&cache->lock);
 
-  return g_steal_pointer (&inner);
-}
+  for (i = 0; namespaces[i]; i++)
+    {
+      if (!namespace_is_cached (cache, namespaces[i]))
+        {
+          g_mutex_unlock (&cache->lock);
+          return NULL;
+        }
+    }
 
-XdpSettings *
-_xdp_settings_new (XdpPortal *portal)
-{
-  XdpSettings *settings;
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_hash_table_iter_init (&iter, cache->values);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &namespace, (gpointer *) &keys))
+    {
+      GHashTableIter key_iter;
+      const char *key;
+      GVariant *value;
+      gboolean wanted = FALSE;
+
+      for (i = 0; namespaces[i] && !wanted; i++)
+        wanted = namespace_matches (namespaces[i], namespace);
+
+      if (!wanted)
+        continue;
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("{sa{sv}}"));
+      g_variant_builder_add (&builder, "s", namespace);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE_VARDICT);
+
+      g_hash_table_iter_init (&key_iter, keys);
+      while (g_hash_table_iter_next (&key_iter, (gpointer *) &key, (gpointer *) &value))
+        g_variant_builder_add (&builder, "{sv}", key, value);
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  g_mutex_unlock (&cache->lock);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/* Notifies the appearance properties that differ from @old */
+static void
+cache_notify_appearance (XdpSettingsCache *cache,
+                         const Appearance *old)
+{
+  GParamSpec *changed[N_PROPERTIES];
+  GList *instances, *l;
+  Appearance current;
+  const Appearance *new = &current;
+  guint n_changed = 0;
+  guint i;
+
+  g_mutex_lock (&cache->lock);
+  current = cache->appearance;
+  g_mutex_unlock (&cache->lock);
+
+  if (new->color_scheme != old->color_scheme)
+    changed[n_changed++] = properties[PROP_COLOR_SCHEME];
+  if (new->has_accent_color != old->has_accent_color ||
+      (new->has_accent_color && memcmp (new->accent_color, old->accent_color, sizeof (new->accent_color)) != 0))
+    changed[n_changed++] = properties[PROP_ACCENT_COLOR];
+  if (new->contrast != old->contrast)
+    changed[n_changed++] = properties[PROP_CONTRAST];
+  if (new->reduced_motion != old->reduced_motion)
+    changed[n_changed++] = properties[PROP_REDUCED_MOTION];
+
+  if (n_changed == 0)
+    return;
+
+  instances = g_list_copy_deep (cache->instances, (GCopyFunc) g_object_ref, NULL);
+  for (l = instances; l; l = l->next)
+    {
+      for (i = 0; i < n_changed; i++)
+        g_object_notify_by_pspec (l->data, changed[i]);
+    }
+  g_list_free_full (instances, g_object_unref);
+}
+
+static gboolean
+namespace_matches_any (const char *const *patterns,
+                       const char        *namespace)
+{
+  gsize i;
+
+  for (i = 0; patterns[i]; i++)
+    {
+      if (namespace_matches (patterns[i], namespace))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * cache_load:
+ * @changes: (nullable): if not %NULL, the values of @namespaces are
+ *   replaced by @all_values, and every (ssmv) that differs from the
+ *   previously cached value is added to @changes, with no value for
+ *   keys that are gone
+ *
+ * Merges the a{sa{sv}} result of a ReadAll call for @namespaces.
+ */
+static void
+cache_load (XdpSettingsCache  *cache,
+            const char *const *namespaces,
+            GVariant          *all_values,
+            GPtrArray         *changes)
+{
+  static const char *const all[] = { "", NULL };
+  Appearance old_appearance;
+  GVariantIter iter;
+  const char *namespace;
+  GVariant *keys;
+  gsize i;
+
+  if (namespaces == NULL || namespaces[0] == NULL)
+    namespaces = all;
+
+  g_mutex_lock (&cache->lock);
+
+  old_appearance = cache->appearance;
+
+  if (changes)
+    {
+      g_autoptr(GHashTable) old_values = NULL;
+      GHashTableIter hash_iter;
+      GHashTable *old_keys;
+
+      /* Detach the old values, so that keys the portal dropped go away */
+      old_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+      g_hash_table_iter_init (&hash_iter, cache->values);
+      while (g_hash_table_iter_next (&hash_iter, (gpointer *) &namespace, (gpointer *) &old_keys))
+        {
+          if (namespace_matches_any (namespaces, namespace))
+            {
+              g_hash_table_insert (old_values, g_strdup (namespace), g_hash_table_ref (old_keys));
+              g_hash_table_iter_remove (&hash_iter);
+            }
+        }
+
+      if (namespace_matches_any (namespaces, APPEARANCE_NAMESPACE))
+        appearance_reset (&cache->appearance);
+
+      g_variant_iter_init (&iter, all_values);
+      while (g_variant_iter_next (&iter, "{&s@a{sv}}", &namespace, &keys))
+        {
+          GVariantIter key_iter;
+          const char *key;
+          GVariant *value;
+
+          old_keys = g_hash_table_lookup (old_values, namespace);
+
+          g_variant_iter_init (&key_iter, keys);
+          while (g_variant_iter_next (&key_iter, "{&sv}", &key, &value))
+            {
+              GVariant *old_value = old_keys ? g_hash_table_lookup (old_keys, key) : NULL;
+
+              if (old_value == NULL || !g_variant_equal (old_value, value))
+                g_ptr_array_add (changes, g_variant_ref_sink (g_variant_new ("(ssmv)", namespace, key, value)));
+
+              cache_store (cache, namespace, key, value);
+              g_variant_unref (value);
+            }
+
+          g_variant_unref (keys);
+        }
+
+      /* Keys the portal no longer has */
+      g_hash_table_iter_init (&hash_iter, old_values);
+      while (g_hash_table_iter_next (&hash_iter, (gpointer *) &namespace, (gpointer *) &old_keys))
+        {
+          GHashTable *new_keys = g_hash_table_lookup (cache->values, namespace);
+          GHashTableIter key_iter;
+          const char *key;
+
+          g_hash_table_iter_init (&key_iter, old_keys);
+          while (g_hash_table_iter_next (&key_iter, (gpointer *) &key, NULL))
+            {
+              if (new_keys == NULL || !g_hash_table_contains (new_keys, key))
+                g_ptr_array_add (changes, g_variant_ref_sink (g_variant_new ("(ssmv)", namespace, key, NULL)));
+            }
+        }
+    }
+  else
+    {
+      g_variant_iter_init (&iter, all_values);
+      while (g_variant_iter_next (&iter, "{&s@a{sv}}", &namespace, &keys))
+        {
+          GVariantIter key_iter;
+          const char *key;
+          GVariant *value;
+
+          g_variant_iter_init (&key_iter, keys);
+          while (g_variant_iter_next (&key_iter, "{&sv}", &key, &value))
+            {
+              cache_store (cache, namespace, key, value);
+              g_variant_unref (value);
+            }
+
+          g_variant_unref (keys);
+        }
+    }
+
+  for (i = 0; namespaces[i]; i++)
+    {
+      if (!namespace_is_cached (cache, namespaces[i]))
+        g_ptr_array_add (cache->namespaces, g_strdup (namespaces[i]));
+    }
+
+  if (namespace_is_cached (cache, APPEARANCE_NAMESPACE))
+    cache->appearance_loaded = TRUE;
+
+  g_mutex_unlock (&cache->lock);
+
+  cache_notify_appearance (cache, &old_appearance);
+}
+
+static gboolean
+parse_setting_changed (GVariant    *parameters,
+                       const char **namespace,
+                       const char **key,
+                       GVariant   **value)
+{
+  guint n_params;
+
+  n_params = g_variant_n_children (parameters);
+  if (n_params != 3)
+    {
+      g_warning ("Incorrect number of parameters, expected 3, got %u", n_params);
+      return FALSE;
+    }
+
+  g_variant_get_child (parameters, 0, "&s", namespace);
+  g_variant_get_child (parameters, 1, "&s", key);
+  g_variant_get_child (parameters, 2, "v", value);
+
+  return TRUE;
+}
+
+/* Several subscriptions may deliver the same change, so this must be
+ * idempotent */
+static void
+cache_update (XdpSettingsCache *cache,
+              const char       *namespace,
+              const char       *key,
+              GVariant         *value)
+{
+  Appearance old_appearance;
+  gboolean snapshot = FALSE;
+  guint i;
+
+  g_mutex_lock (&cache->lock);
+  old_appearance = cache->appearance;
+  if (namespace_is_cached (cache, namespace))
+    {
+      cache_store (cache, namespace, key, value);
+
+      for (i = 0; i < cache->snapshot_namespaces->len && !snapshot; i++)
+        snapshot = namespace_matches (g_ptr_array_index (cache->snapshot_namespaces, i), namespace);
+    }
+  g_mutex_unlock (&cache->lock);
+
+  if (snapshot)
+    cache_schedule_snapshot (cache);
+
+  cache_notify_appearance (cache, &old_appearance);
+}
+
+static gboolean
+flush_batch (gpointer data)
+{
+  XdpSettings *settings = data;
+  g_autoptr(GHashTable) batch = NULL;
+  g_autoptr(GVariant) changes = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const char *namespace;
+  GHashTable *keys;
+
+  g_clear_pointer (&settings->batch_source, g_source_unref);
+  batch = g_steal_pointer (&settings->batch);
+  if (batch == NULL)
+    return G_SOURCE_REMOVE;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_hash_table_iter_init (&iter, batch);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &namespace, (gpointer *) &keys))
+    {
+      GHashTableIter key_iter;
+      const char *key;
+      GVariant *value;
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("{sa{sv}}"));
+      g_variant_builder_add (&builder, "s", namespace);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE_VARDICT);
+
+      g_hash_table_iter_init (&key_iter, keys);
+      while (g_hash_table_iter_next (&key_iter, (gpointer *) &key, (gpointer *) &value))
+        g_variant_builder_add (&builder, "{sv}", key, value);
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  changes = g_variant_ref_sink (g_variant_builder_end (&builder));
+  g_signal_emit (settings, signals[CHANGED_BATCH], 0, changes);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+add_to_batch (XdpSettings *settings,
+              const char  *namespace,
+              const char  *key,
+              GVariant    *value)
+{
+  GHashTable *keys;
+
+  if (settings->batch == NULL)
+    settings->batch = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+
+  keys = g_hash_table_lookup (settings->batch, namespace);
+  if (keys == NULL)
+    {
+      keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+      g_hash_table_insert (settings->batch, g_strdup (namespace), keys);
+    }
+  g_hash_table_insert (keys, g_strdup (key), g_variant_ref (value));
+
+  if (settings->batch_source)
+    return;
+
+  /* GDBus dispatches each signal of a burst from its own default
+   * priority source, so an idle runs once all of them were handled */
+  if (settings->batch_window == 0)
+    settings->batch_source = g_idle_source_new ();
+  else
+    settings->batch_source = g_timeout_source_new (settings->batch_window);
+
+  g_source_set_callback (settings->batch_source, flush_batch, settings, NULL);
+  g_source_set_name (settings->batch_source, "[libportal] settings batch");
+  g_source_attach (settings->batch_source, g_main_context_get_thread_default ());
+}
+
+static void
+emit_changed (XdpSettings *settings,
+              const char  *namespace,
+              const char  *key,
+              GVariant    *value)
+{
+  g_autofree char *detail = NULL;
+
+  /* Without an existing quark, no handler can be connected to this
+   * detail, so don't grow the quark table for every key we see */
+  detail = g_strconcat (namespace, ".", key, NULL);
+  g_signal_emit (settings, signals[CHANGED], g_quark_try_string (detail), namespace, key, value);
+
+  /* A batch is an a{sa{sv}}, which can't express removed settings */
+  if (settings->batching && value)
+    add_to_batch (settings, namespace, key, value);
+}
+
+static void
+settings_changed (GDBusConnection *bus,
+		  const char *sender_name,
+		  const char *object_path,
+		  const char *interface_name,
+		  const char *signal_name,
+		  GVariant *parameters,
+		  gpointer data)
+{
+  const char *namespace = NULL;
+  const char *key = NULL;
+  g_autoptr(GVariant) value = NULL;
+  GList *instances, *l;
+
+  XdpSettingsCache *cache = data;
+
+  if (!parse_setting_changed (parameters, &namespace, &key, &value))
+    return;
+
+  /* The portal is answering again */
+  cache_retry_appearance (cache);
+
+  cache_update (cache, namespace, key, value);
+
+  /* Handlers may create or drop settings objects */
+  instances = g_list_copy_deep (cache->instances, (GCopyFunc) g_object_ref, NULL);
+  for (l = instances; l; l = l->next)
+    {
+      XdpSettings *settings = l->data;
+
+      if (!settings->watched)
+        emit_changed (settings, namespace, key, value);
+    }
+  g_list_free_full (instances, g_object_unref);
+}
+
+static gboolean
+watch_matches (SettingsWatch *watch,
+               const char    *namespace,
+               const char    *key)
+{
+  return strcmp (watch->namespace, namespace) == 0 &&
+         (watch->key == NULL || strcmp (watch->key, key) == 0);
+}
+
+/* Reports a change that didn't come from a SettingChanged signal to
+ * every settings object that would have seen the signal */
+static void
+cache_dispatch_change (XdpSettingsCache *cache,
+                       const char       *namespace,
+                       const char       *key,
+                       GVariant         *value)
+{
+  GList *instances, *l, *w;
+
+  instances = g_list_copy_deep (cache->instances, (GCopyFunc) g_object_ref, NULL);
+  for (l = instances; l; l = l->next)
+    {
+      XdpSettings *settings = l->data;
+      gboolean wanted = !settings->watched;
+
+      for (w = settings->watches; w && !wanted; w = w->next)
+        wanted = watch_matches (w->data, namespace, key);
+
+      if (wanted)
+        emit_changed (settings, namespace, key, value);
+    }
+  g_list_free_full (instances, g_object_unref);
+}
+
+/* Must be called with the cache lock held */
+static GStrv
+cache_dup_snapshot_namespaces (XdpSettingsCache *cache)
+{
+  GStrv namespaces;
+  guint i;
+
+  namespaces = g_new0 (char *, cache->snapshot_namespaces->len + 1);
+  for (i = 0; i < cache->snapshot_namespaces->len; i++)
+    namespaces[i] = g_strdup (g_ptr_array_index (cache->snapshot_namespaces, i));
+
+  return namespaces;
+}
+
+static void
+cache_write_snapshot (XdpSettingsCache *cache)
+{
+  g_autoptr(GVariant) values = NULL;
+  g_autoptr(GVariant) previous = NULL;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) namespaces = NULL;
+  GVariantBuilder builder;
+  GVariantIter iter;
+  const char *namespace;
+  GVariant *keys;
+
+  g_mutex_lock (&cache->lock);
+  namespaces = cache_dup_snapshot_namespaces (cache);
+  g_mutex_unlock (&cache->lock);
+
+  values = cache_lookup_all (cache, (const char * const *) namespaces);
+  if (values == NULL)
+    return;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_variant_iter_init (&iter, values);
+  while ((keys = g_variant_iter_next_value (&iter)))
+    {
+      g_variant_builder_add_value (&builder, keys);
+      g_variant_unref (keys);
+    }
+
+  /* Other applications may share the snapshot; keep their namespaces */
+  previous = _xdp_settings_snapshot_load ();
+  if (previous)
+    {
+      g_variant_iter_init (&iter, previous);
+      while (g_variant_iter_next (&iter, "{&s@a{sv}}", &namespace, &keys))
+        {
+          if (!namespace_matches_any ((const char * const *) namespaces, namespace))
+            g_variant_builder_add (&builder, "{s@a{sv}}", namespace, keys);
+          g_variant_unref (keys);
+        }
+    }
+
+  if (!_xdp_settings_snapshot_save (g_variant_builder_end (&builder), &error))
+    g_debug ("Failed to save settings snapshot: %s", error->message);
+}
+
+static gboolean
+write_snapshot_cb (gpointer data)
+{
+  XdpSettingsCache *cache = data;
+
+  g_clear_pointer (&cache->snapshot_source, g_source_unref);
+  cache_write_snapshot (cache);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cache_schedule_snapshot (XdpSettingsCache *cache)
+{
+  if (cache->snapshot_source)
+    return;
+
+  /* Bursts of changes are common, so write once they settled */
+  cache->snapshot_source = g_timeout_source_new_seconds (1);
+  g_source_set_callback (cache->snapshot_source, write_snapshot_cb, cache, NULL);
+  g_source_set_name (cache->snapshot_source, "[libportal] settings snapshot");
+  g_source_attach (cache->snapshot_source, g_main_context_get_thread_default ());
+}
+
+static void
+cache_acquire_all (XdpSettingsCache *cache)
+{
+  if (cache->all_users++ > 0)
+    return;
+
+  cache->all_signal_id =
+    g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (cache->portal),
+                                        PORTAL_BUS_NAME,
+                                        SETTINGS_INTERFACE,
+                                        "SettingChanged",
+                                        PORTAL_OBJECT_PATH,
+                                        NULL,
+                                        G_DBUS_SIGNAL_FLAGS_NONE,
+                                        settings_changed,
+                                        cache,
+                                        NULL);
+}
+
+static void
+cache_release_all (XdpSettingsCache *cache)
+{
+  g_assert (cache->all_users > 0);
+
+  if (--cache->all_users > 0)
+    return;
+
+  g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (cache->portal), cache->all_signal_id);
+  cache->all_signal_id = 0;
+}
+
+/* Called before asking the portal for values to cache. The shared
+ * subscription is in place before the ReadAll call is sent, so that no
+ * change is lost between the reply and cache_load(); GDBus sends the
+ * match rule ahead of the call on the same connection. */
+static void
+cache_begin_loading (XdpSettingsCache *cache)
+{
+  if (cache->caching)
+    return;
+
+  cache->caching = TRUE;
+  cache_acquire_all (cache);
+}
+
+static XdpSettingsCache *
+settings_cache_new (XdpPortal *portal)
+{
+  XdpSettingsCache *cache;
+
+  cache = g_new0 (XdpSettingsCache, 1);
+  cache->portal = portal;
+  g_mutex_init (&cache->lock);
+  cache->namespaces = g_ptr_array_new_with_free_func (g_free);
+  cache->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+  cache->snapshot_namespaces = g_ptr_array_new_with_free_func (g_free);
+
+  return cache;
+}
+
+void
+_xdp_settings_cache_free (XdpSettingsCache *cache)
+{
+  /* Every settings object holds a reference on the portal */
+  g_assert (cache->instances == NULL);
+
+  /* Don't lose the last changes */
+  if (cache->snapshot_source)
+    {
+      g_source_destroy (cache->snapshot_source);
+      g_clear_pointer (&cache->snapshot_source, g_source_unref);
+      cache_write_snapshot (cache);
+    }
+
+  if (cache->all_signal_id)
+    g_dbus_connection_signal_unsubscribe (cache->portal->bus, cache->all_signal_id);
+
+  g_ptr_array_unref (cache->snapshot_namespaces);
+  g_ptr_array_unref (cache->namespaces);
+  g_hash_table_unref (cache->values);
+  g_mutex_clear (&cache->lock);
+
+  g_free (cache);
+}
+
+static guint32
+value_get_uint (GVariant  *value,
+                GError   **error)
+{
+  if (value)
+    {
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32))
+        return g_variant_get_uint32 (value);
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Value doesn't contain an integer.");
+    }
+
+  return 0;
+}
+
+static char *
+value_dup_string (GVariant  *value,
+                  GError   **error)
+{
+  if (value)
+    {
+      if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
+        return g_variant_dup_string (value, NULL);
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Value doesn't contain a string.");
+    }
+
+  return NULL;
+}
+
+/**
+ * xdp_settings_read_uint:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Read a setting value as unsigned int within @namespace, with @key.
+ *
+ * Returns: the uint value, or 0 if not found or not
+ * the right type. If @error is not NULL, then the error is returned.
+ */
+guint32
+xdp_settings_read_uint (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+{
+  g_autoptr(GVariant) value = NULL;
+
+  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
+
+  return value_get_uint (value, error);
+}
+
+/**
+ * xdp_settings_read_string:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Read a setting value as unsigned int within @namespace, with @key.
+ *
+ * Returns: (transfer full): the stringint value, or NULL if not found or not
+ * the right type. If @error is not NULL, then the error is returned.
+ */
+char *
+xdp_settings_read_string (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+{
+  g_autoptr(GVariant) value = NULL;
+
+  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
+
+  return value_dup_string (value, error);
+}
+
+/**
+ * xdp_settings_read:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ * @format: a #GVariant format string
+ * @...: arguments as per @format
+ *
+ * Read a setting value within @namespace, with @key.
+ *
+ * A convenience function that combines xdp_settings_read_value() with
+ * g_variant_get().
+ *
+ * In case of error, if @error is not NULL, then the error is
+ * returned.
+ */
+void
+xdp_settings_read (XdpSettings *settings, const char *namespace, const gchar *key, GCancellable *cancellable, GError **error, const gchar *format, ...)
+{
+  g_autoptr(GVariant) value = NULL;
+  va_list ap;
+
+  value = xdp_settings_read_value (settings, namespace, key, cancellable, error);
+  if (value)
+    {
+      va_start (ap, format);
+      g_variant_get_va (value, format, NULL, &ap);
+      va_end (ap);
+    }
+}
+
+/**
+ * xdp_settings_read_value:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Read a setting value within @namespace, with @key.
+ *
+ * If @namespace was loaded with [method@Settings.enable_cache], the
+ * value is returned from memory, and a missing key is reported as
+ * %G_IO_ERROR_NOT_FOUND.
+ *
+ * Returns: (transfer full): the value, or %NULL if not
+ * found. If @error is not NULL, then the error is returned.
+ */
+GVariant *
+xdp_settings_read_value (XdpSettings *settings, const char *namespace, const char *key, GCancellable *cancellable, GError **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) inner = NULL;
+
+  if (cache_lookup (settings->portal->settings_cache, namespace, key, &inner))
+    {
+      if (inner == NULL)
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                     "Requested setting %s.%s not found", namespace, key);
+      return g_steal_pointer (&inner);
+    }
+
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (settings->portal),
+                                     PORTAL_BUS_NAME,
+                                     PORTAL_OBJECT_PATH,
+                                     SETTINGS_INTERFACE,
+                                     "ReadOne",
+                                     g_variant_new ("(ss)", namespace, key),
+                                     NULL,
+                                     G_DBUS_CALL_FLAGS_NONE,
+                                     5000,
+                                     cancellable, error);
+  if (!ret)
+    return NULL;
+
+  g_variant_get (ret, "(v)", &inner);
+
+  return g_steal_pointer (&inner);
+}
+
+/**
+ * xdp_settings_read_all_values:
+ * @settings: the [class@Settings] object.
+ * @namespaces: List of namespaces to filter results by, supports
+ * simple globbing explained below.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Read all the setting values within @namespace.
+ *
+ * If all of @namespaces were loaded with [method@Settings.enable_cache],
+ * the values are returned from memory.
+ *
+ * Returns: (transfer full): a value containing all the values, or
+ * %NULL if not found. If @error is not NULL, then the error is
+ * returned.
+ */
+GVariant *
+xdp_settings_read_all_values (XdpSettings *settings, const char *const *namespaces, GCancellable *cancellable, GError **error)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GVariant) inner = NULL;
+
+  inner = cache_lookup_all (settings->portal->settings_cache, namespaces);
+  if (inner)
+    return g_steal_pointer (&inner);
+
+  ret = g_dbus_connection_call_sync (_xdp_portal_get_bus (settings->portal),
+                                     PORTAL_BUS_NAME,
+                                     PORTAL_OBJECT_PATH,
+                                     SETTINGS_INTERFACE,
+                                     "ReadAll",
+                                     g_variant_new ("(^as)", namespaces),
+                                     NULL,
+                                     G_DBUS_CALL_FLAGS_NONE,
+                                     5000,
+                                     cancellable, error);
+  if (!ret)
+    return NULL;
+
+  g_variant_get (ret, "(@a{sa{sv}})", &inner);
+
+  return g_steal_pointer (&inner);
+}
+
+static void
+read_one_done (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  g_autoptr(GVariant) ret = NULL;
+  GVariant *inner;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+  if (ret == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_variant_get (ret, "(v)", &inner);
+  g_task_return_pointer (task, inner, (GDestroyNotify) g_variant_unref);
+}
+
+/* The typed _async variants only differ in their source tag and finish */
+static void
+read_one_async (XdpSettings         *settings,
+                const char          *namespace,
+                const char          *key,
+                GCancellable        *cancellable,
+                GAsyncReadyCallback  callback,
+                gpointer             data,
+                gpointer             source_tag)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(GVariant) value = NULL;
+
+  task = g_task_new (settings, cancellable, callback, data);
+  g_task_set_source_tag (task, source_tag);
+
+  if (cache_lookup (settings->portal->settings_cache, namespace, key, &value))
+    {
+      if (value)
+        g_task_return_pointer (task, g_steal_pointer (&value), (GDestroyNotify) g_variant_unref);
+      else
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                                 "Requested setting %s.%s not found", namespace, key);
+      return;
+    }
+
+  g_dbus_connection_call (_xdp_portal_get_bus (settings->portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          SETTINGS_INTERFACE,
+                          "ReadOne",
+                          g_variant_new ("(ss)", namespace, key),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          5000,
+                          cancellable,
+                          read_one_done,
+                          g_steal_pointer (&task));
+}
+
+/**
+ * xdp_settings_read_value_async:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously reads a setting value within @namespace, with @key.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.read_value_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_read_value_async (XdpSettings         *settings,
+                               const char          *namespace,
+                               const char          *key,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             data)
+{
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  read_one_async (settings, namespace, key, cancellable, callback, data,
+                  xdp_settings_read_value_async);
+}
+
+/**
+ * xdp_settings_read_value_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a read started with [method@Settings.read_value_async].
+ *
+ * Returns: (transfer full): the value, or %NULL if not found
+ *
+ * Since: 0.9
+ */
+GVariant *
+xdp_settings_read_value_finish (XdpSettings   *settings,
+                                GAsyncResult  *result,
+                                GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, settings), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_read_value_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * xdp_settings_read_uint_async:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously reads a setting value as unsigned int within
+ * @namespace, with @key.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.read_uint_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_read_uint_async (XdpSettings         *settings,
+                              const char          *namespace,
+                              const char          *key,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             data)
+{
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  read_one_async (settings, namespace, key, cancellable, callback, data,
+                  xdp_settings_read_uint_async);
+}
+
+/**
+ * xdp_settings_read_uint_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a read started with [method@Settings.read_uint_async].
+ *
+ * Returns: the uint value, or 0 if not found or not the right type
+ *
+ * Since: 0.9
+ */
+guint32
+xdp_settings_read_uint_finish (XdpSettings   *settings,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+  g_autoptr(GVariant) value = NULL;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), 0);
+  g_return_val_if_fail (g_task_is_valid (result, settings), 0);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_read_uint_async, 0);
+
+  value = g_task_propagate_pointer (G_TASK (result), error);
+
+  return value_get_uint (value, error);
+}
+
+/**
+ * xdp_settings_read_string_async:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace of the value.
+ * @key: the key of the value.
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously reads a setting value as string within @namespace,
+ * with @key.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.read_string_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_read_string_async (XdpSettings         *settings,
+                                const char          *namespace,
+                                const char          *key,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             data)
+{
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  read_one_async (settings, namespace, key, cancellable, callback, data,
+                  xdp_settings_read_string_async);
+}
+
+/**
+ * xdp_settings_read_string_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a read started with [method@Settings.read_string_async].
+ *
+ * Returns: (transfer full): the string value, or %NULL if not found
+ *   or not the right type
+ *
+ * Since: 0.9
+ */
+char *
+xdp_settings_read_string_finish (XdpSettings   *settings,
+                                 GAsyncResult  *result,
+                                 GError       **error)
+{
+  g_autoptr(GVariant) value = NULL;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, settings), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_read_string_async, NULL);
+
+  value = g_task_propagate_pointer (G_TASK (result), error);
+
+  return value_dup_string (value, error);
+}
+
+static void
+read_all_done (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  g_autoptr(GVariant) ret = NULL;
+  GVariant *inner;
+  GError *error = NULL;
+
+  ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+  if (ret == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_variant_get (ret, "(@a{sa{sv}})", &inner);
+  g_task_return_pointer (task, inner, (GDestroyNotify) g_variant_unref);
+}
+
+/* Like read_all_async(), but always asks the portal */
+static void
+read_all_from_portal (XdpSettings       *settings,
+                      const char *const *namespaces,
+                      GTask             *task)
+{
+  static const char *const all[] = { NULL };
+
+  g_dbus_connection_call (_xdp_portal_get_bus (settings->portal),
+                          PORTAL_BUS_NAME,
+                          PORTAL_OBJECT_PATH,
+                          SETTINGS_INTERFACE,
+                          "ReadAll",
+                          g_variant_new ("(^as)", namespaces ? namespaces : all),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          5000,
+                          g_task_get_cancellable (task),
+                          read_all_done,
+                          task);
+}
+
+/* Takes ownership of @task, which returns the a{sa{sv}} of @namespaces */
+static void
+read_all_async (XdpSettings       *settings,
+                const char *const *namespaces,
+                GTask             *task)
+{
+  GVariant *values;
+
+  values = cache_lookup_all (settings->portal->settings_cache, namespaces);
+  if (values)
+    {
+      g_task_return_pointer (task, values, (GDestroyNotify) g_variant_unref);
+      g_object_unref (task);
+      return;
+    }
+
+  read_all_from_portal (settings, namespaces, task);
+}
+
+/**
+ * xdp_settings_read_all_values_async:
+ * @settings: the [class@Settings] object.
+ * @namespaces: List of namespaces to filter results by, supports
+ *   the same globbing as [method@Settings.read_all_values].
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously reads all the setting values within @namespaces.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.read_all_values_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_read_all_values_async (XdpSettings         *settings,
+                                    const char *const   *namespaces,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             data)
+{
+  GTask *task;
+
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  task = g_task_new (settings, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_settings_read_all_values_async);
+
+  read_all_async (settings, namespaces, task);
+}
+
+/**
+ * xdp_settings_read_all_values_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a read started with [method@Settings.read_all_values_async].
+ *
+ * Returns: (transfer full): a value containing all the values, or
+ *   %NULL on error
+ *
+ * Since: 0.9
+ */
+GVariant *
+xdp_settings_read_all_values_finish (XdpSettings   *settings,
+                                     GAsyncResult  *result,
+                                     GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, settings), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_read_all_values_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/* Returns the distinct namespaces of the a(ss) @keys */
+static char **
+keys_get_namespaces (GVariant *keys)
+{
+  g_autoptr(GPtrArray) namespaces = NULL;
+  g_autoptr(GHashTable) seen = NULL;
+  GVariantIter iter;
+  const char *namespace;
+
+  namespaces = g_ptr_array_new ();
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+
+  g_variant_iter_init (&iter, keys);
+  while (g_variant_iter_next (&iter, "(&s&s)", &namespace, NULL))
+    {
+      if (g_hash_table_add (seen, (gpointer) namespace))
+        g_ptr_array_add (namespaces, g_strdup (namespace));
+    }
+  g_ptr_array_add (namespaces, NULL);
+
+  return (char **) g_ptr_array_free (g_steal_pointer (&namespaces), FALSE);
+}
+
+/* Picks the a(ss) @keys out of the a{sa{sv}} @all_values */
+static GVariant *
+keys_filter_values (GVariant *keys,
+                    GVariant *all_values)
+{
+  g_autoptr(GHashTable) found = NULL;
+  GVariantBuilder builder;
+  GHashTableIter hash_iter;
+  GVariantIter iter;
+  const char *namespace;
+  const char *key;
+  GVariantDict *dict;
+
+  found = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_dict_unref);
+
+  g_variant_iter_init (&iter, keys);
+  while (g_variant_iter_next (&iter, "(&s&s)", &namespace, &key))
+    {
+      g_autoptr(GVariant) namespace_values = NULL;
+      g_autoptr(GVariant) value = NULL;
+
+      namespace_values = g_variant_lookup_value (all_values, namespace, G_VARIANT_TYPE_VARDICT);
+      if (namespace_values)
+        value = g_variant_lookup_value (namespace_values, key, NULL);
+      if (value == NULL)
+        continue;
+
+      dict = g_hash_table_lookup (found, namespace);
+      if (dict == NULL)
+        {
+          dict = g_variant_dict_new (NULL);
+          g_hash_table_insert (found, (gpointer) namespace, dict);
+        }
+      g_variant_dict_insert_value (dict, key, value);
+    }
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_hash_table_iter_init (&hash_iter, found);
+  while (g_hash_table_iter_next (&hash_iter, (gpointer *) &namespace, (gpointer *) &dict))
+    g_variant_builder_add (&builder, "{s@a{sv}}", namespace, g_variant_dict_end (dict));
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/**
+ * xdp_settings_read_keys:
+ * @settings: the [class@Settings] object.
+ * @keys: a `a(ss)` [struct@GLib.Variant] of namespace and key pairs
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Reads several setting values at once, with a single call to the
+ * portal.
+ *
+ * Keys that the portal doesn't have are left out of the result.
+ *
+ * Returns: (transfer full): a `a{sa{sv}}` [struct@GLib.Variant] with
+ *   the values, grouped by namespace, or %NULL on error. If @error is
+ *   not NULL, then the error is returned.
+ *
+ * Since: 0.9
+ */
+GVariant *
+xdp_settings_read_keys (XdpSettings *settings, GVariant *keys, GCancellable *cancellable, GError **error)
+{
+  g_autoptr(GVariant) owned_keys = NULL;
+  g_autoptr(GVariant) values = NULL;
+  g_auto(GStrv) namespaces = NULL;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+  g_return_val_if_fail (g_variant_is_of_type (keys, G_VARIANT_TYPE ("a(ss)")), NULL);
+
+  owned_keys = g_variant_ref_sink (keys);
+  namespaces = keys_get_namespaces (owned_keys);
+
+  /* No namespaces would read everything */
+  if (namespaces[0] == NULL)
+    return g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{sa{sv}}"), NULL, 0));
+
+  values = xdp_settings_read_all_values (settings, (const char * const *) namespaces, cancellable, error);
+  if (values == NULL)
+    return NULL;
+
+  return keys_filter_values (owned_keys, values);
+}
+
+/**
+ * xdp_settings_read_keys_async:
+ * @settings: the [class@Settings] object.
+ * @keys: a `a(ss)` [struct@GLib.Variant] of namespace and key pairs
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously reads several setting values at once, with a single
+ * call to the portal.
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.read_keys_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_read_keys_async (XdpSettings         *settings,
+                              GVariant            *keys,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             data)
+{
+  g_auto(GStrv) namespaces = NULL;
+  GTask *task;
+
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+  g_return_if_fail (g_variant_is_of_type (keys, G_VARIANT_TYPE ("a(ss)")));
+
+  task = g_task_new (settings, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_settings_read_keys_async);
+  g_task_set_task_data (task, g_variant_ref_sink (keys), (GDestroyNotify) g_variant_unref);
+
+  namespaces = keys_get_namespaces (keys);
+  if (namespaces[0] == NULL)
+    {
+      g_task_return_pointer (task,
+                             g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE ("{sa{sv}}"), NULL, 0)),
+                             (GDestroyNotify) g_variant_unref);
+      g_object_unref (task);
+      return;
+    }
+
+  read_all_async (settings, (const char * const *) namespaces, task);
+}
+
+/**
+ * xdp_settings_read_keys_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a read started with [method@Settings.read_keys_async].
+ *
+ * Returns: (transfer full): a `a{sa{sv}}` [struct@GLib.Variant] with
+ *   the values, grouped by namespace, or %NULL on error
+ *
+ * Since: 0.9
+ */
+GVariant *
+xdp_settings_read_keys_finish (XdpSettings   *settings,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+  g_autoptr(GVariant) values = NULL;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, settings), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_read_keys_async, NULL);
+
+  values = g_task_propagate_pointer (G_TASK (result), error);
+  if (values == NULL)
+    return NULL;
+
+  return keys_filter_values (g_task_get_task_data (G_TASK (result)), values);
+}
+
+static void
+watch_changed (GDBusConnection *bus,
+               const char *sender_name,
+               const char *object_path,
+               const char *interface_name,
+               const char *signal_name,
+               GVariant *parameters,
+               gpointer data)
+{
+  SettingsWatch *watch = data;
+  g_autoptr(XdpSettings) settings = g_object_ref (watch->settings);
+  const char *namespace = NULL;
+  const char *key = NULL;
+  g_autoptr(GVariant) value = NULL;
+  GList *l;
+
+  if (!parse_setting_changed (parameters, &namespace, &key, &value))
+    return;
+
+  /* The bus filters on the key too, but other rules on the same
+   * connection may let more through */
+  if (watch->key && strcmp (watch->key, key) != 0)
+    return;
+
+  cache_update (settings->portal->settings_cache, namespace, key, value);
+
+  /* Overlapping watches each get the signal; only report it once */
+  for (l = settings->watches; l; l = l->next)
+    {
+      if (watch_matches (l->data, namespace, key))
+        break;
+    }
+
+  if (l && l->data == watch)
+    emit_changed (settings, namespace, key, value);
+}
+
+static void
+settings_watch_free (SettingsWatch *watch)
+{
+  g_free (watch->namespace);
+  g_free (watch->key);
+  g_free (watch->match_rule);
+  g_free (watch);
+}
+
+/**
+ * xdp_settings_watch:
+ * @settings: the [class@Settings] object.
+ * @namespace: the namespace to watch.
+ * @key: (nullable): the key to watch, or %NULL to watch all keys
+ *   within @namespace.
+ *
+ * Asks to be notified about changes of the setting @key within
+ * @namespace.
+ *
+ * The message bus only delivers the matching change notifications to
+ * the application. Once a watch is installed, [signal@Settings::changed]
+ * is only emitted on @settings for watched settings, rather than for
+ * every change.
+ *
+ * Returns: the watch ID, to pass to [method@Settings.unwatch]
+ *
+ * Since: 0.9
+ */
+guint
+xdp_settings_watch (XdpSettings *settings, const char *namespace, const char *key)
+{
+  XdpSettingsCache *cache;
+  GDBusConnection *bus;
+  SettingsWatch *watch;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), 0);
+  g_return_val_if_fail (namespace != NULL && strchr (namespace, '\'') == NULL, 0);
+  g_return_val_if_fail (key == NULL || strchr (key, '\'') == NULL, 0);
+
+  cache = settings->portal->settings_cache;
+  bus = _xdp_portal_get_bus (settings->portal);
+
+  watch = g_new0 (SettingsWatch, 1);
+  watch->settings = settings;
+  watch->namespace = g_strdup (namespace);
+  watch->key = g_strdup (key);
+
+  /* GDBus can only express arg0 matches, so add the match rule
+   * ourselves to have the bus filter on the key as well */
+  if (key)
+    watch->match_rule = g_strdup_printf ("type='signal',sender='%s',interface='%s',member='SettingChanged',path='%s',arg0='%s',arg1='%s'",
+                                         PORTAL_BUS_NAME, SETTINGS_INTERFACE, PORTAL_OBJECT_PATH,
+                                         namespace, key);
+  else
+    watch->match_rule = g_strdup_printf ("type='signal',sender='%s',interface='%s',member='SettingChanged',path='%s',arg0='%s'",
+                                         PORTAL_BUS_NAME, SETTINGS_INTERFACE, PORTAL_OBJECT_PATH,
+                                         namespace);
+
+  g_dbus_connection_call (bus,
+                          "org.freedesktop.DBus",
+                          "/org/freedesktop/DBus",
+                          "org.freedesktop.DBus",
+                          "AddMatch",
+                          g_variant_new ("(s)", watch->match_rule),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL, NULL, NULL);
+
+  watch->signal_id = g_dbus_connection_signal_subscribe (bus,
+                                                         PORTAL_BUS_NAME,
+                                                         SETTINGS_INTERFACE,
+                                                         "SettingChanged",
+                                                         PORTAL_OBJECT_PATH,
+                                                         namespace,
+                                                         G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
+                                                         watch_changed,
+                                                         watch,
+                                                         (GDestroyNotify) settings_watch_free);
+
+  settings->watches = g_list_append (settings->watches, watch);
+
+  if (!settings->watched)
+    {
+      settings->watched = TRUE;
+      cache_release_all (cache);
+    }
+
+  return watch->signal_id;
+}
+
+/**
+ * xdp_settings_unwatch:
+ * @settings: the [class@Settings] object.
+ * @watch_id: a watch ID returned by [method@Settings.watch]
+ *
+ * Removes a watch installed with [method@Settings.watch].
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_unwatch (XdpSettings *settings, guint watch_id)
+{
+  GDBusConnection *bus;
+  GList *l;
+
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  for (l = settings->watches; l; l = l->next)
+    {
+      SettingsWatch *watch = l->data;
+
+      if (watch->signal_id == watch_id)
+        break;
+    }
+
+  g_return_if_fail (l != NULL);
+
+  bus = _xdp_portal_get_bus (settings->portal);
+
+  g_dbus_connection_call (bus,
+                          "org.freedesktop.DBus",
+                          "/org/freedesktop/DBus",
+                          "org.freedesktop.DBus",
+                          "RemoveMatch",
+                          g_variant_new ("(s)", ((SettingsWatch *) l->data)->match_rule),
+                          NULL,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL, NULL, NULL);
+
+  settings->watches = g_list_delete_link (settings->watches, l);
+
+  /* Frees the watch */
+  g_dbus_connection_signal_unsubscribe (bus, watch_id);
+
+  /* Without watches, every change is reported again */
+  if (settings->watches == NULL)
+    {
+      settings->watched = FALSE;
+      cache_acquire_all (settings->portal->settings_cache);
+    }
+}
+
+/**
+ * xdp_settings_enable_batching:
+ * @settings: the [class@Settings] object.
+ * @window_ms: how long to collect changes for, in milliseconds, or 0
+ *   to collect the changes handled in one main context iteration
+ *
+ * Starts emitting [signal@Settings::changed-batch] for bursts of
+ * setting changes, such as the ones that follow a theme switch.
+ *
+ * The first change after a batch was emitted opens a new batch, which
+ * is emitted once @window_ms have passed, or, with a @window_ms of 0,
+ * once the main context has no more pending changes to dispatch.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_enable_batching (XdpSettings *settings, guint window_ms)
+{
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  /* A new window only applies to the next batch */
+  settings->batching = TRUE;
+  settings->batch_window = window_ms;
+}
+
+/**
+ * xdp_settings_disable_batching:
+ * @settings: the [class@Settings] object.
+ *
+ * Stops emitting [signal@Settings::changed-batch]. A pending batch is
+ * emitted right away.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_disable_batching (XdpSettings *settings)
+{
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  settings->batching = FALSE;
+
+  if (settings->batch_source)
+    {
+      g_source_destroy (settings->batch_source);
+      flush_batch (settings);
+    }
+}
+
+/**
+ * xdp_settings_enable_cache:
+ * @settings: the [class@Settings] object.
+ * @namespaces: (nullable): List of namespaces to cache, supports the
+ *   same globbing as [method@Settings.read_all_values]. %NULL or an
+ *   empty list caches all namespaces.
+ * @cancellable: a GCancellable or NULL.
+ * @error: return location for error or NULL.
+ *
+ * Loads all setting values within @namespaces with a single call to
+ * the portal, and answers further reads within them from memory.
+ *
+ * The cached values are updated whenever the portal reports a change,
+ * before [signal@Settings::changed] is emitted. The cache is shared by
+ * all [class@Settings] objects of the same [class@Portal].
+ *
+ * Returns: %TRUE if the values were loaded. If @error is not NULL,
+ *   then the error is returned.
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_settings_enable_cache (XdpSettings *settings, const char *const *namespaces, GCancellable *cancellable, GError **error)
+{
+  static const char *const all[] = { NULL };
+  g_autoptr(GVariant) values = NULL;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), FALSE);
+
+  cache_begin_loading (settings->portal->settings_cache);
+
+  values = xdp_settings_read_all_values (settings, namespaces ? namespaces : all, cancellable, error);
+  if (values == NULL)
+    return FALSE;
+
+  cache_load (settings->portal->settings_cache, namespaces, values, NULL);
+
+  return TRUE;
+}
+
+static void
+enable_cache_done (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  XdpSettings *settings = g_task_get_source_object (task);
+  g_autoptr(GVariant) values = NULL;
+  GError *error = NULL;
+
+  values = g_task_propagate_pointer (G_TASK (result), &error);
+  if (values == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  cache_load (settings->portal->settings_cache, g_task_get_task_data (task), values, NULL);
+  g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * xdp_settings_enable_cache_async:
+ * @settings: the [class@Settings] object.
+ * @namespaces: (nullable): List of namespaces to cache, as for
+ *   [method@Settings.enable_cache]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the request is done
+ * @data: (closure): data to pass to @callback
+ *
+ * Asynchronously loads all setting values within @namespaces into the
+ * cache, see [method@Settings.enable_cache].
+ *
+ * When the request is done, @callback will be called. You can then
+ * call [method@Settings.enable_cache_finish] to get the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_enable_cache_async (XdpSettings         *settings,
+                                 const char *const   *namespaces,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             data)
+{
+  GTask *task;
+  GTask *read_task;
+
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  task = g_task_new (settings, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_settings_enable_cache_async);
+  g_task_set_task_data (task, g_strdupv ((char **) namespaces), (GDestroyNotify) g_strfreev);
+
+  cache_begin_loading (settings->portal->settings_cache);
+
+  read_task = g_task_new (settings, cancellable, enable_cache_done, task);
+  read_all_async (settings, namespaces, read_task);
+}
+
+/**
+ * xdp_settings_enable_cache_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a load started with [method@Settings.enable_cache_async].
+ *
+ * Returns: %TRUE if the values were loaded
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_settings_enable_cache_finish (XdpSettings   *settings,
+                                  GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, settings), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_enable_cache_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+typedef struct {
+  GStrv namespaces;
+  GStrv unverified; /* patterns only cached from the snapshot */
+} SnapshotLoad;
+
+static void
+snapshot_load_free (SnapshotLoad *load)
+{
+  g_strfreev (load->namespaces);
+  g_strfreev (load->unverified);
+  g_free (load);
+}
+
+/* Stops answering reads within @patterns from memory */
+static void
+cache_forget (XdpSettingsCache  *cache,
+              const char *const *patterns)
+{
+  GHashTableIter iter;
+  const char *namespace;
+  guint i;
+
+  if (patterns == NULL || patterns[0] == NULL)
+    return;
+
+  g_mutex_lock (&cache->lock);
+
+  for (i = cache->namespaces->len; i > 0; i--)
+    {
+      if (g_strv_contains (patterns, g_ptr_array_index (cache->namespaces, i - 1)))
+        g_ptr_array_remove_index (cache->namespaces, i - 1);
+    }
+
+  g_hash_table_iter_init (&iter, cache->values);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &namespace, NULL))
+    {
+      if (!namespace_is_cached (cache, namespace))
+        g_hash_table_iter_remove (&iter);
+    }
+
+  if (!namespace_is_cached (cache, APPEARANCE_NAMESPACE))
+    {
+      cache->appearance_loaded = FALSE;
+      appearance_reset (&cache->appearance);
+    }
+
+  g_mutex_unlock (&cache->lock);
+}
+
+static void
+snapshot_revalidated (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      data)
+{
+  g_autoptr(GTask) task = data;
+  XdpSettings *settings = g_task_get_source_object (task);
+  XdpSettingsCache *cache = settings->portal->settings_cache;
+  SnapshotLoad *load = g_task_get_task_data (task);
+  g_autoptr(GPtrArray) changes = NULL;
+  g_autoptr(GVariant) values = NULL;
+  GError *error = NULL;
+  guint i;
+
+  values = g_task_propagate_pointer (G_TASK (result), &error);
+  if (values == NULL)
+    {
+      /* Don't keep serving values nobody vouched for */
+      cache_forget (cache, (const char * const *) load->unverified);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  changes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+  cache_load (cache, (const char * const *) load->namespaces, values, changes);
+
+  for (i = 0; i < changes->len; i++)
+    {
+      const char *namespace;
+      const char *key;
+      g_autoptr(GVariant) value = NULL;
+
+      g_variant_get (g_ptr_array_index (changes, i), "(&s&smv)", &namespace, &key, &value);
+      cache_dispatch_change (cache, namespace, key, value);
+    }
+
+  if (cache->snapshot_source)
+    {
+      g_source_destroy (cache->snapshot_source);
+      g_clear_pointer (&cache->snapshot_source, g_source_unref);
+    }
+  cache_write_snapshot (cache);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/* Keeps only the namespaces of @values that match @namespaces */
+static GVariant *
+filter_namespaces (GVariant          *values,
+                   const char *const *namespaces)
+{
+  GVariantBuilder builder;
+  GVariantIter iter;
+  GVariant *entry;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+  g_variant_iter_init (&iter, values);
+  while ((entry = g_variant_iter_next_value (&iter)))
+    {
+      const char *namespace;
+
+      g_variant_get_child (entry, 0, "&s", &namespace);
+      if (namespaces == NULL || namespaces[0] == NULL ||
+          namespace_matches_any (namespaces, namespace))
+        g_variant_builder_add_value (&builder, entry);
+
+      g_variant_unref (entry);
+    }
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/**
+ * xdp_settings_enable_cache_from_snapshot:
+ * @settings: the [class@Settings] object.
+ * @namespaces: (nullable): List of namespaces to cache, as for
+ *   [method@Settings.enable_cache]
+ * @cancellable: (nullable): optional [class@Gio.Cancellable]
+ * @callback: (scope async): a callback to call when the values were
+ *   revalidated
+ * @data: (closure): data to pass to @callback
+ *
+ * Caches the values within @namespaces like
+ * [method@Settings.enable_cache_async], but first fills the cache from
+ * a snapshot of the values the last run saw, if there is one.
+ *
+ * Reads within @namespaces are served from the snapshot as soon as this
+ * function returns, so applications can render their first frame with
+ * the right appearance without waiting for the portal. The values are
+ * then revalidated against the portal, and [signal@Settings::changed]
+ * is emitted for every value that differs from the snapshot, and with a
+ * %NULL value for every setting the portal no longer has. If the
+ * revalidation fails, reads within @namespaces go to the portal again.
+ *
+ * The snapshot is kept in the user cache directory, and updated when
+ * the values within @namespaces change.
+ *
+ * When the values were revalidated, @callback will be called. You can
+ * then call [method@Settings.enable_cache_from_snapshot_finish] to get
+ * the results.
+ *
+ * Since: 0.9
+ */
+void
+xdp_settings_enable_cache_from_snapshot (XdpSettings         *settings,
+                                         const char *const   *namespaces,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             data)
+{
+  static const char *const all[] = { "", NULL };
+  XdpSettingsCache *cache;
+  g_autoptr(GVariant) snapshot = NULL;
+  SnapshotLoad *load;
+  GTask *task;
+  GTask *read_task;
+  gsize i;
+
+  g_return_if_fail (XDP_IS_SETTINGS (settings));
+
+  cache = settings->portal->settings_cache;
+
+  load = g_new0 (SnapshotLoad, 1);
+  load->namespaces = g_strdupv ((char **) namespaces);
+
+  task = g_task_new (settings, cancellable, callback, data);
+  g_task_set_source_tag (task, xdp_settings_enable_cache_from_snapshot);
+  g_task_set_task_data (task, load, (GDestroyNotify) snapshot_load_free);
+
+  cache_begin_loading (cache);
+
+  if (namespaces == NULL || namespaces[0] == NULL)
+    namespaces = all;
+
+  snapshot = _xdp_settings_snapshot_load ();
+  if (snapshot)
+    {
+      g_autoptr(GVariant) values = filter_namespaces (snapshot, namespaces);
+      g_autoptr(GPtrArray) unverified = g_ptr_array_new_with_free_func (g_free);
+      GVariantIter iter;
+      const char *namespace;
+
+      /* Only the namespaces the snapshot has values for are cached now;
+       * reads of the others keep going to the portal until the
+       * revalidation comes back */
+      g_mutex_lock (&cache->lock);
+      g_variant_iter_init (&iter, values);
+      while (g_variant_iter_next (&iter, "{&s@a{sv}}", &namespace, NULL))
+        {
+          if (!namespace_is_cached (cache, namespace))
+            g_ptr_array_add (unverified, g_strdup (namespace));
+        }
+      g_mutex_unlock (&cache->lock);
+      g_ptr_array_add (unverified, NULL);
+      load->unverified = (GStrv) g_ptr_array_free (g_steal_pointer (&unverified), FALSE);
+
+      /* Values the cache already has are newer than the snapshot */
+      if (load->unverified[0] != NULL)
+        {
+          g_autoptr(GVariant) unverified_values = NULL;
+
+          unverified_values = filter_namespaces (values, (const char * const *) load->unverified);
+          cache_load (cache, (const char * const *) load->unverified, unverified_values, NULL);
+        }
+    }
+
+  g_mutex_lock (&cache->lock);
+  for (i = 0; namespaces[i]; i++)
+    {
+      if (!g_ptr_array_find_with_equal_func (cache->snapshot_namespaces, namespaces[i], g_str_equal, NULL))
+        g_ptr_array_add (cache->snapshot_namespaces, g_strdup (namespaces[i]));
+    }
+  g_mutex_unlock (&cache->lock);
+
+  read_task = g_task_new (settings, cancellable, snapshot_revalidated, task);
+  read_all_from_portal (settings, (const char * const *) load->namespaces, read_task);
+}
+
+/**
+ * xdp_settings_enable_cache_from_snapshot_finish:
+ * @settings: the [class@Settings] object.
+ * @result: a [iface@Gio.AsyncResult]
+ * @error: return location for error or NULL.
+ *
+ * Finishes a revalidation started with
+ * [method@Settings.enable_cache_from_snapshot].
+ *
+ * Returns: %TRUE if the values were revalidated
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_settings_enable_cache_from_snapshot_finish (XdpSettings   *settings,
+                                                GAsyncResult  *result,
+                                                GError       **error)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, settings), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == xdp_settings_enable_cache_from_snapshot, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+appearance_retried (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      data)
+{
+  XdpSettings *settings = XDP_SETTINGS (source);
+  XdpSettingsCache *cache = settings->portal->settings_cache;
+  g_autoptr(GError) error = NULL;
+
+  /* On success, cache_load() has set appearance_loaded and notified
+   * the appearance properties */
+  if (!xdp_settings_enable_cache_finish (settings, result, &error))
+    g_debug ("Failed to read appearance settings: %s", error->message);
+
+  g_mutex_lock (&cache->lock);
+  cache->appearance_retrying = FALSE;
+  if (cache->appearance_loaded)
+    cache->appearance_failed = FALSE;
+  g_mutex_unlock (&cache->lock);
+}
+
+/* Loads the appearance in the background after it failed to load,
+ * when there is reason to think the portal can answer now */
+static void
+cache_retry_appearance (XdpSettingsCache *cache)
+{
+  static const char *const namespaces[] = { APPEARANCE_NAMESPACE, NULL };
+  g_autoptr(XdpSettings) settings = NULL;
+
+  g_mutex_lock (&cache->lock);
+  if (cache->appearance_failed && !cache->appearance_retrying && cache->instances)
+    {
+      cache->appearance_retrying = TRUE;
+      settings = g_object_ref (cache->instances->data);
+    }
+  g_mutex_unlock (&cache->lock);
+
+  if (settings)
+    xdp_settings_enable_cache_async (settings, namespaces, NULL, appearance_retried, NULL);
+}
+
+/*
+ * _xdp_settings_cache_name_owner_changed:
+ *
+ * Called when the portal gets a new owner, which may be able to answer
+ * where the previous one couldn't.
+ */
+void
+_xdp_settings_cache_name_owner_changed (XdpSettingsCache *cache,
+                                        const char       *new_owner)
+{
+  if (new_owner != NULL && new_owner[0] != '\0')
+    cache_retry_appearance (cache);
+}
+
+static XdpSettingsCache *
+ensure_appearance (XdpSettings *settings)
+{
+  const char *namespaces[] = { APPEARANCE_NAMESPACE, NULL };
+  XdpSettingsCache *cache = settings->portal->settings_cache;
+  g_autoptr(GError) error = NULL;
+  gboolean failed;
+
+  if (G_LIKELY (cache->appearance_loaded))
+    return cache;
+
+  g_mutex_lock (&cache->lock);
+  failed = cache->appearance_failed;
+  g_mutex_unlock (&cache->lock);
+
+  if (failed)
+    return cache;
+
+  /* On success, cache_load() sets appearance_loaded. On failure, report
+   * the defaults until cache_retry_appearance() gets through */
+  if (!xdp_settings_enable_cache (settings, namespaces, NULL, &error))
+    {
+      g_debug ("Failed to read appearance settings: %s", error->message);
+
+      g_mutex_lock (&cache->lock);
+      cache->appearance_failed = !cache->appearance_loaded;
+      g_mutex_unlock (&cache->lock);
+    }
+
+  return cache;
+}
+
+/**
+ * xdp_settings_get_color_scheme:
+ * @settings: the [class@Settings] object.
+ *
+ * Gets the color scheme the user prefers.
+ *
+ * Unless `org.freedesktop.appearance` is already cached, the first
+ * call blocks the calling thread on a synchronous D-Bus call to the
+ * portal. This also applies to the first read of the appearance
+ * properties, including through g_object_get(). After that, this is a
+ * plain memory read. If the portal can't be reached, the defaults are
+ * returned without blocking again, and the appearance settings are
+ * loaded in the background once the portal restarts or reports a
+ * change. Use [method@Settings.enable_cache_async] to load them without
+ * blocking.
+ *
+ * Returns: the preferred color scheme
+ *
+ * Since: 0.9
+ */
+XdpColorScheme
+xdp_settings_get_color_scheme (XdpSettings *settings)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), XDP_COLOR_SCHEME_NO_PREFERENCE);
+
+  return ensure_appearance (settings)->appearance.color_scheme;
+}
+
+/**
+ * xdp_settings_get_accent_color:
+ * @settings: the [class@Settings] object.
+ * @red: (out) (optional): return location for the red component
+ * @green: (out) (optional): return location for the green component
+ * @blue: (out) (optional): return location for the blue component
+ *
+ * Gets the accent color the user prefers, with components in the
+ * range [0, 1]. See [method@Settings.get_color_scheme] for when this
+ * reads from the portal.
+ *
+ * Returns: %TRUE if the user has an accent color preference
+ *
+ * Since: 0.9
+ */
+gboolean
+xdp_settings_get_accent_color (XdpSettings *settings,
+                               double      *red,
+                               double      *green,
+                               double      *blue)
+{
+  const Appearance *appearance;
+
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), FALSE);
+
+  appearance = &ensure_appearance (settings)->appearance;
+  if (!appearance->has_accent_color)
+    return FALSE;
+
+  if (red)
+    *red = appearance->accent_color[0];
+  if (green)
+    *green = appearance->accent_color[1];
+  if (blue)
+    *blue = appearance->accent_color[2];
+
+  return TRUE;
+}
+
+/**
+ * xdp_settings_get_contrast:
+ * @settings: the [class@Settings] object.
+ *
+ * Gets the contrast the user prefers. See
+ * [method@Settings.get_color_scheme] for when this reads from the
+ * portal.
+ *
+ * Returns: the preferred contrast
+ *
+ * Since: 0.9
+ */
+XdpContrast
+xdp_settings_get_contrast (XdpSettings *settings)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), XDP_CONTRAST_NO_PREFERENCE);
+
+  return ensure_appearance (settings)->appearance.contrast;
+}
+
+/**
+ * xdp_settings_get_reduced_motion:
+ * @settings: the [class@Settings] object.
+ *
+ * Gets whether the user prefers reduced motion. See
+ * [method@Settings.get_color_scheme] for when this reads from the
+ * portal.
+ *
+ * Returns: the reduced motion preference
+ *
+ * Since: 0.9
+ */
+XdpReducedMotion
+xdp_settings_get_reduced_motion (XdpSettings *settings)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), XDP_REDUCED_MOTION_NO_PREFERENCE);
+
+  return ensure_appearance (settings)->appearance.reduced_motion;
+}
+
+/**
+ * xdp_settings_create_backend:
+ * @settings: the [class@Settings] object.
+ *
+ * Creates a read-only [class@Gio.SettingsBackend] for the settings
+ * exposed by the portal, to use with g_settings_new_with_backend().
+ *
+ * The settings of a schema with the path `/org/gnome/desktop/interface/`
+ * are read from the `org.gnome.desktop.interface` namespace of the
+ * portal. Each namespace is loaded with a single call to the portal,
+ * after which lookups are answered from memory. Change notifications
+ * of the portal are forwarded to the [class@Gio.Settings] objects
+ * using the backend. Writes are rejected, and all keys are reported as
+ * not writable.
+ *
+ * Returns: (transfer full): a new [class@Gio.SettingsBackend]
+ *
+ * Since: 0.9
+ */
+GSettingsBackend *
+xdp_settings_create_backend (XdpSettings *settings)
+{
+  g_return_val_if_fail (XDP_IS_SETTINGS (settings), NULL);
+
+  return _xdp_settings_backend_new (settings->portal);
+}
+
+XdpSettings *
+_xdp_settings_new (XdpPortal *portal)
+{
+  XdpSettings *settings;
+
+  if (portal->settings_cache == NULL)
+    portal->settings_cache = settings_cache_new (portal);
 
   settings = g_object_new (XDP_TYPE_SETTINGS, NULL);
   settings->portal = g_object_ref (portal);
 
-  settings->signal_id = g_dbus_connection_signal_subscribe (portal->bus,
-                                                            PORTAL_BUS_NAME,
-                                                            SETTINGS_INTERFACE,
-                                                            "SettingChanged",
-                                                            PORTAL_OBJECT_PATH,
-                                                            NULL,
-                                                            G_DBUS_SIGNAL_FLAGS_NONE,
-                                                            settings_changed,
-                                                            settings,
-                                                            NULL);
+  portal->settings_cache->instances = g_list_prepend (portal->settings_cache->instances, settings);
+  cache_acquire_all (portal->settings_cache);
+
   return settings;
 }
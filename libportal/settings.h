@@ -26,6 +26,50 @@
 
 G_BEGIN_DECLS
 
+/**
+ * XdpColorScheme:
+ * @XDP_COLOR_SCHEME_NO_PREFERENCE: No preference
+ * @XDP_COLOR_SCHEME_PREFER_DARK: Prefer a dark appearance
+ * @XDP_COLOR_SCHEME_PREFER_LIGHT: Prefer a light appearance
+ *
+ * The values of the `color-scheme` key of `org.freedesktop.appearance`.
+ *
+ * Since: 0.9
+ */
+typedef enum {
+  XDP_COLOR_SCHEME_NO_PREFERENCE,
+  XDP_COLOR_SCHEME_PREFER_DARK,
+  XDP_COLOR_SCHEME_PREFER_LIGHT
+} XdpColorScheme;
+
+/**
+ * XdpContrast:
+ * @XDP_CONTRAST_NO_PREFERENCE: No preference
+ * @XDP_CONTRAST_HIGH: Prefer higher contrast
+ *
+ * The values of the `contrast` key of `org.freedesktop.appearance`.
+ *
+ * Since: 0.9
+ */
+typedef enum {
+  XDP_CONTRAST_NO_PREFERENCE,
+  XDP_CONTRAST_HIGH
+} XdpContrast;
+
+/**
+ * XdpReducedMotion:
+ * @XDP_REDUCED_MOTION_NO_PREFERENCE: No preference
+ * @XDP_REDUCED_MOTION_REDUCED: Prefer reduced motion
+ *
+ * The values of the `reduced-motion` key of `org.freedesktop.appearance`.
+ *
+ * Since: 0.9
+ */
+typedef enum {
+  XDP_REDUCED_MOTION_NO_PREFERENCE,
+  XDP_REDUCED_MOTION_REDUCED
+} XdpReducedMotion;
+
 #define XDP_TYPE_SETTINGS (xdp_settings_get_type ())
 
 XDP_PUBLIC
@@ -50,4 +94,127 @@ char *xdp_settings_read_string (XdpSettings *settings, const char *namespace, co
 XDP_PUBLIC
 GVariant *xdp_settings_read_all_values (XdpSettings *settings, const char *const *namespaces, GCancellable *cancellable, GError **error);
 
+XDP_PUBLIC
+void      xdp_settings_read_value_async       (XdpSettings         *settings,
+                                               const char          *namespace,
+                                               const char          *key,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+GVariant *xdp_settings_read_value_finish      (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
+XDP_PUBLIC
+void      xdp_settings_read_uint_async        (XdpSettings         *settings,
+                                               const char          *namespace,
+                                               const char          *key,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+guint32   xdp_settings_read_uint_finish       (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
+XDP_PUBLIC
+void      xdp_settings_read_string_async      (XdpSettings         *settings,
+                                               const char          *namespace,
+                                               const char          *key,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+char     *xdp_settings_read_string_finish     (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
+XDP_PUBLIC
+void      xdp_settings_read_all_values_async  (XdpSettings         *settings,
+                                               const char *const   *namespaces,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+GVariant *xdp_settings_read_all_values_finish (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
+XDP_PUBLIC
+GVariant *xdp_settings_read_keys (XdpSettings *settings, GVariant *keys, GCancellable *cancellable, GError **error);
+
+XDP_PUBLIC
+void      xdp_settings_read_keys_async        (XdpSettings         *settings,
+                                               GVariant            *keys,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+GVariant *xdp_settings_read_keys_finish       (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
+XDP_PUBLIC
+guint xdp_settings_watch (XdpSettings *settings, const char *namespace, const char *key);
+
+XDP_PUBLIC
+void xdp_settings_unwatch (XdpSettings *settings, guint watch_id);
+
+XDP_PUBLIC
+void xdp_settings_enable_batching (XdpSettings *settings, guint window_ms);
+
+XDP_PUBLIC
+void xdp_settings_disable_batching (XdpSettings *settings);
+
+XDP_PUBLIC
+void      xdp_settings_enable_cache_from_snapshot        (XdpSettings         *settings,
+                                                          const char *const   *namespaces,
+                                                          GCancellable        *cancellable,
+                                                          GAsyncReadyCallback  callback,
+                                                          gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_settings_enable_cache_from_snapshot_finish (XdpSettings         *settings,
+                                                          GAsyncResult        *result,
+                                                          GError             **error);
+
+XDP_PUBLIC
+XdpColorScheme   xdp_settings_get_color_scheme   (XdpSettings *settings);
+
+XDP_PUBLIC
+gboolean         xdp_settings_get_accent_color   (XdpSettings *settings,
+                                                  double      *red,
+                                                  double      *green,
+                                                  double      *blue);
+
+XDP_PUBLIC
+XdpContrast      xdp_settings_get_contrast       (XdpSettings *settings);
+
+XDP_PUBLIC
+XdpReducedMotion xdp_settings_get_reduced_motion (XdpSettings *settings);
+
+XDP_PUBLIC
+GSettingsBackend *xdp_settings_create_backend (XdpSettings *settings);
+
+XDP_PUBLIC
+gboolean xdp_settings_enable_cache (XdpSettings *settings, const char *const *namespaces, GCancellable *cancellable, GError **error);
+
+XDP_PUBLIC
+void      xdp_settings_enable_cache_async     (XdpSettings         *settings,
+                                               const char *const   *namespaces,
+                                               GCancellable        *cancellable,
+                                               GAsyncReadyCallback  callback,
+                                               gpointer             data);
+
+XDP_PUBLIC
+gboolean  xdp_settings_enable_cache_finish    (XdpSettings         *settings,
+                                               GAsyncResult        *result,
+                                               GError             **error);
+
 G_END_DECLS
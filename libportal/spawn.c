@@ -108,7 +108,7 @@ ensure_spawn_exited_connection (XdpPortal *portal)
   if (portal->spawn_exited_signal == 0)
     {
       portal->spawn_exited_signal =
-         g_dbus_connection_signal_subscribe (portal->bus,
+         g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                              FLATPAK_PORTAL_BUS_NAME,
                                              FLATPAK_PORTAL_INTERFACE,
                                              "SpawnExited",
@@ -164,7 +164,7 @@ do_spawn (SpawnCall *call)
     g_variant_builder_add (&env_builder, "{sv}", "sandbox-expose-ro",
                            g_variant_new_strv ((const char *const*)call->sandbox_expose_ro, -1));
 
-  g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
+  g_dbus_connection_call_with_unix_fd_list (_xdp_portal_get_bus (call->portal),
                                             FLATPAK_PORTAL_BUS_NAME,
                                             FLATPAK_PORTAL_OBJECT_PATH,
                                             FLATPAK_PORTAL_INTERFACE,
@@ -293,7 +293,7 @@ xdp_portal_spawn_signal (XdpPortal *portal,
 {
   g_return_if_fail (XDP_IS_PORTAL (portal));
 
-  g_dbus_connection_call (portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (portal),
                           FLATPAK_PORTAL_BUS_NAME,
                           FLATPAK_PORTAL_OBJECT_PATH,
                           FLATPAK_PORTAL_INTERFACE,
@@ -103,7 +103,7 @@ trash_file (TrashCall *call)
 
   cancellable = g_task_get_cancellable (call->task);
 
-  g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
+  g_dbus_connection_call_with_unix_fd_list (_xdp_portal_get_bus (call->portal),
                                             PORTAL_BUS_NAME,
                                             PORTAL_OBJECT_PATH,
                                             "org.freedesktop.portal.Trash",
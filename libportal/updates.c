@@ -114,7 +114,7 @@ ensure_update_monitor_connection (XdpPortal *portal)
 {
   if (portal->update_available_signal == 0)
     portal->update_available_signal =
-       g_dbus_connection_signal_subscribe (portal->bus,
+       g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                            FLATPAK_PORTAL_BUS_NAME,
                                            UPDATE_MONITOR_INTERFACE,
                                            "UpdateAvailable",
@@ -127,7 +127,7 @@ ensure_update_monitor_connection (XdpPortal *portal)
 
   if (portal->update_progress_signal == 0)
     portal->update_progress_signal =
-       g_dbus_connection_signal_subscribe (portal->bus,
+       g_dbus_connection_signal_subscribe (_xdp_portal_get_bus (portal),
                                            FLATPAK_PORTAL_BUS_NAME,
                                            UPDATE_MONITOR_INTERFACE,
                                            "Progress",
@@ -177,14 +177,14 @@ create_monitor (CreateMonitorCall *call)
       return;
     }
 
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->id = g_strconcat (UPDATE_MONITOR_PATH_PREFIX, call->portal->sender, "/", token, NULL);
+  token = _xdp_portal_new_token (call->portal);
+  call->id = g_strconcat (UPDATE_MONITOR_PATH_PREFIX, _xdp_portal_get_sender (call->portal), "/", token, NULL);
 
   cancellable = g_task_get_cancellable (call->task);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
   g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           FLATPAK_PORTAL_BUS_NAME,
                           FLATPAK_PORTAL_OBJECT_PATH,
                           FLATPAK_PORTAL_INTERFACE,
@@ -272,19 +272,19 @@ xdp_portal_update_monitor_stop (XdpPortal *portal)
 
   if (portal->update_available_signal)
     {
-      g_dbus_connection_signal_unsubscribe (portal->bus, portal->update_available_signal);
+      g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (portal), portal->update_available_signal);
       portal->update_available_signal = 0;
     }
 
   if (portal->update_progress_signal)
     {
-      g_dbus_connection_signal_unsubscribe (portal->bus, portal->update_progress_signal);
+      g_dbus_connection_signal_unsubscribe (_xdp_portal_get_bus (portal), portal->update_progress_signal);
       portal->update_progress_signal = 0;
     }
 
   if (portal->update_monitor_handle)
     {
-      g_dbus_connection_call (portal->bus,
+      g_dbus_connection_call (_xdp_portal_get_bus (portal),
                               FLATPAK_PORTAL_BUS_NAME,
                               portal->update_monitor_handle,
                               UPDATE_MONITOR_INTERFACE,
@@ -370,7 +370,7 @@ install_update (InstallUpdateCall *call)
   cancellable = g_task_get_cancellable (call->task);
 
   g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_dbus_connection_call (call->portal->bus,
+  g_dbus_connection_call (_xdp_portal_get_bus (call->portal),
                           FLATPAK_PORTAL_BUS_NAME,
                           call->portal->update_monitor_handle,
                           UPDATE_MONITOR_INTERFACE,
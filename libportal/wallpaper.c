@@ -30,139 +30,7 @@
 #include <glib/gstdio.h>
 #include <gio/gunixfdlist.h>
 
-#include "portal-private.h"
-
-typedef struct {
-  XdpPortal *portal;
-  XdpParent *parent;
-  char *parent_handle;
-  char *uri;
-  gboolean show_preview;
-  XdpWallpaperFlags target;
-  guint signal_id;
-  GTask *task;
-  char *request_path;
-  guint cancelled_id;
-} WallpaperCall;
-
-static void
-wallpaper_call_free (WallpaperCall *call)
-{
-  if (call->parent)
-    {
-      call->parent->parent_unexport (call->parent);
-      xdp_parent_free (call->parent);
-    }
-  g_free (call->parent_handle);
-
-  if (call->signal_id)
-    g_dbus_connection_signal_unsubscribe (call->portal->bus, call->signal_id);
-
-  if (call->cancelled_id)
-    g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-
-  g_free (call->request_path);
-
-  g_object_unref (call->portal);
-  g_object_unref (call->task);
-  g_free (call->uri);
-
-  g_free (call);
-}
-
-static void
-response_received (GDBusConnection *bus,
-                   const char *sender_name,
-                   const char *object_path,
-                   const char *interface_name,
-                   const char *signal_name,
-                   GVariant *parameters,
-                   gpointer data)
-{
-  WallpaperCall *call = data;
-  guint32 response;
-  g_autoptr(GVariant) ret = NULL;
-
-  if (call->cancelled_id)
-    {
-      g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-      call->cancelled_id = 0;
-    }
-
-  g_variant_get (parameters, "(u@a{sv})", &response, &ret);
-
-  if (response == 0)
-    g_task_return_boolean (call->task, TRUE);
-  else if (response == 1)
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "SetWallpaper canceled");
-  else
-    g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "SetWallpaper failed");
-
-  wallpaper_call_free (call);
-}
-
-static void set_wallpaper (WallpaperCall *call);
-
-static void
-parent_exported (XdpParent *parent,
-                 const char *handle,
-                 gpointer data)
-{
-  WallpaperCall *call = data;
-  call->parent_handle = g_strdup (handle);
-  set_wallpaper (call);
-}
-
-static void
-cancelled_cb (GCancellable *cancellable,
-              gpointer data)
-{
-  WallpaperCall *call = data;
-
-  g_dbus_connection_call (call->portal->bus,
-                          PORTAL_BUS_NAME,
-                          call->request_path,
-                          REQUEST_INTERFACE,
-                          "Close",
-                          NULL,
-                          NULL,
-                          G_DBUS_CALL_FLAGS_NONE,
-                          -1,
-                          NULL, NULL, NULL);
-
-  g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "SetWallpaper call canceled by caller");
-
-  wallpaper_call_free (call);
-}
-
-static void
-call_returned (GObject *object,
-               GAsyncResult *result,
-               gpointer data)
-{
-  WallpaperCall *call = data;
-  GError *error = NULL;
-  g_autoptr(GVariant) ret = NULL;
-  g_autoptr(GFile) file = NULL;
-
-  file = g_file_new_for_uri (call->uri);
-  if (g_file_is_native (file))
-    ret = g_dbus_connection_call_with_unix_fd_list_finish (G_DBUS_CONNECTION (object), NULL, result, &error);
-  else
-    ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (object), result, &error);
-
-  if (error)
-    {
-      if (call->cancelled_id)
-        {
-          g_signal_handler_disconnect (g_task_get_cancellable (call->task), call->cancelled_id);
-          call->cancelled_id = 0;
-        }
-
-      g_task_return_error (call->task, error);
-      wallpaper_call_free (call);
-    }
-}
+#include "request-private.h"
 
 #ifndef O_PATH
 #define O_PATH 0
@@ -185,96 +53,6 @@ target_to_string (XdpWallpaperFlags target)
     }
 }
 
-static void
-set_wallpaper (WallpaperCall *call)
-{
-  GVariantBuilder options;
-  g_autofree char *token = NULL;
-  g_autoptr(GFile) file = NULL;
-  GCancellable *cancellable;
-
-  if (call->parent_handle == NULL)
-    {
-      call->parent->parent_export (call->parent, parent_exported, call);
-      return;
-    }
-
-  token = g_strdup_printf ("portal%d", g_random_int_range (0, G_MAXINT));
-  call->request_path = g_strconcat (REQUEST_PATH_PREFIX, call->portal->sender, "/", token, NULL);
-  call->signal_id = g_dbus_connection_signal_subscribe (call->portal->bus,
-                                                        PORTAL_BUS_NAME,
-                                                        REQUEST_INTERFACE,
-                                                        "Response",
-                                                        call->request_path,
-                                                        NULL,
-                                                        G_DBUS_SIGNAL_FLAGS_NO_MATCH_RULE,
-                                                        response_received,
-                                                        call,
-                                                        NULL);
-
-  cancellable = g_task_get_cancellable (call->task);
-  if (cancellable)
-    call->cancelled_id = g_signal_connect (cancellable, "cancelled", G_CALLBACK (cancelled_cb), call);
-
-  g_variant_builder_init (&options, G_VARIANT_TYPE_VARDICT);
-  g_variant_builder_add (&options, "{sv}", "handle_token", g_variant_new_string (token));
-  g_variant_builder_add (&options, "{sv}", "show-preview", g_variant_new_boolean (call->show_preview));
-  g_variant_builder_add (&options, "{sv}", "set-on", g_variant_new_string (target_to_string (call->target)));
-
-  file = g_file_new_for_uri (call->uri);
-
-  if (g_file_is_native (file))
-    {
-      g_autoptr(GUnixFDList) fd_list = NULL;
-      g_autofree char *path = NULL;
-      int fd, fd_in;
-
-      path = g_file_get_path (file);
-
-      fd = g_open (path, O_PATH | O_CLOEXEC);
-      if (fd == -1)
-        {
-          g_task_return_new_error (call->task, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open '%s'", call->uri);
-          wallpaper_call_free (call);
-
-          return;
-        }
-
-      fd_list = g_unix_fd_list_new_from_array (&fd, 1);
-      fd = -1;
-      fd_in = 0;
-
-      g_dbus_connection_call_with_unix_fd_list (call->portal->bus,
-                                                PORTAL_BUS_NAME,
-                                                PORTAL_OBJECT_PATH,
-                                                "org.freedesktop.portal.Wallpaper",
-                                                "SetWallpaperFile",
-                                                g_variant_new ("(sha{sv})", call->parent_handle, fd_in, &options),
-                                                G_VARIANT_TYPE ("(o)"),
-                                                G_DBUS_CALL_FLAGS_NONE,
-                                                -1,
-                                                fd_list,
-                                                NULL,
-                                                call_returned,
-                                                call);
-    }
-  else
-    {
-      g_dbus_connection_call (call->portal->bus,
-                              PORTAL_BUS_NAME,
-                              PORTAL_OBJECT_PATH,
-                              "org.freedesktop.portal.Wallpaper",
-                              "SetWallpaperURI",
-                              g_variant_new ("(ssa{sv})", call->parent_handle, call->uri, &options),
-                              G_VARIANT_TYPE ("(o)"),
-                              G_DBUS_CALL_FLAGS_NONE,
-                              -1,
-                              NULL,
-                              call_returned,
-                              call);
-    }
-}
-
 /**
  * xdp_portal_set_wallpaper:
  * @portal: a [class@Portal]
@@ -296,26 +74,59 @@ xdp_portal_set_wallpaper (XdpPortal           *portal,
                           GAsyncReadyCallback  callback,
                           gpointer             data)
 {
-  WallpaperCall *call = NULL;
+  g_autoptr(GFile) file = NULL;
+  XdpRequest *request;
+  XdpWallpaperFlags target;
 
   g_return_if_fail (XDP_IS_PORTAL (portal));
   g_return_if_fail ((flags & ~(XDP_WALLPAPER_FLAG_BACKGROUND |
                                XDP_WALLPAPER_FLAG_LOCKSCREEN |
                                XDP_WALLPAPER_FLAG_PREVIEW)) == 0); 
 
-  call = g_new0 (WallpaperCall, 1);
-  call->portal = g_object_ref (portal);
-  if (parent)
-    call->parent = xdp_parent_copy (parent);
+  file = g_file_new_for_uri (uri);
+
+  if (g_file_is_native (file))
+    {
+      g_autoptr(GUnixFDList) fd_list = NULL;
+      g_autofree char *path = NULL;
+      int fd;
+
+      path = g_file_get_path (file);
+
+      fd = g_open (path, O_PATH | O_CLOEXEC);
+      if (fd == -1)
+        {
+          g_task_report_new_error (portal, callback, data, xdp_portal_set_wallpaper,
+                                   G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to open '%s'", uri);
+          return;
+        }
+
+      fd_list = g_unix_fd_list_new_from_array (&fd, 1);
+
+      request = _xdp_request_new (portal, parent,
+                                  "org.freedesktop.portal.Wallpaper",
+                                  "SetWallpaperFile",
+                                  cancellable, callback, data,
+                                  xdp_portal_set_wallpaper);
+      _xdp_request_set_args (request, g_variant_new ("(h)", 0), fd_list);
+    }
   else
-    call->parent_handle = g_strdup ("");
-  call->uri = g_strdup (uri);
-  call->show_preview = (flags & XDP_WALLPAPER_FLAG_PREVIEW) != 0;
-  call->target = flags & (XDP_WALLPAPER_FLAG_BACKGROUND | XDP_WALLPAPER_FLAG_LOCKSCREEN);
-  call->task = g_task_new (portal, cancellable, callback, data);
-  g_task_set_source_tag (call->task, xdp_portal_set_wallpaper);
+    {
+      request = _xdp_request_new (portal, parent,
+                                  "org.freedesktop.portal.Wallpaper",
+                                  "SetWallpaperURI",
+                                  cancellable, callback, data,
+                                  xdp_portal_set_wallpaper);
+      _xdp_request_set_args (request, g_variant_new ("(s)", uri), NULL);
+    }
+
+  target = flags & (XDP_WALLPAPER_FLAG_BACKGROUND | XDP_WALLPAPER_FLAG_LOCKSCREEN);
+
+  g_variant_builder_add (&request->options, "{sv}", "show-preview", g_variant_new_boolean ((flags & XDP_WALLPAPER_FLAG_PREVIEW) != 0));
+  g_variant_builder_add (&request->options, "{sv}", "set-on", g_variant_new_string (target_to_string (target)));
+  request->response_func = _xdp_request_return_boolean;
 
-  set_wallpaper (call);
+  _xdp_request_send (request);
 }
 
 /**
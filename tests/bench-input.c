@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+/* Measures how long remote desktop input events take from the call in
+ * the application to the session bus while the main loop of the
+ * application is busy: once with events marshalled to the main context,
+ * as callers of the non-thread-safe API have to, and once with
+ * xdp_session_enable_input_thread(). Needs a running xdg-desktop-portal
+ * with a RemoteDesktop backend, and the session has to be allowed when
+ * asked; it is skipped otherwise. */
+
+#include <string.h>
+
+#include <libportal/portal.h>
+
+#define SKIP 77
+
+static gint n_events = 500;
+static gint load_ms = 8;
+
+static GOptionEntry entries[] = {
+  { "events", 'n', 0, G_OPTION_ARG_INT, &n_events, "Number of events", "N" },
+  { "load", 'l', 0, G_OPTION_ARG_INT, &load_ms, "Milliseconds the main loop is blocked at a time", "MS" },
+  { NULL }
+};
+
+static GMainLoop *loop;
+static XdpSession *session;
+static GError *session_error;
+static gboolean use_main_context;
+static gint64 *pushed;
+static gint64 *sent;
+
+static void
+session_created (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  session = xdp_portal_create_remote_desktop_session_finish (XDP_PORTAL (object), result, &session_error);
+  g_main_loop_quit (loop);
+}
+
+static void
+session_started (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  xdp_session_start_finish (XDP_SESSION (object), result, &session_error);
+  g_main_loop_quit (loop);
+}
+
+static GDBusMessage *
+filter_message (GDBusConnection *bus,
+                GDBusMessage    *message,
+                gboolean         incoming,
+                gpointer         data)
+{
+  GVariant *body;
+  double x, y;
+  guint stream;
+  const char *path;
+
+  if (incoming || g_strcmp0 (g_dbus_message_get_member (message), "NotifyPointerMotionAbsolute") != 0)
+    return message;
+
+  body = g_dbus_message_get_body (message);
+  g_variant_get (body, "(&o@a{sv}udd)", &path, NULL, &stream, &x, &y);
+  if (x >= 0 && x < n_events)
+    sent[(guint) x] = g_get_monotonic_time ();
+
+  return message;
+}
+
+static gboolean
+block_main_loop (gpointer data)
+{
+  g_usleep (load_ms * G_TIME_SPAN_MILLISECOND);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+send_position (gpointer data)
+{
+  xdp_session_pointer_position (session, 0, GPOINTER_TO_INT (data), 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+produce_events (gpointer data)
+{
+  gint i;
+
+  for (i = 0; i < n_events; i++)
+    {
+      pushed[i] = g_get_monotonic_time ();
+      if (use_main_context)
+        g_main_context_invoke (NULL, send_position, GINT_TO_POINTER (i));
+      else
+        xdp_session_pointer_position (session, 0, i, 0);
+
+      g_usleep (G_TIME_SPAN_MILLISECOND);
+    }
+
+  /* Leave time for the last events to go out */
+  g_usleep (4 * load_ms * G_TIME_SPAN_MILLISECOND);
+  g_main_loop_quit (loop);
+
+  return NULL;
+}
+
+static void
+run (const char *what)
+{
+  g_autoptr(GThread) producer = NULL;
+  gint64 total = 0, max = 0;
+  gint n_sent = 0;
+  gint i;
+  guint id;
+
+  memset (sent, 0, n_events * sizeof (gint64));
+
+  id = g_timeout_add (1, block_main_loop, NULL);
+  producer = g_thread_new ("producer", produce_events, NULL);
+  g_main_loop_run (loop);
+  g_thread_join (g_steal_pointer (&producer));
+  g_source_remove (id);
+
+  for (i = 0; i < n_events; i++)
+    {
+      gint64 latency;
+
+      if (sent[i] == 0)
+        continue;
+
+      latency = sent[i] - pushed[i];
+      total += latency;
+      max = MAX (max, latency);
+      n_sent++;
+    }
+
+  if (n_sent == 0)
+    {
+      g_print ("%-24s no events sent\n", what);
+      return;
+    }
+
+  g_print ("%-24s %10.1f µs mean %10" G_GINT64_FORMAT " µs max (%d/%d sent)\n",
+           what, (double) total / n_sent, max, n_sent, n_events);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(XdpPortal) portal = NULL;
+  g_autoptr(GDBusConnection) bus = NULL;
+  g_autoptr(GError) error = NULL;
+
+  context = g_option_context_new ("- benchmark remote desktop input latency");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+
+  if (n_events <= 0 || load_ms < 0)
+    {
+      g_printerr ("The number of events must be positive and the load not negative\n");
+      return 1;
+    }
+
+  portal = xdp_portal_initable_new (&error);
+  if (portal == NULL)
+    {
+      g_printerr ("No session bus, skipping: %s\n", error->message);
+      return SKIP;
+    }
+
+  loop = g_main_loop_new (NULL, FALSE);
+
+  xdp_portal_create_remote_desktop_session (portal,
+                                            XDP_DEVICE_POINTER,
+                                            XDP_OUTPUT_NONE,
+                                            XDP_REMOTE_DESKTOP_FLAG_NONE,
+                                            XDP_CURSOR_MODE_HIDDEN,
+                                            NULL,
+                                            session_created,
+                                            NULL);
+  g_main_loop_run (loop);
+  if (session == NULL)
+    {
+      g_printerr ("Remote desktop portal unavailable, skipping: %s\n", session_error->message);
+      return SKIP;
+    }
+
+  xdp_session_start (session, NULL, NULL, session_started, NULL);
+  g_main_loop_run (loop);
+  if (session_error)
+    {
+      g_printerr ("Session not started, skipping: %s\n", session_error->message);
+      return SKIP;
+    }
+
+  /* The portal uses the shared session bus connection */
+  bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  g_dbus_connection_add_filter (bus, filter_message, NULL, NULL);
+
+  pushed = g_new0 (gint64, n_events);
+  sent = g_new0 (gint64, n_events);
+
+  use_main_context = TRUE;
+  run ("main context");
+
+  use_main_context = FALSE;
+  xdp_session_enable_input_thread (session);
+  run ("input thread");
+
+  xdp_session_close (session);
+  g_clear_object (&session);
+
+  g_free (pushed);
+  g_free (sent);
+  g_main_loop_unref (loop);
+
+  return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+/* Measures how fast recorded remote desktop input can be replayed: the
+ * sustained rate in events per second at full speed, and how closely a
+ * replay at a given speed keeps to the timing of the recording. The
+ * recording is either loaded from a file, or made on the spot from
+ * synthetic input. Needs a running xdg-desktop-portal with a
+ * RemoteDesktop backend, and the session has to be allowed when asked;
+ * it is skipped otherwise. */
+
+#include <libportal/portal.h>
+
+#define SKIP 77
+
+static guint n_events = 10000;
+static double speed = 1.0;
+static char *input_file;
+static char *output_file;
+
+static GOptionEntry entries[] = {
+  { "events", 'n', 0, G_OPTION_ARG_INT, &n_events, "Number of synthetic events", "N" },
+  { "speed", 's', 0, G_OPTION_ARG_DOUBLE, &speed, "Speed of the paced replay", "FACTOR" },
+  { "input", 'i', 0, G_OPTION_ARG_FILENAME, &input_file, "Replay a recording from FILE", "FILE" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Save the recording to FILE", "FILE" },
+  { NULL }
+};
+
+static GMainLoop *loop;
+static XdpSession *session;
+static GError *session_error;
+static guint n_replayed;
+
+static void
+session_created (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  session = xdp_portal_create_remote_desktop_session_finish (XDP_PORTAL (object), result, &session_error);
+  g_main_loop_quit (loop);
+}
+
+static void
+session_started (GObject      *object,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  xdp_session_start_finish (XDP_SESSION (object), result, &session_error);
+  g_main_loop_quit (loop);
+}
+
+static void
+replayed (GObject      *object,
+          GAsyncResult *result,
+          gpointer      data)
+{
+  g_autoptr(GError) error = NULL;
+
+  if (!xdp_session_replay_finish (XDP_SESSION (object), result, &n_replayed, &error))
+    g_printerr ("Replay failed: %s\n", error->message);
+  g_main_loop_quit (loop);
+}
+
+/* Pointer motion with a click and a key press every 100 events, one
+ * event every 100 µs */
+static GBytes *
+record_synthetic_input (void)
+{
+  guint i;
+
+  xdp_session_start_recording (session);
+  for (i = 0; i < n_events; i++)
+    {
+      if (i % 100 == 98)
+        xdp_session_pointer_button (session, 272, i % 200 < 100 ? XDP_BUTTON_PRESSED : XDP_BUTTON_RELEASED);
+      else if (i % 100 == 99)
+        xdp_session_keyboard_key (session, FALSE, 42, i % 200 < 100 ? XDP_KEY_PRESSED : XDP_KEY_RELEASED);
+      else
+        xdp_session_pointer_motion (session, 1, 0);
+
+      g_usleep (100);
+    }
+
+  return xdp_session_stop_recording (session);
+}
+
+static gint64
+replay (GBytes *recording,
+        double  replay_speed)
+{
+  g_autoptr(GDBusConnection) bus = NULL;
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+  xdp_session_replay (session, recording, replay_speed, NULL, replayed, NULL);
+  g_main_loop_run (loop);
+
+  /* Until the last event is written to the bus */
+  bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  g_dbus_connection_flush_sync (bus, NULL, NULL);
+
+  return g_get_monotonic_time () - start;
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(XdpPortal) portal = NULL;
+  g_autoptr(GMappedFile) mapped = NULL;
+  g_autoptr(GBytes) recording = NULL;
+  g_autoptr(GError) error = NULL;
+  gint64 duration;
+
+  context = g_option_context_new ("- benchmark remote desktop input replay");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error) || speed <= 0)
+    {
+      g_printerr ("%s\n", error ? error->message : "The speed must be greater than 0");
+      return 1;
+    }
+
+  if (input_file)
+    {
+      mapped = g_mapped_file_new (input_file, FALSE, &error);
+      if (mapped == NULL)
+        {
+          g_printerr ("%s\n", error->message);
+          return 1;
+        }
+      recording = g_mapped_file_get_bytes (mapped);
+    }
+
+  portal = xdp_portal_initable_new (&error);
+  if (portal == NULL)
+    {
+      g_printerr ("No session bus, skipping: %s\n", error->message);
+      return SKIP;
+    }
+
+  loop = g_main_loop_new (NULL, FALSE);
+
+  xdp_portal_create_remote_desktop_session (portal,
+                                            XDP_DEVICE_POINTER | XDP_DEVICE_KEYBOARD,
+                                            XDP_OUTPUT_NONE,
+                                            XDP_REMOTE_DESKTOP_FLAG_NONE,
+                                            XDP_CURSOR_MODE_HIDDEN,
+                                            NULL,
+                                            session_created,
+                                            NULL);
+  g_main_loop_run (loop);
+  if (session == NULL)
+    {
+      g_printerr ("Remote desktop portal unavailable, skipping: %s\n", session_error->message);
+      return SKIP;
+    }
+
+  xdp_session_start (session, NULL, NULL, session_started, NULL);
+  g_main_loop_run (loop);
+  if (session_error)
+    {
+      g_printerr ("Session not started, skipping: %s\n", session_error->message);
+      return SKIP;
+    }
+
+  if (recording == NULL)
+    {
+      recording = record_synthetic_input ();
+      if (output_file &&
+          !g_file_set_contents (output_file,
+                                g_bytes_get_data (recording, NULL),
+                                g_bytes_get_size (recording),
+                                &error))
+        g_printerr ("%s\n", error->message);
+    }
+
+  g_print ("recording: %" G_GSIZE_FORMAT " bytes\n", g_bytes_get_size (recording));
+
+  duration = replay (recording, 0);
+  g_print ("%-24s %10u events %12.0f events/s\n",
+           "full speed", n_replayed, n_replayed / (duration / (double) G_USEC_PER_SEC));
+
+  duration = replay (recording, speed);
+  g_print ("%-24s %10u events %12.3f s\n",
+           "paced", n_replayed, duration / (double) G_USEC_PER_SEC);
+
+  xdp_session_close (session);
+  g_clear_object (&session);
+
+  g_main_loop_unref (loop);
+
+  return 0;
+}
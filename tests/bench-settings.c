@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+/* Compares the cost of looking up a setting with xdp_settings_read_value()
+ * against GSettings on top of xdp_settings_create_backend(). Needs a
+ * running xdg-desktop-portal and the org.gnome.desktop.interface schema;
+ * it is skipped otherwise. */
+
+#include <libportal/portal.h>
+#include <libportal/settings.h>
+
+#define SCHEMA_ID "org.gnome.desktop.interface"
+#define NAMESPACE "org.gnome.desktop.interface"
+#define KEY "color-scheme"
+
+#define SKIP 77
+
+static gint n_iterations = 1000;
+
+static GOptionEntry entries[] = {
+  { "iterations", 'n', 0, G_OPTION_ARG_INT, &n_iterations, "Number of lookups", "N" },
+  { NULL }
+};
+
+static void
+report (const char *what,
+        gint64      start,
+        gint64      end)
+{
+  g_print ("%-32s %10.2f µs/lookup\n", what, (double) (end - start) / n_iterations);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(XdpPortal) portal = NULL;
+  g_autoptr(XdpSettings) settings = NULL;
+  g_autoptr(GSettingsBackend) backend = NULL;
+  g_autoptr(GSettingsSchema) schema = NULL;
+  g_autoptr(GSettings) gsettings = NULL;
+  g_autoptr(GVariant) value = NULL;
+  g_autoptr(GError) error = NULL;
+  GSettingsSchemaSource *source;
+  gint64 start;
+  gint i;
+
+  context = g_option_context_new ("- benchmark settings lookups");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+
+  if (n_iterations <= 0)
+    {
+      g_printerr ("The number of lookups must be positive\n");
+      return 1;
+    }
+
+  source = g_settings_schema_source_get_default ();
+  if (source)
+    schema = g_settings_schema_source_lookup (source, SCHEMA_ID, TRUE);
+  if (schema == NULL)
+    {
+      g_printerr ("Schema %s not installed, skipping\n", SCHEMA_ID);
+      return SKIP;
+    }
+
+  portal = xdp_portal_initable_new (&error);
+  if (portal == NULL)
+    {
+      g_printerr ("No session bus, skipping: %s\n", error->message);
+      return SKIP;
+    }
+
+  settings = xdp_portal_get_settings (portal);
+
+  value = xdp_settings_read_value (settings, NAMESPACE, KEY, NULL, &error);
+  if (value == NULL)
+    {
+      g_printerr ("Settings portal unavailable, skipping: %s\n", error->message);
+      return SKIP;
+    }
+  g_clear_pointer (&value, g_variant_unref);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_iterations; i++)
+    {
+      value = xdp_settings_read_value (settings, NAMESPACE, KEY, NULL, NULL);
+      g_clear_pointer (&value, g_variant_unref);
+    }
+  report ("xdp_settings_read_value", start, g_get_monotonic_time ());
+
+  backend = xdp_settings_create_backend (settings);
+  gsettings = g_settings_new_full (schema, backend, NULL);
+
+  /* The first lookup loads the namespace */
+  start = g_get_monotonic_time ();
+  value = g_settings_get_value (gsettings, KEY);
+  g_clear_pointer (&value, g_variant_unref);
+  g_print ("%-32s %10.2f µs\n", "GSettings first lookup", (double) (g_get_monotonic_time () - start));
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < n_iterations; i++)
+    {
+      value = g_settings_get_value (gsettings, KEY);
+      g_clear_pointer (&value, g_variant_unref);
+    }
+  report ("GSettings (portal backend)", start, g_get_monotonic_time ());
+
+  return 0;
+}
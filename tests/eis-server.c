@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2024 GNOME Foundation, Inc.
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.0 of the
+ * License.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-only
+ */
+
+/* A minimal EIS implementation for the tests: it listens on the socket
+ * given on the command line, offers one device with all capabilities to
+ * the first client and prints the events it receives, one per line,
+ * until the client disconnects. A receiver client is sent a fixed set of
+ * events instead, in two emulation sequences. */
+
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <libeis.h>
+
+static bool running = true;
+
+static uint64_t
+now_us (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Mirrors the expectations of test_inputcapture.py */
+static void
+send_events (struct eis_device *device)
+{
+  eis_device_start_emulating (device, 42);
+  eis_device_pointer_motion (device, 1.0, 2.0);
+  eis_device_frame (device, now_us ());
+  eis_device_button_button (device, 272, true);
+  eis_device_frame (device, now_us ());
+  eis_device_stop_emulating (device);
+
+  eis_device_start_emulating (device, 43);
+  eis_device_keyboard_key (device, 30, true);
+  eis_device_frame (device, now_us ());
+  eis_device_stop_emulating (device);
+
+  printf ("sent\n");
+}
+
+static struct eis_device *
+add_device (struct eis_event *event)
+{
+  static const enum eis_device_capability capabilities[] = {
+    EIS_DEVICE_CAP_POINTER,
+    EIS_DEVICE_CAP_POINTER_ABSOLUTE,
+    EIS_DEVICE_CAP_BUTTON,
+    EIS_DEVICE_CAP_SCROLL,
+    EIS_DEVICE_CAP_KEYBOARD,
+    EIS_DEVICE_CAP_TOUCH,
+  };
+  struct eis_seat *seat = eis_event_get_seat (event);
+  struct eis_device *device;
+  struct eis_region *region;
+  size_t i;
+
+  device = eis_seat_new_device (seat);
+  eis_device_configure_name (device, "stand-in");
+  for (i = 0; i < sizeof (capabilities) / sizeof (capabilities[0]); i++)
+    {
+      if (eis_event_seat_has_capability (event, capabilities[i]))
+        eis_device_configure_capability (device, capabilities[i]);
+    }
+
+  region = eis_device_new_region (device);
+  eis_region_set_size (region, 1920, 1080);
+  eis_region_add (region);
+  eis_region_unref (region);
+
+  eis_device_add (device);
+  eis_device_resume (device);
+
+  return device;
+}
+
+static void
+handle_event (struct eis_event *event)
+{
+  static bool have_device = false;
+  struct eis_client *client;
+  struct eis_seat *seat;
+
+  switch (eis_event_get_type (event))
+    {
+    case EIS_EVENT_CLIENT_CONNECT:
+      client = eis_event_get_client (event);
+      eis_client_connect (client);
+
+      seat = eis_client_new_seat (client, "seat");
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_POINTER);
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_POINTER_ABSOLUTE);
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_BUTTON);
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_SCROLL);
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_KEYBOARD);
+      eis_seat_configure_capability (seat, EIS_DEVICE_CAP_TOUCH);
+      eis_seat_add (seat);
+      break;
+
+    case EIS_EVENT_CLIENT_DISCONNECT:
+      eis_client_disconnect (eis_event_get_client (event));
+      running = false;
+      break;
+
+    case EIS_EVENT_SEAT_BIND:
+      if (!have_device)
+        {
+          struct eis_device *device = add_device (event);
+
+          if (!eis_client_is_sender (eis_event_get_client (event)))
+            send_events (device);
+          have_device = true;
+        }
+      break;
+
+    case EIS_EVENT_POINTER_MOTION:
+      printf ("motion %.1f %.1f\n",
+              eis_event_pointer_get_dx (event),
+              eis_event_pointer_get_dy (event));
+      break;
+
+    case EIS_EVENT_POINTER_MOTION_ABSOLUTE:
+      printf ("position %.1f %.1f\n",
+              eis_event_pointer_get_absolute_x (event),
+              eis_event_pointer_get_absolute_y (event));
+      break;
+
+    case EIS_EVENT_BUTTON_BUTTON:
+      printf ("button %u %d\n",
+              eis_event_button_get_button (event),
+              eis_event_button_get_is_press (event));
+      break;
+
+    case EIS_EVENT_SCROLL_DELTA:
+      printf ("scroll %.1f %.1f\n",
+              eis_event_scroll_get_dx (event),
+              eis_event_scroll_get_dy (event));
+      break;
+
+    case EIS_EVENT_SCROLL_DISCRETE:
+      printf ("scroll-discrete %d %d\n",
+              eis_event_scroll_get_discrete_dx (event),
+              eis_event_scroll_get_discrete_dy (event));
+      break;
+
+    case EIS_EVENT_KEYBOARD_KEY:
+      printf ("key %u %d\n",
+              eis_event_keyboard_get_key (event),
+              eis_event_keyboard_get_key_is_press (event));
+      break;
+
+    case EIS_EVENT_TOUCH_DOWN:
+      printf ("touch-down %.1f %.1f\n",
+              eis_event_touch_get_x (event),
+              eis_event_touch_get_y (event));
+      break;
+
+    case EIS_EVENT_TOUCH_MOTION:
+      printf ("touch-motion %.1f %.1f\n",
+              eis_event_touch_get_x (event),
+              eis_event_touch_get_y (event));
+      break;
+
+    case EIS_EVENT_TOUCH_UP:
+      printf ("touch-up\n");
+      break;
+
+    default:
+      break;
+    }
+
+  fflush (stdout);
+}
+
+int
+main (int argc, char **argv)
+{
+  struct eis *eis;
+  struct pollfd pfd;
+  int ret;
+
+  if (argc != 2)
+    {
+      fprintf (stderr, "Usage: %s SOCKET\n", argv[0]);
+      return 1;
+    }
+
+  eis = eis_new (NULL);
+  ret = eis_setup_backend_socket (eis, argv[1]);
+  if (ret < 0)
+    {
+      fprintf (stderr, "Failed to listen on %s: %d\n", argv[1], ret);
+      return 1;
+    }
+
+  printf ("ready\n");
+  fflush (stdout);
+
+  pfd.fd = eis_get_fd (eis);
+  pfd.events = POLLIN;
+
+  while (running && poll (&pfd, 1, 10000) > 0)
+    {
+      struct eis_event *event;
+
+      eis_dispatch (eis);
+      while ((event = eis_get_event (eis)))
+        {
+          handle_event (event);
+          eis_event_unref (event);
+        }
+    }
+
+  eis_unref (eis);
+
+  return 0;
+}
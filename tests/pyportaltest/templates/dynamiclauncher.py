@@ -0,0 +1,157 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import Request, Response, ASVType, MockParams
+from typing import Dict, List, Tuple, Iterator
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.DynamicLauncher"
+
+# What g_icon_serialize() makes of a GBytesIcon
+ICON_BYTES = b"\x89PNG"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    params.delay = 500
+    params.response = parameters.get("response", 0)
+    # .desktop file names that fail to install
+    params.failing_ids = parameters.get("failing-ids", [])
+    # .desktop file name → contents
+    params.launchers: Dict[str, str] = {}
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary(
+            {
+                "version": dbus.UInt32(parameters.get("version", 1)),
+                "SupportedLauncherTypes": dbus.UInt32(3),
+            }
+        ),
+    )
+
+
+def not_found(desktop_file_id):
+    return dbus.exceptions.DBusException(
+        f"No launcher {desktop_file_id}",
+        name="org.freedesktop.portal.Error.NotFound",
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    sender_keyword="sender",
+    in_signature="ssva{sv}",
+    out_signature="o",
+)
+def PrepareInstall(self, parent_window, name, icon_v, options, sender):
+    try:
+        logger.debug(f"PrepareInstall: {parent_window}, {name}, {options}")
+        params = MockParams.get(self, MAIN_IFACE)
+        request = Request(bus_name=self.bus_name, sender=sender, options=options)
+
+        response = Response(params.response, {"name": name, "token": f"token-{name}"})
+
+        request.respond(response, delay=params.delay)
+
+        return request.handle
+    except Exception as e:
+        logger.critical(e)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="sva{sv}",
+    out_signature="s",
+)
+def RequestInstallToken(self, name, icon_v, options):
+    logger.debug(f"RequestInstallToken: {name}, {options}")
+    return f"token-{name}"
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="sssa{sv}",
+    out_signature="",
+)
+def Install(self, token, desktop_file_id, desktop_entry, options):
+    logger.debug(f"Install: {token}, {desktop_file_id}, {options}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    if desktop_file_id in params.failing_ids:
+        raise dbus.exceptions.DBusException(
+            f"Can't install {desktop_file_id}",
+            name="org.freedesktop.portal.Error.Failed",
+        )
+
+    params.launchers[desktop_file_id] = desktop_entry
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="sa{sv}",
+    out_signature="",
+)
+def Uninstall(self, desktop_file_id, options):
+    logger.debug(f"Uninstall: {desktop_file_id}, {options}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    if params.launchers.pop(desktop_file_id, None) is None:
+        raise not_found(desktop_file_id)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="s",
+    out_signature="s",
+)
+def GetDesktopEntry(self, desktop_file_id):
+    logger.debug(f"GetDesktopEntry: {desktop_file_id}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    try:
+        return params.launchers[desktop_file_id]
+    except KeyError:
+        raise not_found(desktop_file_id)
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="s",
+    out_signature="vsu",
+)
+def GetIcon(self, desktop_file_id):
+    logger.debug(f"GetIcon: {desktop_file_id}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    if desktop_file_id not in params.launchers:
+        raise not_found(desktop_file_id)
+
+    icon = dbus.Struct(
+        ("bytes", dbus.ByteArray(ICON_BYTES)), signature="sv", variant_level=1
+    )
+    return (icon, "png", dbus.UInt32(64))
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="sa{sv}",
+    out_signature="",
+)
+def Launch(self, desktop_file_id, options):
+    logger.debug(f"Launch: {desktop_file_id}, {options}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    if desktop_file_id not in params.launchers:
+        raise not_found(desktop_file_id)
@@ -61,6 +61,12 @@ def load(mock, parameters={}):
     # milliseconds until the zones change to the changed_zones
     mock.change_zones_after = parameters.get("change-zones-after", 0)
 
+    # EIS socket to connect ConnectToEIS to, None means a fake socket
+    mock.eis_socket = parameters.get("eis-socket", None)
+
+    # number of ZonesChanged signals sent back-to-back when the zones change
+    mock.change_zones_count = parameters.get("change-zones-count", 1)
+
     # List of barrier ids to fail
     mock.failed_barriers = parameters.get("failed-barriers", [])
 
@@ -141,6 +147,12 @@ def ConnectToEIS(self, session_handle: str, options: ASVType, sender: str):
     try:
         import socket
 
+        if self.eis_socket is not None:
+            # Connect to the EIS implementation the test started
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            sock.connect(self.eis_socket)
+            return dbus.types.UnixFd(sock)
+
         sockets = socket.socketpair()
         # Write some random data down so it'll break anything that actually
         # expects the socket to be a real EIS socket
@@ -190,16 +202,19 @@ def GetZones(self, session_handle: str, options: ASVType, sender: str):
                 global zone_set
 
                 logger.debug("Changing Zones")
-                opts = {"zone_set": dbus.UInt32(self.current_zone_set, variant_level=1)}
-                self.current_zone_set = next(zone_set)
-                self.current_zones = self.changed_zones
-                self.EmitSignalDetailed(
-                    "",
-                    "ZonesChanged",
-                    "oa{sv}",
-                    [dbus.ObjectPath(session_handle), opts],
-                    details={"destination": sender},
-                )
+                for _ in range(self.change_zones_count):
+                    opts = {
+                        "zone_set": dbus.UInt32(self.current_zone_set, variant_level=1)
+                    }
+                    self.current_zone_set = next(zone_set)
+                    self.current_zones = self.changed_zones
+                    self.EmitSignalDetailed(
+                        "",
+                        "ZonesChanged",
+                        "oa{sv}",
+                        [dbus.ObjectPath(session_handle), opts],
+                        details={"destination": sender},
+                    )
 
             GLib.timeout_add(self.change_zones_after, change_zones)
 
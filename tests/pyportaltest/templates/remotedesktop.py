@@ -31,6 +31,7 @@ def load(mock, parameters):
     params.devices = parameters.get("devices", 0b111)
     params.sessions: Dict[str, Session] = {}
     params.close_after_start = parameters.get("close-after-start", 0)
+    params.eis_socket = parameters.get("eis-socket", None)
 
     mock.AddProperties(
         MAIN_IFACE,
@@ -262,6 +263,13 @@ def ConnectToEIS(self, session_handle, options):
         logger.debug(f"ConnectToEIS: {session_handle} {options}")
         import socket
 
+        params = MockParams.get(self, MAIN_IFACE)
+        if params.eis_socket is not None:
+            # Connect to the EIS implementation the test started
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            sock.connect(params.eis_socket)
+            return dbus.types.UnixFd(sock)
+
         sockets = socket.socketpair()
         # Write some random data down so it'll break anything that actually
         # expects the socket to be a real EIS socket
@@ -0,0 +1,83 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from pyportaltest.templates import MockParams
+from typing import Dict, List, Tuple, Iterator
+
+import dbus
+import dbus.service
+import logging
+
+logger = logging.getLogger(f"templates.{__name__}")
+
+BUS_NAME = "org.freedesktop.portal.Desktop"
+MAIN_OBJ = "/org/freedesktop/portal/desktop"
+SYSTEM_BUS = False
+MAIN_IFACE = "org.freedesktop.portal.Settings"
+
+
+def load(mock, parameters):
+    logger.debug(f"loading {MAIN_IFACE} template")
+
+    params = MockParams.get(mock, MAIN_IFACE)
+    params.settings = parameters.get("settings", {})
+    # number of ReadAll calls that fail before it starts working
+    params.read_all_failures = parameters.get("read-all-failures", 0)
+
+    mock.AddProperties(
+        MAIN_IFACE,
+        dbus.Dictionary({"version": dbus.UInt32(parameters.get("version", 2))}),
+    )
+
+
+def namespace_matches(pattern, namespace):
+    if pattern == "":
+        return True
+    if pattern.endswith("*"):
+        return namespace.startswith(pattern[:-1])
+    return namespace == pattern
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="as",
+    out_signature="a{sa{sv}}",
+)
+def ReadAll(self, namespaces):
+    logger.debug(f"ReadAll: {namespaces}")
+    params = MockParams.get(self, MAIN_IFACE)
+    namespaces = namespaces or [""]
+
+    if params.read_all_failures > 0:
+        params.read_all_failures -= 1
+        raise dbus.exceptions.DBusException(
+            "ReadAll failed", name="org.freedesktop.DBus.Error.Failed"
+        )
+
+    return dbus.Dictionary(
+        {
+            ns: dbus.Dictionary(values, signature="sv")
+            for ns, values in params.settings.items()
+            if any(namespace_matches(p, ns) for p in namespaces)
+        },
+        signature="sa{sv}",
+    )
+
+
+@dbus.service.method(
+    MAIN_IFACE,
+    in_signature="ss",
+    out_signature="v",
+)
+def ReadOne(self, namespace, key):
+    logger.debug(f"ReadOne: {namespace}, {key}")
+    params = MockParams.get(self, MAIN_IFACE)
+
+    try:
+        return params.settings[namespace][key]
+    except KeyError:
+        raise dbus.exceptions.DBusException(
+            f"Requested setting {namespace}.{key} not found",
+            name="org.freedesktop.portal.Error.NotFound",
+        )
@@ -0,0 +1,55 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+import os
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestCamera(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def test_open_pipewire_remote(self):
+        self.setup_daemon({})
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        handle = xdp.open_pipewire_remote_for_camera()
+        with os.fdopen(handle) as pw_fd:
+            assert pw_fd.read() == "I AM A CAMERA"
+
+    def test_open_pipewire_remote_async(self):
+        self.setup_daemon({})
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        handle = -1
+
+        def open_done(portal, task, data):
+            nonlocal handle
+            handle = portal.open_pipewire_remote_for_camera_finish(task)
+            self.mainloop.quit()
+
+        xdp.open_pipewire_remote_for_camera_async(None, open_done, None)
+        self.mainloop.run()
+
+        assert handle >= 0
+        with os.fdopen(handle) as pw_fd:
+            assert pw_fd.read() == "I AM A CAMERA"
+
+        method_calls = self.mock_interface.GetMethodCalls("OpenPipeWireRemote")
+        assert len(method_calls) == 1
+        _, args = method_calls.pop(0)
+        (options,) = args
+        assert list(options.keys()) == []
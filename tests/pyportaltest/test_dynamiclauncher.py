@@ -0,0 +1,147 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Gio, Xdp
+
+logger = logging.getLogger(__name__)
+
+ICON = GLib.Variant("(sv)", ("bytes", GLib.Variant("ay", b"\x89PNG")))
+ENTRY = "[Desktop Entry]\nType=Application\nName=Example\nExec=example\n"
+
+
+class TestDynamicLauncher(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(1)
+
+    def call(self, method, *args):
+        """
+        Calls the _async variant of @method with @args and returns what its
+        _finish function returns, or the error it raises.
+        """
+        result = None
+
+        def done(portal, task, data):
+            nonlocal result
+            try:
+                result = getattr(portal, f"{method}_finish")(task)
+            except GLib.GError as e:
+                result = e
+            self.mainloop.quit()
+
+        getattr(self.xdp, f"{method}_async")(*args, None, done, None)
+        self.mainloop.run()
+
+        return result
+
+    def setup_launcher(self, params=None):
+        self.setup_daemon(params or {})
+
+        self.xdp = Xdp.Portal.new()
+        assert self.xdp is not None
+
+    def test_request_install_token_async(self):
+        self.setup_launcher()
+
+        token = self.call("dynamic_launcher_request_install_token", "Example", ICON)
+        assert token == "token-Example"
+
+    def test_launcher_async(self):
+        self.setup_launcher()
+
+        ok = self.call("dynamic_launcher_install", "token", "example.desktop", ENTRY)
+        assert ok is True
+
+        entry = self.call("dynamic_launcher_get_desktop_entry", "example.desktop")
+        assert entry == ENTRY
+
+        icon_v, icon_format, icon_size = self.call(
+            "dynamic_launcher_get_icon", "example.desktop"
+        )
+        assert icon_v.unpack() == ("bytes", b"\x89PNG")
+        assert icon_format == "png"
+        assert icon_size == 64
+
+        ok = self.call("dynamic_launcher_launch", "example.desktop", "activation")
+        assert ok is True
+
+        method_calls = self.mock_interface.GetMethodCalls("Launch")
+        assert len(method_calls) == 1
+        _, args = method_calls.pop(0)
+        desktop_file_id, options = args
+        assert desktop_file_id == "example.desktop"
+        assert options["activation_token"] == "activation"
+
+        ok = self.call("dynamic_launcher_uninstall", "example.desktop")
+        assert ok is True
+
+        error = self.call("dynamic_launcher_get_desktop_entry", "example.desktop")
+        assert isinstance(error, GLib.GError)
+
+    def call_all(self, method, *args):
+        result = None
+
+        def done(portal, task, data):
+            nonlocal result
+            try:
+                result = getattr(portal, f"{method}_finish")(task)
+            except GLib.GError as e:
+                result = e
+            self.mainloop.quit()
+
+        getattr(self.xdp, method)(*args, None, done, None)
+        self.mainloop.run()
+
+        return result
+
+    def test_install_all(self):
+        self.setup_launcher({"failing-ids": ["b.desktop"]})
+
+        ids = ["a.desktop", "b.desktop", "c.desktop"]
+        ok, failures = self.call_all(
+            "dynamic_launcher_install_all",
+            ["token-a", "token-b", "token-c"],
+            ids,
+            [ENTRY] * 3,
+        )
+
+        # One launcher failing doesn't fail the others
+        assert ok is True
+        assert list(failures.keys()) == ["b.desktop"]
+        assert "Can't install b.desktop" in failures["b.desktop"].message
+
+        method_calls = self.mock_interface.GetMethodCalls("Install")
+        assert sorted(args[1] for _, args in method_calls) == ids
+
+        for desktop_file_id in ("a.desktop", "c.desktop"):
+            entry = self.call("dynamic_launcher_get_desktop_entry", desktop_file_id)
+            assert entry == ENTRY
+
+        ok, failures = self.call_all("dynamic_launcher_uninstall_all", ids)
+        assert ok is True
+        assert list(failures.keys()) == ["b.desktop"]
+
+        method_calls = self.mock_interface.GetMethodCalls("Uninstall")
+        assert len(method_calls) == 3
+
+    def test_install_all_duplicates(self):
+        self.setup_launcher()
+
+        error = self.call_all(
+            "dynamic_launcher_install_all",
+            ["token-a", "token-b"],
+            ["a.desktop", "a.desktop"],
+            [ENTRY] * 2,
+        )
+
+        assert isinstance(error, GLib.GError)
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.INVALID_ARGUMENT)
+
+        # Nothing was installed
+        assert len(self.mock_interface.GetMethodCalls("Install")) == 0
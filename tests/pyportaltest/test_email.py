@@ -0,0 +1,74 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestEmail(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(4)
+
+    def compose_email(self, params):
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        email_was_composed = False
+
+        def compose_email_done(portal, task, data):
+            nonlocal email_was_composed
+            email_was_composed = portal.compose_email_finish(task)
+            self.mainloop.quit()
+
+        xdp.compose_email(
+            parent=None,
+            addresses=["to@example.com", "also-to@example.com"],
+            cc=["cc@example.com"],
+            bcc=None,
+            subject="Subject",
+            body="Body",
+            attachments=None,
+            flags=Xdp.EmailFlags.NONE,
+            cancellable=None,
+            callback=compose_email_done,
+            data=None,
+        )
+
+        self.mainloop.run()
+
+        assert email_was_composed
+
+        method_calls = self.mock_interface.GetMethodCalls("ComposeEmail")
+        assert len(method_calls) == 1
+        timestamp, args = method_calls.pop(0)
+        parent, options = args
+        assert options["subject"] == "Subject"
+        assert options["body"] == "Body"
+        assert "bcc" not in options
+
+        return options
+
+    def test_compose_email(self):
+        options = self.compose_email({})
+
+        assert options["addresses"] == ["to@example.com", "also-to@example.com"]
+        assert options["cc"] == ["cc@example.com"]
+        assert "address" not in options
+
+    def test_compose_email_version_2(self):
+        # Before version 3 there is only a single address, and no cc
+        options = self.compose_email({"version": 2})
+
+        assert options["address"] == "to@example.com"
+        assert "addresses" not in options
+        assert "cc" not in options
@@ -9,6 +9,8 @@ import gi
 import logging
 import pytest
 import os
+import subprocess
+import tempfile
 
 gi.require_version("Xdp", "1.0")
 from gi.repository import GLib, Gio, Xdp
@@ -334,6 +336,87 @@ class TestInputCapture(PortalTest):
         assert "handle_token" not in options  # This is not a Request
         assert list(options.keys()) == []
 
+    def test_connect_to_eis_async(self):
+        params = {}
+        setup = self.create_session_with_barriers(params)
+        assert setup.session is not None
+
+        handle = None
+
+        def connected(session, task, data):
+            nonlocal handle
+            handle = session.connect_to_eis_finish(task)
+            self.mainloop.quit()
+
+        setup.session.connect_to_eis_async(None, connected, None)
+        self.mainloop.run()
+        assert handle >= 0
+
+        fd = os.fdopen(handle)
+        buf = fd.read()
+        assert buf == "VANILLA"  # template sends this by default
+
+        method_calls = self.mock_interface.GetMethodCalls("ConnectToEIS")
+        assert len(method_calls) == 1
+
+    @pytest.mark.skipif(
+        "LIBPORTAL_TEST_EIS_SERVER" not in os.environ,
+        reason="libportal built without libei or no EIS server stand-in",
+    )
+    def test_start_receiving(self):
+        socket_path = os.path.join(tempfile.mkdtemp(), "eis-0")
+        server = subprocess.Popen(
+            [os.environ["LIBPORTAL_TEST_EIS_SERVER"], socket_path],
+            stdout=subprocess.PIPE,
+            text=True,
+        )
+        assert server.stdout.readline().strip() == "ready"
+
+        setup = self.create_session_with_barriers({"eis-socket": socket_path})
+        session = setup.session
+
+        batches = []
+
+        def captured(session, activation_id, events, data):
+            batches.append(
+                (activation_id, [(e.type, e.code, e.pressed, e.x, e.y) for e in events])
+            )
+            n_events = sum(len(b[1]) for b in batches)
+            if n_events == 6:
+                self.mainloop.quit()
+
+        assert session.start_receiving(-1, None, captured, None)
+        timeout = GLib.timeout_add(5000, self.mainloop.quit)
+        self.mainloop.run()
+        GLib.source_remove(timeout)
+
+        session.stop_receiving()
+        output, _ = server.communicate(timeout=10)
+        assert output.splitlines() == ["sent"]
+
+        # Every batch belongs to a single activation, split where the
+        # emulation sequence changes
+        assert [a for a, _ in batches] == sorted(a for a, _ in batches)
+        events = {}
+        for activation_id, batch in batches:
+            events.setdefault(activation_id, []).extend(batch)
+
+        T = Xdp.CapturedEventType
+        assert events == {
+            42: [
+                (T.POINTER_MOTION, 0, False, 1.0, 2.0),
+                (T.FRAME, 0, False, 0.0, 0.0),
+                (T.BUTTON, 272, True, 0.0, 0.0),
+                (T.FRAME, 0, False, 0.0, 0.0),
+            ],
+            43: [
+                (T.KEYBOARD_KEY, 30, True, 0.0, 0.0),
+                (T.FRAME, 0, False, 0.0, 0.0),
+            ],
+        }
+        # All events arrive in a handful of wakeups, not one call each
+        assert len(batches) < 6
+
     def test_pointer_barriers_success(self):
         """
         Some successful pointer barriers
@@ -395,6 +478,64 @@ class TestInputCapture(PortalTest):
             if b["barrier_id"] == 4:
                 assert (x1, y1, x2, y2) == (1920, 0, 1920, 1080)
 
+    def test_barrier_specs(self):
+        """
+        Struct-array barriers with client-side validation and incremental updates
+        """
+        params = {"failed-barriers": [3]}
+        setup = self.create_session_with_barriers(params)
+        session = setup.session
+
+        def spec(id, x1, y1, x2, y2):
+            b = Xdp.InputCaptureBarrierSpec()
+            b.id, b.x1, b.y1, b.x2, b.y2 = id, x1, y1, x2, y2
+            return b
+
+        failed_ids = None
+
+        def set_barriers_done(session, task, data):
+            nonlocal failed_ids
+            _, failed_ids = session.set_barriers_finish(task)
+            self.mainloop.quit()
+
+        def run(func, *args):
+            func(*args, None, set_barriers_done, None)
+            self.mainloop.run()
+            return sorted(failed_ids)
+
+        barriers = [
+            spec(10, 0, 0, 1920, 0),  # top edge
+            spec(11, 1920, 0, 1920, 1080),  # right edge
+            spec(12, 1, 3, 2, 4),  # diagonal, never sent
+            spec(13, 0, 500, 1920, 500),  # not on an edge, never sent
+        ]
+        assert run(session.set_barriers, barriers) == [12, 13]
+        assert [b.id for b in session.get_barriers()] == [10, 11]
+
+        method_calls = self.mock_interface.GetMethodCalls("SetPointerBarriers")
+        # one call from create_session_with_barriers
+        assert len(method_calls) == 2
+        _, args = method_calls.pop()
+        _, _, sent, _ = args
+        assert [int(b["barrier_id"]) for b in sent] == [10, 11]
+
+        # Invalid barriers are rejected without a round-trip
+        assert run(session.add_barrier, spec(14, 0, 2000, 10, 2000)) == [14]
+        assert len(self.mock_interface.GetMethodCalls("SetPointerBarriers")) == 2
+
+        # The portal rejects barrier 3
+        assert run(session.add_barrier, spec(3, 0, 1080, 1920, 1080)) == [3]
+        assert [b.id for b in session.get_barriers()] == [10, 11]
+
+        assert run(session.remove_barrier, 10) == []
+        assert [b.id for b in session.get_barriers()] == [11]
+
+        method_calls = self.mock_interface.GetMethodCalls("SetPointerBarriers")
+        assert len(method_calls) == 4
+        _, args = method_calls.pop()
+        _, _, sent, _ = args
+        assert [int(b["barrier_id"]) for b in sent] == [11]
+
     def test_enable_disable_release(self):
         """
         Test enable/disable calls
@@ -520,6 +661,25 @@ class TestInputCapture(PortalTest):
         assert signal_deactivated_options["cursor_position"] == (20.0, 30.0)
         assert signal_deactivated_options["activation_id"] == 123
 
+    def test_find_zone(self):
+        params = {
+            "zones": [(1920, 1080, 0, 0), (1080, 1920, 1920, 1080), (1920, 1080, 0, 1080)],
+        }
+
+        setup = self.create_session_with_barriers(params)
+        session = setup.session
+
+        assert session.find_zone(0, 0) == 0
+        assert session.find_zone(1919.5, 1079.5) == 0
+        assert session.find_zone(1920, 1080) == 1
+        assert session.find_zone(2999.5, 2999.5) == 1
+        assert session.find_zone(100, 1080) == 2
+        assert session.find_zone(100, 2159.5) == 2
+        assert session.find_zone(2000, 500) == -1
+        assert session.find_zone(100, 2160) == -1
+        assert session.find_zone(-1, 0) == -1
+        assert session.find_zone(3000, 1500) == -1
+
     def test_zones_changed(self):
         """
         Test the ZonesChanged signal
@@ -566,6 +726,39 @@ class TestInputCapture(PortalTest):
         assert all([z.props.zone_set == 568 for z in session.get_zones()])
         assert all([v == False for v in zone_props.values()])
 
+    def test_zones_changed_burst(self):
+        """
+        A burst of ZonesChanged signals is coalesced into one notification
+        """
+        params = {
+            "changed-zones": [(1024, 768, 0, 0)],
+            "change-zones-after": 200,
+            "change-zones-count": 3,
+            "zone-set": 567,
+        }
+
+        setup = self.create_session_with_barriers(params)
+        session = setup.session
+
+        signal_options = []
+
+        def zones_changed(session, opts):
+            signal_options.append(opts)
+            GLib.timeout_add(300, self.mainloop.quit)
+
+        session.connect("zones-changed", zones_changed)
+
+        self.mainloop.run()
+
+        assert len(signal_options) == 1
+        assert signal_options[0]["zone_set"] == 567
+        assert all([z.props.zone_set == 570 for z in session.get_zones()])
+
+        # One GetZones for the session, then one for the first signal of
+        # the burst and one for the two that arrived while it was running
+        method_calls = self.mock_interface.GetMethodCalls("GetZones")
+        assert len(method_calls) == 3
+
     def test_disabled(self):
         """
         Test the Disabled signal
@@ -0,0 +1,131 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import gi
+import logging
+import os
+import tempfile
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+
+class TestPortal(PortalTest):
+    """
+    Tests for XdpPortal itself. There is no portal interface of that name,
+    so the Wallpaper template stands in for a portal to make requests to.
+    """
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass()
+        cls.PORTAL_NAME = "Wallpaper"
+        cls.INTERFACE_NAME = "org.freedesktop.portal.Wallpaper"
+
+    def test_new_async(self):
+        params = {}
+        self.setup_daemon(params)
+
+        xdp = None
+
+        def portal_created(source, task, data):
+            nonlocal xdp
+            xdp = Xdp.Portal.new_finish(task)
+            self.mainloop.quit()
+
+        Xdp.Portal.new_async(cancellable=None, callback=portal_created, data=None)
+        self.mainloop.run()
+
+        assert xdp is not None
+
+        wallpaper_was_set = False
+
+        def set_wallpaper_done(portal, task, data):
+            nonlocal wallpaper_was_set
+            wallpaper_was_set = portal.set_wallpaper_finish(task)
+            self.mainloop.quit()
+
+        xdp.set_wallpaper(
+            parent=None,
+            uri="https://background.async",
+            flags=Xdp.WallpaperFlags.BACKGROUND,
+            cancellable=None,
+            callback=set_wallpaper_done,
+            data=None,
+        )
+
+        self.mainloop.run()
+
+        method_calls = self.mock_interface.GetMethodCalls("SetWallpaperURI")
+        assert len(method_calls) == 1
+        assert wallpaper_was_set
+
+    def test_new_async_no_bus(self):
+        self.ensure_session_bus()
+
+        address = os.environ["DBUS_SESSION_BUS_ADDRESS"]
+        socket_path = os.path.join(tempfile.mkdtemp(), "no-bus")
+        os.environ["DBUS_SESSION_BUS_ADDRESS"] = f"unix:path={socket_path}"
+
+        xdp = None
+        error = None
+
+        def portal_created(source, task, data):
+            nonlocal xdp, error
+            try:
+                xdp = Xdp.Portal.new_finish(task)
+            except GLib.GError as e:
+                error = e
+            self.mainloop.quit()
+
+        try:
+            Xdp.Portal.new_async(cancellable=None, callback=portal_created, data=None)
+            self.mainloop.run()
+        finally:
+            os.environ["DBUS_SESSION_BUS_ADDRESS"] = address
+
+        assert xdp is None
+        assert error is not None
+
+    def test_new_lazy(self):
+        self.setup_daemon({})
+
+        # A lazy portal doesn't connect when it is created, so a bus that
+        # isn't there yet doesn't matter
+        address = os.environ["DBUS_SESSION_BUS_ADDRESS"]
+        socket_path = os.path.join(tempfile.mkdtemp(), "no-bus")
+        os.environ["DBUS_SESSION_BUS_ADDRESS"] = f"unix:path={socket_path}"
+        try:
+            xdp = Xdp.Portal.new_lazy()
+        finally:
+            os.environ["DBUS_SESSION_BUS_ADDRESS"] = address
+
+        assert xdp is not None
+
+        # It connects on first use
+        wallpaper_was_set = False
+
+        def set_wallpaper_done(portal, task, data):
+            nonlocal wallpaper_was_set
+            wallpaper_was_set = portal.set_wallpaper_finish(task)
+            self.mainloop.quit()
+
+        xdp.set_wallpaper(
+            parent=None,
+            uri="https://background.lazy",
+            flags=Xdp.WallpaperFlags.BACKGROUND,
+            cancellable=None,
+            callback=set_wallpaper_done,
+            data=None,
+        )
+
+        self.mainloop.run()
+
+        method_calls = self.mock_interface.GetMethodCalls("SetWallpaperURI")
+        assert len(method_calls) == 1
+        assert wallpaper_was_set
@@ -7,6 +7,9 @@ from . import PortalTest
 import gi
 import logging
 import os
+import pytest
+import subprocess
+import tempfile
 
 from typing import NamedTuple, TextIO
 
@@ -498,6 +501,189 @@ class TestRemoteDesktop(PortalTest):
         session_handle, options, slot = args
         assert slot == 10
 
+    def test_send_events(self):
+        setup = self.create_session()
+        session = setup.session
+
+        batch = Xdp.InputBatch.new()
+        batch.pointer_motion(1.0, 2.0)
+        batch.pointer_button(1, Xdp.ButtonState.PRESSED)
+        batch.keyboard_key(False, 3, Xdp.KeyState.PRESSED)
+        batch.pointer_axis(True, 0.5, 0.0)
+        batch.pointer_button(1, Xdp.ButtonState.RELEASED)
+        assert batch.get_n_events() == 5
+
+        result = None
+
+        def send_done(session, task, data):
+            nonlocal result
+            result = session.send_events_finish(task)
+            self.mainloop.quit()
+
+        session.send_events(batch, None, send_done, None)
+        self.mainloop.run()
+
+        assert result == (True, 5)
+
+        calls = [
+            (method, args)
+            for _, method, args in self.mock_interface.GetCalls()
+            if method.startswith("Notify")
+        ]
+        assert [method for method, _ in calls] == [
+            "NotifyPointerMotion",
+            "NotifyPointerButton",
+            "NotifyKeyboardKeycode",
+            "NotifyPointerAxis",
+            "NotifyPointerButton",
+        ]
+        assert tuple(calls[0][1][2:]) == (1.0, 2.0)
+        assert calls[1][1][3] == Xdp.ButtonState.PRESSED
+        assert calls[3][1][1]["finish"]
+        assert calls[4][1][3] == Xdp.ButtonState.RELEASED
+
+    def test_type_text(self):
+        setup = self.create_session()
+        session = setup.session
+
+        result = None
+
+        def type_done(session, task, data):
+            nonlocal result
+            result = session.type_text_finish(task)
+            self.mainloop.quit()
+
+        session.type_text("aÖ€\r\n", None, type_done, None)
+        self.mainloop.run()
+
+        assert result
+
+        calls = [
+            args
+            for _, method, args in self.mock_interface.GetCalls()
+            if method == "NotifyKeyboardKeysym"
+        ]
+        assert [(args[2], args[3]) for args in calls] == [
+            (0x61, Xdp.KeyState.PRESSED),
+            (0x61, Xdp.KeyState.RELEASED),
+            (0xD6, Xdp.KeyState.PRESSED),
+            (0xD6, Xdp.KeyState.RELEASED),
+            (0x010020AC, Xdp.KeyState.PRESSED),
+            (0x010020AC, Xdp.KeyState.RELEASED),
+            (0xFF0D, Xdp.KeyState.PRESSED),
+            (0xFF0D, Xdp.KeyState.RELEASED),
+        ]
+
+    def test_motion_coalescing(self):
+        setup = self.create_session()
+        session = setup.session
+
+        session.enable_motion_coalescing(1000)
+        session.pointer_motion(1.0, -1.0)
+        session.pointer_motion(2.0, -2.0)
+        session.pointer_position(5, 1.0, 1.0)
+        session.pointer_position(5, 2.0, 3.0)
+        session.pointer_motion(3.0, -3.0)
+        session.pointer_button(1, Xdp.ButtonState.PRESSED)
+        session.pointer_motion(4.0, -4.0)
+        session.disable_motion_coalescing()
+        self.short_mainloop()
+
+        calls = [
+            (method, tuple(args[2:]))
+            for _, method, args in self.mock_interface.GetCalls()
+            if method.startswith("Notify")
+        ]
+        assert calls == [
+            ("NotifyPointerMotion", (3.0, -3.0)),
+            ("NotifyPointerMotionAbsolute", (5, 2.0, 3.0)),
+            ("NotifyPointerMotion", (3.0, -3.0)),
+            ("NotifyPointerButton", (1, Xdp.ButtonState.PRESSED)),
+            ("NotifyPointerMotion", (4.0, -4.0)),
+        ]
+
+    def test_record_replay(self):
+        setup = self.create_session()
+        session = setup.session
+
+        session.start_recording()
+        session.pointer_motion(1.0, 2.0)
+        session.pointer_position(5, 3.0, 4.0)
+        session.keyboard_key(True, 0x61, Xdp.KeyState.PRESSED)
+        session.touch_down(5, 1, 6.0, 7.0)
+        recording = session.stop_recording()
+        assert recording.get_size() > 0
+        self.short_mainloop()
+
+        result = None
+
+        def replay_done(session, task, data):
+            nonlocal result
+            result = session.replay_finish(task)
+            self.mainloop.quit()
+
+        session.replay(recording, 0.0, None, replay_done, None)
+        self.mainloop.run()
+        self.short_mainloop()
+
+        assert result == (True, 4)
+
+        calls = [
+            (method, tuple(args[2:]))
+            for _, method, args in self.mock_interface.GetCalls()
+            if method.startswith("Notify")
+        ]
+        assert len(calls) == 8
+        assert calls[:4] == calls[4:]
+        assert calls[:4] == [
+            ("NotifyPointerMotion", (1.0, 2.0)),
+            ("NotifyPointerMotionAbsolute", (5, 3.0, 4.0)),
+            ("NotifyKeyboardKeysym", (0x61, Xdp.KeyState.PRESSED)),
+            ("NotifyTouchDown", (5, 1, 6.0, 7.0)),
+        ]
+
+    def test_replay_invalid(self):
+        setup = self.create_session()
+        session = setup.session
+
+        error = None
+
+        def replay_done(session, task, data):
+            nonlocal error
+            try:
+                session.replay_finish(task)
+            except GLib.GError as e:
+                error = e
+            self.mainloop.quit()
+
+        session.replay(GLib.Bytes.new(b"VANILLA"), 1.0, None, replay_done, None)
+        self.mainloop.run()
+
+        assert error is not None
+        assert error.matches(Gio.io_error_quark(), Gio.IOErrorEnum.INVALID_DATA)
+
+    def test_input_thread(self):
+        setup = self.create_session()
+        session = setup.session
+
+        session.enable_input_thread()
+        session.pointer_motion(1.0, 2.0)
+        session.keyboard_key(False, 3, Xdp.KeyState.PRESSED)
+        session.touch_up(4)
+        session.close()
+        self.short_mainloop()
+
+        calls = [
+            method
+            for _, method, _ in self.mock_interface.GetCalls()
+            if method.startswith("Notify")
+        ]
+        assert calls == [
+            "NotifyPointerMotion",
+            "NotifyKeyboardKeycode",
+            "NotifyTouchUp",
+        ]
+
     def test_connect_to_eis_v1(self):
         params = {"version": 1}
         setup = self.create_session(params=params, start_session=True)
@@ -526,6 +712,66 @@ class TestRemoteDesktop(PortalTest):
         assert "handle_token" not in options  # this is not a Request
         assert list(options.keys()) == []
 
+    def test_connect_to_eis_async(self):
+        setup = self.create_session(start_session=True)
+        session = setup.session
+
+        handle = None
+
+        def connected(session, task, data):
+            nonlocal handle
+            handle = session.connect_to_eis_finish(task)
+            self.mainloop.quit()
+
+        session.connect_to_eis_async(None, connected, None)
+        self.mainloop.run()
+        assert handle >= 0
+
+        fd = os.fdopen(handle)
+        buf = fd.read()
+        assert buf == "VANILLA"  # template sends this by default
+
+        # The session is connected now
+        with pytest.raises(GLib.GError):
+            session.connect_to_eis()
+
+    @pytest.mark.skipif(
+        "LIBPORTAL_TEST_EIS_SERVER" not in os.environ,
+        reason="libportal built without libei or no EIS server stand-in",
+    )
+    def test_eis_input(self):
+        socket_path = os.path.join(tempfile.mkdtemp(), "eis-0")
+        server = subprocess.Popen(
+            [os.environ["LIBPORTAL_TEST_EIS_SERVER"], socket_path],
+            stdout=subprocess.PIPE,
+            text=True,
+        )
+        assert server.stdout.readline().strip() == "ready"
+
+        setup = self.create_session(
+            params={"eis-socket": socket_path}, start_session=True
+        )
+        session = setup.session
+
+        assert session.enable_eis_input(-1)
+        session.pointer_motion(1.0, 2.0)
+        session.pointer_button(272, Xdp.ButtonState.PRESSED)
+        session.keyboard_key(False, 30, Xdp.KeyState.PRESSED)
+        session.pointer_axis_discrete(Xdp.DiscreteAxis.VERTICAL_SCROLL, 2)
+        self.short_mainloop()
+
+        # Closing the session disconnects from EIS, which ends the server
+        session.close()
+        output, _ = server.communicate(timeout=10)
+
+        assert output.splitlines() == [
+            "motion 1.0 2.0",
+            "button 272 1",
+            "key 30 1",
+            "scroll-discrete 0 240",
+        ]
+        assert self.mock_interface.GetMethodCalls("NotifyPointerMotion") == []
+
     def test_connect_to_eis_fail_reconnect(self):
         setup = self.create_session(start_session=True)
         session = setup.session
@@ -168,6 +168,31 @@ class TestScreenCast(PortalTest):
         session_handle, options = args
         assert list(options.keys()) == []
 
+    def test_open_pipewire_remote_async(self):
+        setup = self.create_session()
+        setup.pw_fd.close()
+
+        handle = -1
+
+        def open_done(session, task, data):
+            nonlocal handle
+            handle = session.open_pipewire_remote_finish(task)
+            self.mainloop.quit()
+
+        setup.session.open_pipewire_remote_async(None, open_done, None)
+        self.mainloop.run()
+
+        assert handle >= 0
+        with os.fdopen(handle) as pw_fd:
+            assert pw_fd.read() == "I AM GROO^WPIPEWIRE"
+
+        # Once by create_session(), once by us
+        method_calls = self.mock_interface.GetMethodCalls("OpenPipeWireRemote")
+        assert len(method_calls) == 2
+        _, args = method_calls.pop()
+        session_handle, options = args
+        assert list(options.keys()) == []
+
     def test_create_session_v3(self):
         """
         persist_mode and restore_token were added in v4 of the interface, must
@@ -0,0 +1,388 @@
+# SPDX-License-Identifier: LGPL-3.0-only
+#
+# This file is formatted with Python Black
+
+from . import PortalTest
+
+import dbus
+import gi
+import logging
+import os
+import tempfile
+
+gi.require_version("Xdp", "1.0")
+from gi.repository import GLib, Xdp
+
+logger = logging.getLogger(__name__)
+
+# Keep settings snapshots out of the real cache directory. GLib reads
+# this once, so it must happen before anything asks for the cache dir.
+os.environ["XDG_CACHE_HOME"] = tempfile.mkdtemp(prefix="libportal-test-")
+
+APPEARANCE = "org.freedesktop.appearance"
+
+
+class TestSettings(PortalTest):
+    def test_version(self):
+        self.assert_version_eq(2)
+
+    def setup_settings(self, **extra_params):
+        params = {
+            **extra_params,
+            "settings": {
+                APPEARANCE: {
+                    "color-scheme": dbus.UInt32(1),
+                    "contrast": dbus.UInt32(0),
+                },
+                "org.gnome.desktop.interface": {
+                    "gtk-theme": dbus.String("Adwaita"),
+                },
+            }
+        }
+        self.setup_daemon(params)
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        return xdp
+
+    def test_read_uint(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        assert settings.read_uint(APPEARANCE, "color-scheme", None) == 1
+
+        method_calls = self.mock_interface.GetMethodCalls("ReadOne")
+        assert len(method_calls) == 1
+
+    def test_cached_reads(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        assert settings.enable_cache([APPEARANCE], None)
+        assert settings.read_uint(APPEARANCE, "color-scheme", None) == 1
+        assert settings.read_uint(APPEARANCE, "contrast", None) == 0
+
+        # A second settings object shares the cache
+        other = xdp.get_settings()
+        assert other.read_uint(APPEARANCE, "color-scheme", None) == 1
+
+        with self.assertRaises(GLib.Error):
+            settings.read_value(APPEARANCE, "does-not-exist", None)
+
+        # Uncached namespaces still go to the portal
+        assert (
+            settings.read_string("org.gnome.desktop.interface", "gtk-theme", None)
+            == "Adwaita"
+        )
+
+        assert len(self.mock_interface.GetMethodCalls("ReadAll")) == 1
+        assert len(self.mock_interface.GetMethodCalls("ReadOne")) == 1
+
+    def test_cache_follows_changes(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+        other = xdp.get_settings()
+
+        assert settings.enable_cache([APPEARANCE], None)
+
+        changes = []
+
+        def changed(settings, namespace, key, value):
+            changes.append((settings, namespace, key, value.unpack()))
+            if len(changes) == 2:
+                self.mainloop.quit()
+
+        settings.connect("changed", changed)
+        other.connect("changed", changed)
+
+        self.mock_interface.EmitSignal(
+            "org.freedesktop.portal.Settings",
+            "SettingChanged",
+            "ssv",
+            [APPEARANCE, "color-scheme", dbus.UInt32(2, variant_level=1)],
+        )
+
+        self.mainloop.run()
+
+        assert len(changes) == 2
+        assert all(c[1:] == (APPEARANCE, "color-scheme", 2) for c in changes)
+        assert settings.read_uint(APPEARANCE, "color-scheme", None) == 2
+        assert len(self.mock_interface.GetMethodCalls("ReadOne")) == 0
+
+    def test_read_value_async(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        value = None
+
+        def read_done(settings, result, data):
+            nonlocal value
+            value = settings.read_uint_finish(result)
+            self.mainloop.quit()
+
+        settings.read_uint_async(APPEARANCE, "color-scheme", None, read_done, None)
+
+        self.mainloop.run()
+
+        assert value == 1
+
+    def test_read_keys_async(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        keys = GLib.Variant(
+            "a(ss)",
+            [
+                (APPEARANCE, "color-scheme"),
+                (APPEARANCE, "does-not-exist"),
+                ("org.gnome.desktop.interface", "gtk-theme"),
+            ],
+        )
+        values = None
+
+        def read_done(settings, result, data):
+            nonlocal values
+            values = settings.read_keys_finish(result).unpack()
+            self.mainloop.quit()
+
+        settings.read_keys_async(keys, None, read_done, None)
+
+        self.mainloop.run()
+
+        assert values == {
+            APPEARANCE: {"color-scheme": 1},
+            "org.gnome.desktop.interface": {"gtk-theme": "Adwaita"},
+        }
+        assert len(self.mock_interface.GetMethodCalls("ReadAll")) == 1
+        assert len(self.mock_interface.GetMethodCalls("ReadOne")) == 0
+
+    def test_watch(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        watch_id = settings.watch(APPEARANCE, "color-scheme")
+        assert watch_id != 0
+
+        changes = []
+        detailed_changes = []
+
+        def changed(settings, namespace, key, value):
+            changes.append((namespace, key, value.unpack()))
+            if key == "contrast":
+                self.mainloop.quit()
+
+        def color_scheme_changed(settings, namespace, key, value):
+            detailed_changes.append((namespace, key, value.unpack()))
+            self.mainloop.quit()
+
+        settings.connect("changed", changed)
+        settings.connect(f"changed::{APPEARANCE}.color-scheme", color_scheme_changed)
+
+        for key, value in (("contrast", 1), ("color-scheme", 2)):
+            self.mock_interface.EmitSignal(
+                "org.freedesktop.portal.Settings",
+                "SettingChanged",
+                "ssv",
+                [APPEARANCE, key, dbus.UInt32(value, variant_level=1)],
+            )
+
+        self.mainloop.run()
+
+        # The unwatched key never reaches us
+        assert changes == [(APPEARANCE, "color-scheme", 2)]
+        assert detailed_changes == [(APPEARANCE, "color-scheme", 2)]
+
+        settings.unwatch(watch_id)
+
+        # Without watches, every change is reported again. The read makes
+        # sure the bus has the match rule before the signal is sent.
+        settings.read_value(APPEARANCE, "contrast", None)
+        self.mock_interface.EmitSignal(
+            "org.freedesktop.portal.Settings",
+            "SettingChanged",
+            "ssv",
+            [APPEARANCE, "contrast", dbus.UInt32(0, variant_level=1)],
+        )
+        self.mainloop.run()
+
+        assert changes[-1] == (APPEARANCE, "contrast", 0)
+
+    def test_changed_batch(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+        settings.enable_batching(200)
+
+        changes = []
+        batches = []
+
+        def changed(settings, namespace, key, value):
+            changes.append((namespace, key, value.unpack()))
+
+        def changed_batch(settings, batch):
+            batches.append(batch.unpack())
+            self.mainloop.quit()
+
+        settings.connect("changed", changed)
+        settings.connect("changed-batch", changed_batch)
+
+        for key, value in (("color-scheme", 2), ("contrast", 1), ("color-scheme", 0)):
+            self.mock_interface.EmitSignal(
+                "org.freedesktop.portal.Settings",
+                "SettingChanged",
+                "ssv",
+                [APPEARANCE, key, dbus.UInt32(value, variant_level=1)],
+            )
+
+        self.mainloop.run()
+
+        assert len(changes) == 3
+        assert batches == [{APPEARANCE: {"color-scheme": 0, "contrast": 1}}]
+
+    def test_snapshot(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        # Pretend an earlier run saw a different color scheme
+        snapshot = GLib.Variant(
+            "(ua{sa{sv}})",
+            (
+                1,
+                {
+                    APPEARANCE: {
+                        "color-scheme": GLib.Variant("u", 0),
+                        "accent-color": GLib.Variant("(ddd)", (1.0, 0.0, 0.0)),
+                    }
+                },
+            ),
+        )
+        path = os.path.join(GLib.get_user_cache_dir(), "libportal", "settings.snapshot")
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(snapshot.get_data_as_bytes().get_data())
+
+        changes = []
+        revalidated = False
+
+        def changed(settings, namespace, key, value):
+            changes.append((namespace, key, value.unpack() if value else None))
+
+        def snapshot_done(settings, result, data):
+            nonlocal revalidated
+            revalidated = settings.enable_cache_from_snapshot_finish(result)
+            self.mainloop.quit()
+
+        settings.connect("changed", changed)
+        settings.enable_cache_from_snapshot([APPEARANCE], None, snapshot_done, None)
+
+        # Served from the snapshot before the portal answered
+        assert settings.read_uint(APPEARANCE, "color-scheme", None) == 0
+
+        self.mainloop.run()
+
+        assert revalidated
+        assert (APPEARANCE, "color-scheme", 1) in changes
+        # The portal doesn't know the accent color the snapshot had
+        assert (APPEARANCE, "accent-color", None) in changes
+        assert settings.read_uint(APPEARANCE, "color-scheme", None) == 1
+        assert len(self.mock_interface.GetMethodCalls("ReadOne")) == 0
+
+        # The revalidated values were written back
+        with open(path, "rb") as f:
+            data = GLib.Bytes.new(f.read())
+        saved = GLib.Variant.new_from_bytes(
+            GLib.VariantType.new("(ua{sa{sv}})"), data, False
+        ).unpack()
+        assert saved[1][APPEARANCE]["color-scheme"] == 1
+
+    def test_snapshot_missing_namespace(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        # The snapshot only has the appearance namespace
+        snapshot = GLib.Variant(
+            "(ua{sa{sv}})",
+            (1, {APPEARANCE: {"color-scheme": GLib.Variant("u", 1)}}),
+        )
+        path = os.path.join(GLib.get_user_cache_dir(), "libportal", "settings.snapshot")
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(snapshot.get_data_as_bytes().get_data())
+
+        def snapshot_done(settings, result, data):
+            settings.enable_cache_from_snapshot_finish(result)
+            self.mainloop.quit()
+
+        settings.enable_cache_from_snapshot(
+            [APPEARANCE, "org.gnome.desktop.interface"], None, snapshot_done, None
+        )
+
+        # Not in the snapshot, so this still asks the portal
+        theme = settings.read_string("org.gnome.desktop.interface", "gtk-theme", None)
+        assert theme == "Adwaita"
+        assert len(self.mock_interface.GetMethodCalls("ReadOne")) == 1
+
+        self.mainloop.run()
+
+    def test_appearance_failed(self):
+        xdp = self.setup_settings(**{"read-all-failures": 1})
+        settings = xdp.get_settings()
+
+        # The defaults are served, and a failed load isn't repeated
+        assert settings.get_color_scheme() == Xdp.ColorScheme.NO_PREFERENCE
+        assert settings.props.color_scheme == Xdp.ColorScheme.NO_PREFERENCE
+        assert settings.get_contrast() == Xdp.Contrast.NO_PREFERENCE
+        assert len(self.mock_interface.GetMethodCalls("ReadAll")) == 1
+
+        notified = []
+
+        def notify(settings, pspec):
+            notified.append(pspec.name)
+            self.mainloop.quit()
+
+        settings.connect("notify::color-scheme", notify)
+
+        # A change shows the portal is back, the appearance is loaded
+        # in the background
+        self.mock_interface.EmitSignal(
+            "org.freedesktop.portal.Settings",
+            "SettingChanged",
+            "ssv",
+            [APPEARANCE, "contrast", dbus.UInt32(0, variant_level=1)],
+        )
+
+        self.mainloop.run()
+
+        assert notified == ["color-scheme"]
+        assert settings.get_color_scheme() == Xdp.ColorScheme.PREFER_DARK
+        assert len(self.mock_interface.GetMethodCalls("ReadAll")) == 2
+
+    def test_appearance(self):
+        xdp = self.setup_settings()
+        settings = xdp.get_settings()
+
+        assert settings.get_color_scheme() == Xdp.ColorScheme.PREFER_DARK
+        assert settings.get_contrast() == Xdp.Contrast.NO_PREFERENCE
+        assert settings.props.color_scheme == Xdp.ColorScheme.PREFER_DARK
+
+        notified = []
+
+        def notify(settings, pspec):
+            notified.append(pspec.name)
+            self.mainloop.quit()
+
+        settings.connect("notify::color-scheme", notify)
+
+        self.mock_interface.EmitSignal(
+            "org.freedesktop.portal.Settings",
+            "SettingChanged",
+            "ssv",
+            [APPEARANCE, "color-scheme", dbus.UInt32(2, variant_level=1)],
+        )
+
+        self.mainloop.run()
+
+        assert notified == ["color-scheme"]
+        assert settings.get_color_scheme() == Xdp.ColorScheme.PREFER_LIGHT
+        # Later reads are served from the cache
+        assert len(self.mock_interface.GetMethodCalls("ReadAll")) == 1
@@ -115,3 +115,52 @@ class TestWallpaper(PortalTest):
         assert len(method_calls) == 1
 
         assert not wallpaper_was_set
+
+    def test_set_wallpaper_other_context(self):
+        self.setup_daemon({})
+
+        xdp = Xdp.Portal.new()
+        assert xdp is not None
+
+        results = []
+
+        def set_wallpaper_done(portal, task, loop):
+            results.append(portal.set_wallpaper_finish(task))
+            loop.quit()
+
+        # The first request subscribes to responses in the default context
+        xdp.set_wallpaper(
+            None,
+            "https://default.context",
+            Xdp.WallpaperFlags.BACKGROUND,
+            None,
+            set_wallpaper_done,
+            self.mainloop,
+        )
+        self.mainloop.run()
+        assert results == [True]
+
+        # A request made with another thread-default context gets its
+        # response in that context
+        context = GLib.MainContext()
+        loop = GLib.MainLoop(context)
+        timeout = GLib.timeout_source_new(2000)
+        timeout.set_callback(lambda *args: loop.quit())
+        timeout.attach(context)
+
+        context.push_thread_default()
+        try:
+            xdp.set_wallpaper(
+                None,
+                "https://other.context",
+                Xdp.WallpaperFlags.BACKGROUND,
+                None,
+                set_wallpaper_done,
+                loop,
+            )
+            loop.run()
+        finally:
+            context.pop_thread_default()
+            timeout.destroy()
+
+        assert results == [True, True]